@@ -0,0 +1,403 @@
+// cgame_bench — headless microbenchmarks for the drawing, image and text entry points.
+//
+// Usage:
+//   cgame_bench [options]
+//     --out <file.json>        write results (default: stdout)
+//     --baseline <file.json>   compare against an earlier --out; exit 1 on regressions
+//     --threshold <pct>        slowdown that counts as a regression (default 10)
+//     --filter <text>          only cases whose name contains text
+//     --res <WxH>              only this backbuffer size (default: 640x360, 1920x1080)
+//     --quick                  shorter samples (noisier)
+//
+// Every case draws into a CGAME_HEADLESS backbuffer, so no window is needed.
+// Results are one JSON object per line; ns is the median time per call over
+// several samples. Keep a baseline per machine:
+//   cgame_bench --out bench/baseline.json
+//   ... change cgame.h ...
+//   cgame_bench --baseline bench/baseline.json
+//
+// Build (MinGW):
+//   g++ -O2 -I. bench/cgame_bench.cpp -o cgame_bench.exe -lgdi32 -lgdiplus -lmsimg32
+
+#define CGAME_NO_WINMAIN_SHIM
+#include <cgame/cgame.h>
+#include <stdio.h>
+
+#define BENCH_SAMPLES   7
+#define BENCH_MAX_IMAGE 3
+
+typedef struct {
+    const char* name;
+    int         sizes[3];      // shape size, radius, image edge or string length
+    int         counts[2];     // calls per batch
+    void      (*run)(int size, int count);
+} BenchCase;
+
+typedef struct {
+    char      key[96];         // name|WxH|size|count
+    double    ns;
+} BenchResult;
+
+static int        g_w, g_h;
+static unsigned   g_seed = 1;
+static CGameImage g_images[BENCH_MAX_IMAGE];   // 16, 64, 256 px
+static int        g_image_sizes[BENCH_MAX_IMAGE] = { 16, 64, 256 };
+
+// Deterministic positions so every run draws the same thing
+static int bench_rand(int range) {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return range > 0 ? (int)((g_seed >> 8) % (unsigned)range) : 0;
+}
+
+static int bench_x(int size) { return bench_rand(g_w - size > 1 ? g_w - size : 1); }
+static int bench_y(int size) { return bench_rand(g_h - size > 1 ? g_h - size : 1); }
+
+static const CGameImage* bench_image(int size) {
+    for (int i = 0; i < BENCH_MAX_IMAGE; ++i)
+        if (g_image_sizes[i] == size) return &g_images[i];
+    return &g_images[1];
+}
+
+// 32-bit BMP with a gradient and a checker, written to the temp directory and loaded back
+static bool bench_make_image(int size, CGameImage* out) {
+    char dir[MAX_PATH], path[MAX_PATH];
+    if (!GetTempPathA(MAX_PATH, dir)) return false;
+    snprintf(path, sizeof(path), "%scgame_bench_%d.bmp", dir, size);
+
+    BITMAPFILEHEADER fh = {};
+    BITMAPINFOHEADER ih = {};
+    DWORD pixels = (DWORD)size * size * 4;
+    fh.bfType    = 0x4D42; // "BM"
+    fh.bfOffBits = sizeof(fh) + sizeof(ih);
+    fh.bfSize    = fh.bfOffBits + pixels;
+    ih.biSize        = sizeof(ih);
+    ih.biWidth       = size;
+    ih.biHeight      = -size;
+    ih.biPlanes      = 1;
+    ih.biBitCount    = 32;
+    ih.biCompression = BI_RGB;
+
+    unsigned char* px = (unsigned char*)malloc(pixels);
+    if (!px) return false;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            unsigned char* p = px + ((size_t)y * size + x) * 4;
+            bool check = ((x / 8) ^ (y / 8)) & 1;
+            p[0] = (unsigned char)(x * 255 / size);
+            p[1] = (unsigned char)(y * 255 / size);
+            p[2] = check ? 220 : 40;
+            p[3] = 255;
+        }
+    }
+
+    FILE* f = fopen(path, "wb");
+    bool ok = f && fwrite(&fh, sizeof(fh), 1, f) == 1 && fwrite(&ih, sizeof(ih), 1, f) == 1 &&
+              fwrite(px, pixels, 1, f) == 1;
+    if (f) fclose(f);
+    free(px);
+    if (!ok) return false;
+
+    *out = cgame.image.load(path);
+    DeleteFileA(path);
+    return out->gdi_bitmap != NULL;
+}
+
+// =========================
+// Cases
+// =========================
+static void run_fill_rect(int s, int n)  { for (int i = 0; i < n; ++i) cgame.draw.fill_rect(bench_x(s), bench_y(s), s, s, 200, 80, 40); }
+static void run_rect(int s, int n)       { for (int i = 0; i < n; ++i) cgame.draw.rect(bench_x(s), bench_y(s), s, s, 2, 40, 200, 80); }
+static void run_circle(int s, int n)     { for (int i = 0; i < n; ++i) cgame.draw.circle(bench_x(2 * s) + s, bench_y(2 * s) + s, s, 2, 80, 40, 200); }
+static void run_fill_circle(int s, int n){ for (int i = 0; i < n; ++i) cgame.draw.fill_circle(bench_x(2 * s) + s, bench_y(2 * s) + s, s, 200, 200, 40); }
+static void run_rounded(int s, int n)    { for (int i = 0; i < n; ++i) cgame.draw.rounded_rect(bench_x(s), bench_y(s), s, s, s / 4, 2, 40, 200, 200); }
+static void run_rounded_fill(int s, int n) {
+    for (int i = 0; i < n; ++i) cgame.draw.rounded_fill_rect(bench_x(s), bench_y(s), s, s, s / 4, 200, 40, 200);
+}
+
+// Eight-point star inside an s-sized box
+static void bench_star(int s, int* xs, int* ys) {
+    int cx = bench_x(s) + s / 2, cy = bench_y(s) + s / 2;
+    for (int k = 0; k < 8; ++k) {
+        double a = k * 3.14159265358979323846 / 4;
+        double r = (k & 1) ? s * 0.2 : s * 0.5;
+        xs[k] = cx + (int)(cos(a) * r);
+        ys[k] = cy + (int)(sin(a) * r);
+    }
+}
+
+static void run_polygon(int s, int n) {
+    int xs[8], ys[8];
+    for (int i = 0; i < n; ++i) { bench_star(s, xs, ys); cgame.draw.polygon(xs, ys, 8, 2, 120, 200, 40); }
+}
+
+static void run_fill_polygon(int s, int n) {
+    int xs[8], ys[8];
+    for (int i = 0; i < n; ++i) { bench_star(s, xs, ys); cgame.draw.fill_polygon(xs, ys, 8, 40, 120, 200); }
+}
+
+static void run_image_draw(int s, int n) {
+    const CGameImage* img = bench_image(s);
+    for (int i = 0; i < n; ++i) cgame.image.draw(img, bench_x(s), bench_y(s));
+}
+
+static void run_image_scaled(int s, int n) {
+    const CGameImage* img = bench_image(64);
+    for (int i = 0; i < n; ++i) cgame.image.draw_scaled(img, bench_x(s), bench_y(s), s, s);
+}
+
+static void run_image_rotated(int s, int n) {
+    const CGameImage* img = bench_image(s);
+    for (int i = 0; i < n; ++i) cgame.image.draw_rotated(img, bench_x(s) + s / 2, bench_y(s) + s / 2, 30.0f + i);
+}
+
+static void run_image_rotate(int s, int n) {
+    const CGameImage* img = bench_image(s);
+    for (int i = 0; i < n; ++i) { CGameImage out = cgame.image.rotate(img, 30.0f); cgame.image.unload(&out); }
+}
+
+static void run_image_resize(int s, int n) {
+    const CGameImage* img = bench_image(64);
+    for (int i = 0; i < n; ++i) { CGameImage out = cgame.image.resize(img, s, s); cgame.image.unload(&out); }
+}
+
+static void run_image_flip_h(int s, int n) {
+    const CGameImage* img = bench_image(s);
+    for (int i = 0; i < n; ++i) { CGameImage out = cgame.image.flip_horizontal(img); cgame.image.unload(&out); }
+}
+
+static void run_image_flip_v(int s, int n) {
+    const CGameImage* img = bench_image(s);
+    for (int i = 0; i < n; ++i) { CGameImage out = cgame.image.flip_vertical(img); cgame.image.unload(&out); }
+}
+
+static void run_image_blur(int s, int n) {
+    const CGameImage* img = bench_image(s);
+    for (int i = 0; i < n; ++i) { CGameImage out = cgame.image.blur_gaussian(img, 3.0f); cgame.image.unload(&out); }
+}
+
+static void run_image_color(int s, int n) {
+    static const float gray[20] = { 0.3f, 0.59f, 0.11f, 0, 0,  0.3f, 0.59f, 0.11f, 0, 0,
+                                    0.3f, 0.59f, 0.11f, 0, 0,  0,    0,     0,     1, 0 };
+    const CGameImage* img = bench_image(s);
+    for (int i = 0; i < n; ++i) { CGameImage out = cgame.image.color_matrix(img, gray); cgame.image.unload(&out); }
+}
+
+static void run_clear(int, int n) { for (int i = 0; i < n; ++i) cgame.display.clear(); }
+static void run_flip(int, int n)  { for (int i = 0; i < n; ++i) cgame.display.flip(); }
+
+static const char* bench_text(int len) {
+    static char buf[1024];
+    static const char words[] = "the quick brown fox jumps over the lazy dog 0123456789 ";
+    int n = len < (int)sizeof(buf) - 1 ? len : (int)sizeof(buf) - 1;
+    for (int i = 0; i < n; ++i) buf[i] = words[i % (sizeof(words) - 1)];
+    buf[n] = '\0';
+    return buf;
+}
+
+static void run_text(int s, int n) {
+    const char* t = bench_text(s);
+    for (int i = 0; i < n; ++i) cgame.text.draw(t, bench_x(64), bench_y(16), 230, 230, 230);
+}
+
+static void run_text_fast(int s, int n) {
+    const char* t = bench_text(s);
+    for (int i = 0; i < n; ++i) cgame.text.draw_fast(t, bench_x(64), bench_y(16), 1, 230, 230, 230);
+}
+
+static const BenchCase g_cases[] = {
+    { "draw.fill_rect",          {  8,  64, 256 }, { 16, 256 }, run_fill_rect     },
+    { "draw.rect",               {  8,  64, 256 }, { 16, 256 }, run_rect          },
+    { "draw.circle",             {  4,  32, 128 }, { 16, 256 }, run_circle        },
+    { "draw.fill_circle",        {  4,  32, 128 }, { 16, 256 }, run_fill_circle   },
+    { "draw.rounded_rect",       { 16,  64, 256 }, { 16, 256 }, run_rounded       },
+    { "draw.rounded_fill_rect",  { 16,  64, 256 }, { 16, 256 }, run_rounded_fill  },
+    { "draw.polygon",            { 16,  64, 256 }, { 16, 256 }, run_polygon       },
+    { "draw.fill_polygon",       { 16,  64, 256 }, { 16, 256 }, run_fill_polygon  },
+    { "image.draw",              { 16,  64, 256 }, { 16, 256 }, run_image_draw    },
+    { "image.draw_scaled",       { 32, 128, 512 }, { 16, 256 }, run_image_scaled  },
+    { "image.draw_rotated",      { 16,  64, 256 }, { 16, 256 }, run_image_rotated },
+    { "image.rotate",            { 16,  64, 256 }, {  1,  16 }, run_image_rotate  },
+    { "image.resize",            { 32, 128, 512 }, {  1,  16 }, run_image_resize  },
+    { "image.flip_horizontal",   { 16,  64, 256 }, {  1,  16 }, run_image_flip_h  },
+    { "image.flip_vertical",     { 16,  64, 256 }, {  1,  16 }, run_image_flip_v  },
+    { "image.blur_gaussian",     { 16,  64, 256 }, {  1,  16 }, run_image_blur    },
+    { "image.color_matrix",      { 16,  64, 256 }, {  1,  16 }, run_image_color   },
+    { "display.clear",           {  0,   0,   0 }, {  1,  16 }, run_clear         },
+    { "display.flip",            {  0,   0,   0 }, {  1,  16 }, run_flip          },
+    { "text.draw",               { 12,  64, 512 }, { 16, 256 }, run_text          },
+    { "text.draw_fast",          { 12,  64, 512 }, { 16, 256 }, run_text_fast     },
+};
+
+// =========================
+// Timing
+// =========================
+static int bench_cmp(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Median ns per call; each sample repeats the batch until it has run sample_ns
+static double bench_measure(const BenchCase* c, int size, int count, long long sample_ns) {
+    double samples[BENCH_SAMPLES];
+    g_seed = 1;
+    c->run(size, count); // warm caches, glyph atlases, GDI+ state
+    for (int s = 0; s < BENCH_SAMPLES; ++s) {
+        g_seed = 1;
+        long long calls = 0;
+        long long t0 = cgame.time.now_ns(), t1 = t0;
+        while (t1 - t0 < sample_ns) {
+            c->run(size, count);
+            calls += count;
+            t1 = cgame.time.now_ns();
+        }
+        samples[s] = (double)(t1 - t0) / (double)calls;
+    }
+    qsort(samples, BENCH_SAMPLES, sizeof(double), bench_cmp);
+    return samples[BENCH_SAMPLES / 2];
+}
+
+// =========================
+// Baseline
+// =========================
+static BenchResult* bench_load(const char* path, int* count) {
+    *count = 0;
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    int cap = 0;
+    BenchResult* out = NULL;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char name[64], res[24];
+        int size, calls;
+        double ns;
+        const char* p = line;
+        while (*p == ' ' || *p == '\t' || *p == ',') ++p;   // records after the first start with ','
+        if (sscanf(p, "{\"name\":\"%63[^\"]\",\"res\":\"%23[^\"]\",\"size\":%d,\"count\":%d,\"ns\":%lf",
+                   name, res, &size, &calls, &ns) != 5) continue;
+        if (*count == cap) {
+            cap = cap ? cap * 2 : 256;
+            BenchResult* grown = (BenchResult*)realloc(out, sizeof(BenchResult) * cap);
+            if (!grown) break;
+            out = grown;
+        }
+        snprintf(out[*count].key, sizeof(out[*count].key), "%s|%s|%d|%d", name, res, size, calls);
+        out[*count].ns = ns;
+        (*count)++;
+    }
+    fclose(f);
+    return out;
+}
+
+static const BenchResult* bench_find(const BenchResult* set, int count, const char* key) {
+    for (int i = 0; i < count; ++i)
+        if (strcmp(set[i].key, key) == 0) return &set[i];
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    const char* out_path = NULL;
+    const char* base_path = NULL;
+    const char* filter = NULL;
+    double threshold = 10.0;
+    long long sample_ns = 40000000LL; // 40 ms
+    int res[2][2] = { { 640, 360 }, { 1920, 1080 } };
+    int res_count = 2;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)            out_path = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)  base_path = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) threshold = atof(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)    filter = argv[++i];
+        else if (strcmp(argv[i], "--quick") == 0)                     sample_ns = 5000000LL;
+        else if (strcmp(argv[i], "--res") == 0 && i + 1 < argc &&
+                 sscanf(argv[i + 1], "%dx%d", &res[0][0], &res[0][1]) == 2) { res_count = 1; ++i; }
+        else {
+            fprintf(stderr, "usage: %s [--out f.json] [--baseline f.json] [--threshold pct] "
+                            "[--filter text] [--res WxH] [--quick]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int base_count = 0;
+    BenchResult* base = base_path ? bench_load(base_path, &base_count) : NULL;
+    if (base_path && !base) {
+        fprintf(stderr, "cgame_bench: can't read baseline %s\n", base_path);
+        return 2;
+    }
+
+    FILE* out = out_path ? fopen(out_path, "wb") : stdout;
+    if (!out) {
+        fprintf(stderr, "cgame_bench: can't write %s\n", out_path);
+        return 2;
+    }
+
+    cgame.init();
+    fprintf(out, "{\"version\":1,\"results\":[\n");
+    int regressions = 0, written = 0;
+
+    for (int r = 0; r < res_count; ++r) {
+        g_w = res[r][0];
+        g_h = res[r][1];
+        cgame.display.set_mode(g_w, g_h, CGAME_HEADLESS);
+        cgame.display.set_bgcolor(20, 20, 28);
+        for (int i = 0; i < BENCH_MAX_IMAGE; ++i) {
+            if (!bench_make_image(g_image_sizes[i], &g_images[i])) {
+                fprintf(stderr, "cgame_bench: can't create test images\n");
+                return 2;
+            }
+        }
+        char res_name[24];
+        snprintf(res_name, sizeof(res_name), "%dx%d", g_w, g_h);
+
+        for (size_t ci = 0; ci < sizeof(g_cases) / sizeof(g_cases[0]); ++ci) {
+            const BenchCase* c = &g_cases[ci];
+            if (filter && !strstr(c->name, filter)) continue;
+            for (int si = 0; si < 3; ++si) {
+                if (si && c->sizes[si] == c->sizes[0]) break; // size-independent case
+                for (int ni = 0; ni < 2; ++ni) {
+                    int size = c->sizes[si], count = c->counts[ni];
+                    double ns = bench_measure(c, size, count, sample_ns);
+                    fprintf(out, "%s{\"name\":\"%s\",\"res\":\"%s\",\"size\":%d,\"count\":%d,\"ns\":%.1f}\n",
+                            written++ ? "," : "", c->name, res_name, size, count, ns);
+                    fflush(out);
+
+                    if (!base) continue;
+                    char key[96];
+                    snprintf(key, sizeof(key), "%s|%s|%d|%d", c->name, res_name, size, count);
+                    const BenchResult* b = bench_find(base, base_count, key);
+                    if (!b || b->ns <= 0) continue;
+                    double change = (ns / b->ns - 1.0) * 100.0;
+                    if (change > threshold) {
+                        regressions++;
+                        fprintf(stderr, "REGRESSION %-24s %-10s size %-4d x%-4d %10.1f ns -> %10.1f ns (%+.1f%%)\n",
+                                c->name, res_name, size, count, b->ns, ns, change);
+                    } else if (change < -threshold) {
+                        fprintf(stderr, "faster     %-24s %-10s size %-4d x%-4d %10.1f ns -> %10.1f ns (%+.1f%%)\n",
+                                c->name, res_name, size, count, b->ns, ns, change);
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < BENCH_MAX_IMAGE; ++i) cgame.image.unload(&g_images[i]);
+    }
+
+    fprintf(out, "]}\n");
+    if (out != stdout) fclose(out);
+    cgame.quit();
+
+    // Round trip: the file must load back whole, or it is useless as a baseline
+    if (out_path) {
+        int back = 0;
+        BenchResult* check = bench_load(out_path, &back);
+        free(check);
+        if (back != written) {
+            fprintf(stderr, "cgame_bench: %s reads back %d of %d results\n", out_path, back, written);
+            free(base);
+            return 2;
+        }
+    }
+
+    if (base) fprintf(stderr, "cgame_bench: %d regression(s) over %.0f%%\n", regressions, threshold);
+    free(base);
+    return regressions ? 1 : 0;
+}
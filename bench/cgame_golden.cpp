@@ -0,0 +1,343 @@
+// cgame_golden — renders deterministic reference scenes headless and compares them
+// against stored golden images, timing each scene.
+//
+// Usage:
+//   cgame_golden [options]
+//     --dir <path>         golden image directory (default: bench/golden)
+//     --update             (re)write the goldens from this build instead of comparing
+//     --tolerance <n>      allowed difference per colour channel (default 2)
+//     --max-bad <n>        pixels allowed past the tolerance per scene (default 0)
+//     --filter <text>      only scenes whose name contains text
+//     --out <file.json>    per-scene render times, one JSON object per line
+//
+// A failing scene leaves <scene>.actual.bmp and <scene>.diff.bmp (differences in
+// red, scaled up) next to its golden. Goldens are plain 24-bit BMPs. GDI+
+// antialiasing and system fonts differ slightly between Windows versions, so
+// generate goldens with --update on the reference machine.
+//
+// Build (MinGW):
+//   g++ -O2 -I. bench/cgame_golden.cpp -o cgame_golden.exe -lgdi32 -lgdiplus -lmsimg32
+
+#define CGAME_NO_WINMAIN_SHIM
+#include <cgame/cgame.h>
+#include <stdio.h>
+
+#define SCENE_W       640
+#define SCENE_H       360
+#define SCENE_RUNS    15    // timed renders per scene, the median is reported
+
+typedef struct {
+    const char* name;
+    void      (*render)(void);
+} Scene;
+
+static unsigned   g_seed;
+static CGameImage g_sprite;
+
+static int scene_rand(int range) {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return range > 0 ? (int)((g_seed >> 8) % (unsigned)range) : 0;
+}
+
+// =========================
+// BMP I/O (24-bit, bottom-up; what every viewer opens)
+// =========================
+static bool bmp_write(const char* path, const unsigned char* bgrx, int w, int h, int stride) {
+    int row = (w * 3 + 3) & ~3;
+    BITMAPFILEHEADER fh = {};
+    BITMAPINFOHEADER ih = {};
+    fh.bfType    = 0x4D42; // "BM"
+    fh.bfOffBits = sizeof(fh) + sizeof(ih);
+    fh.bfSize    = fh.bfOffBits + (DWORD)row * h;
+    ih.biSize        = sizeof(ih);
+    ih.biWidth       = w;
+    ih.biHeight      = h;
+    ih.biPlanes      = 1;
+    ih.biBitCount    = 24;
+    ih.biCompression = BI_RGB;
+
+    unsigned char* line = (unsigned char*)calloc((size_t)row, 1);
+    FILE* f = line ? fopen(path, "wb") : NULL;
+    if (!f) {
+        free(line);
+        return false;
+    }
+    bool ok = fwrite(&fh, sizeof(fh), 1, f) == 1 && fwrite(&ih, sizeof(ih), 1, f) == 1;
+    for (int y = h - 1; ok && y >= 0; --y) {
+        const unsigned char* src = bgrx + (size_t)y * stride;
+        for (int x = 0; x < w; ++x) {
+            line[x * 3 + 0] = src[x * 4 + 0];
+            line[x * 3 + 1] = src[x * 4 + 1];
+            line[x * 3 + 2] = src[x * 4 + 2];
+        }
+        ok = fwrite(line, (size_t)row, 1, f) == 1;
+    }
+    free(line);
+    fclose(f);
+    return ok;
+}
+
+// 24- or 32-bit BI_RGB BMP into a malloc'd BGRX buffer (stride = w * 4)
+static unsigned char* bmp_read(const char* path, int* w, int* h) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    BITMAPFILEHEADER fh;
+    BITMAPINFOHEADER ih;
+    unsigned char* out = NULL;
+    if (fread(&fh, sizeof(fh), 1, f) == 1 && fread(&ih, sizeof(ih), 1, f) == 1 && fh.bfType == 0x4D42 &&
+        ih.biCompression == BI_RGB && (ih.biBitCount == 24 || ih.biBitCount == 32) &&
+        ih.biWidth > 0 && ih.biWidth <= 16384 && ih.biHeight != 0 && ih.biHeight >= -16384 && ih.biHeight <= 16384) {
+        int bw = ih.biWidth, bh = ih.biHeight < 0 ? -ih.biHeight : ih.biHeight;
+        int bpp = ih.biBitCount / 8;
+        int row = (bw * bpp + 3) & ~3;
+        unsigned char* line = (unsigned char*)malloc((size_t)row);
+        out = (unsigned char*)malloc((size_t)bw * bh * 4);
+        bool ok = line && out && fseek(f, (long)fh.bfOffBits, SEEK_SET) == 0;
+        for (int i = 0; ok && i < bh; ++i) {
+            ok = fread(line, (size_t)row, 1, f) == 1;
+            int y = ih.biHeight < 0 ? i : bh - 1 - i;
+            unsigned char* dst = out + (size_t)y * bw * 4;
+            for (int x = 0; ok && x < bw; ++x) {
+                dst[x * 4 + 0] = line[x * bpp + 0];
+                dst[x * 4 + 1] = line[x * bpp + 1];
+                dst[x * 4 + 2] = line[x * bpp + 2];
+                dst[x * 4 + 3] = 0;
+            }
+        }
+        free(line);
+        if (!ok) { free(out); out = NULL; }
+        *w = bw;
+        *h = bh;
+    }
+    fclose(f);
+    return out;
+}
+
+// 32x32 sprite: a shaded ball on black, written out and loaded back
+static bool make_sprite(CGameImage* out) {
+    char dir[MAX_PATH], path[MAX_PATH];
+    if (!GetTempPathA(MAX_PATH, dir)) return false;
+    snprintf(path, sizeof(path), "%scgame_golden_sprite.bmp", dir);
+    unsigned char px[32 * 32 * 4];
+    for (int y = 0; y < 32; ++y) {
+        for (int x = 0; x < 32; ++x) {
+            int dx = x - 15, dy = y - 15, d2 = dx * dx + dy * dy;
+            unsigned char* p = px + (y * 32 + x) * 4;
+            int shade = 255 - (dx + dy + 30) * 3;
+            p[0] = (unsigned char)(d2 < 225 ? shade / 3 : 0);
+            p[1] = (unsigned char)(d2 < 225 ? shade / 2 : 0);
+            p[2] = (unsigned char)(d2 < 225 ? shade : 0);
+            p[3] = 255;
+        }
+    }
+    if (!bmp_write(path, px, 32, 32, 32 * 4)) return false;
+    *out = cgame.image.load(path);
+    DeleteFileA(path);
+    return out->gdi_bitmap != NULL;
+}
+
+// =========================
+// Scenes (each starts from a cleared backbuffer and a fixed seed)
+// =========================
+static void scene_ui_panels(void) {
+    cgame.draw.fill_rect(0, 0, SCENE_W, 28, 36, 40, 52);
+    cgame.text.draw("File   Edit   View   Window   Help", 10, 6, 220, 220, 230);
+    for (int i = 0; i < 3; ++i) {
+        int x = 16 + i * 208, y = 44;
+        cgame.draw.rounded_fill_rect(x, y, 192, 296, 10, 48, 52, 66);
+        cgame.draw.rounded_rect(x, y, 192, 296, 10, 1, 90, 96, 120);
+        cgame.draw.fill_rect(x + 8, y + 8, 176, 22, 64, 70, 90);
+        cgame.text.draw(i == 0 ? "Inventory" : i == 1 ? "Character" : "Quests", x + 14, y + 11, 240, 240, 250);
+        for (int row = 0; row < 8; ++row) {
+            int ry = y + 40 + row * 30;
+            cgame.draw.rounded_fill_rect(x + 8, ry, 176, 24, 6, 58 + row * 4, 62, 80);
+            cgame.text.draw_fast("Item", x + 16, ry + 7, 1, 200, 200, 210);
+            cgame.text.draw_fast_int(row * 37 + i, x + 150, ry + 7, 1, 250, 210, 90);
+        }
+        cgame.draw.rounded_fill_rect(x + 40, y + 264, 112, 24, 12, 70, 130, 220);
+        cgame.text.draw_fast("OK", x + 90, y + 272, 1, 255, 255, 255);
+    }
+}
+
+static void scene_sprite_field(void) {
+    for (int i = 0; i < 400; ++i)
+        cgame.image.draw(&g_sprite, scene_rand(SCENE_W - 32), scene_rand(SCENE_H - 32));
+    for (int i = 0; i < 12; ++i)
+        cgame.image.draw_scaled(&g_sprite, scene_rand(SCENE_W - 64), scene_rand(SCENE_H - 64), 64, 64);
+    for (int i = 0; i < 8; ++i)
+        cgame.image.draw_rotated(&g_sprite, 40 + i * 76, SCENE_H / 2, (float)(i * 45));
+}
+
+static void scene_text_page(void) {
+    static const char para[] =
+        "The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor jugs. "
+        "Sphinx of black quartz, judge my vow! How vexingly quick daft zebras jump.";
+    cgame.text.draw_wrapped(para, 16, 12, 300, NULL, 16, 230, 230, 235);
+    cgame.text.draw_wrapped(para, 336, 12, 288, L"Segoe UI", 20, 250, 220, 160);
+    cgame.text.draw_complex("Heading", 16, 200, L"Arial", 28, 140, 200, 255);
+    for (int i = 0; i < 8; ++i) {
+        int x = cgame.text.draw_fast("frame ", 16, 250 + i * 12, 1, 160, 160, 170);
+        x = cgame.text.draw_fast_int(1000 + i * 17, x, 250 + i * 12, 1, 255, 255, 255);
+        cgame.text.draw_fast_float(i * 1.25 - 3.0, 2, x + 12, 250 + i * 12, 1, 120, 220, 120);
+    }
+    cgame.text.draw_fast("SCALED", 336, 260, 4, 255, 120, 80);
+}
+
+static void scene_polygons(void) {
+    for (int k = 0; k < 12; ++k) {
+        int xs[10], ys[10];
+        int cx = 50 + (k % 6) * 108, cy = 80 + (k / 6) * 180, n = 5 + k % 5;
+        for (int i = 0; i < 2 * n && i < 10; ++i) {
+            double a = i * 3.14159265358979323846 / n;
+            double r = (i & 1) ? 18 : 44;
+            xs[i] = cx + (int)(cos(a) * r);
+            ys[i] = cy + (int)(sin(a) * r);
+        }
+        int count = 2 * n < 10 ? 2 * n : 10;
+        if (k & 1) cgame.draw.fill_polygon(xs, ys, count, 60 + k * 15, 200 - k * 10, 120);
+        else       cgame.draw.polygon(xs, ys, count, 1 + k % 3, 220, 120 + k * 10, 60);
+    }
+    for (int i = 0; i < 6; ++i) {
+        cgame.draw.fill_circle(60 + i * 104, 170, 8 + i * 4, 90, 140, 230);
+        cgame.draw.circle(60 + i * 104, 170, 12 + i * 5, 2, 230, 230, 230);
+        cgame.draw.rect(20 + i * 104, 300, 80, 40, 1 + i, 200, 200, 80);
+    }
+}
+
+static const Scene g_scenes[] = {
+    { "ui_panels",    scene_ui_panels    },
+    { "sprite_field", scene_sprite_field },
+    { "text_page",    scene_text_page    },
+    { "polygons",     scene_polygons     },
+};
+
+static void render(const Scene* s) {
+    g_seed = 12345;
+    cgame.display.clear();
+    s->render();
+}
+
+static int cmp_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return x < y ? -1 : x > y;
+}
+
+int main(int argc, char** argv) {
+    const char* dir = "bench/golden";
+    const char* filter = NULL;
+    const char* out_path = NULL;
+    bool update = false;
+    int tolerance = 2, max_bad = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc)             dir = argv[++i];
+        else if (strcmp(argv[i], "--update") == 0)                     update = true;
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)  tolerance = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--max-bad") == 0 && i + 1 < argc)    max_bad = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)     filter = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)        out_path = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--dir path] [--update] [--tolerance n] [--max-bad n] "
+                            "[--filter text] [--out f.json]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    FILE* out = out_path ? fopen(out_path, "wb") : NULL;
+    if (out_path && !out) {
+        fprintf(stderr, "cgame_golden: can't write %s\n", out_path);
+        return 2;
+    }
+
+    cgame.init();
+    cgame.display.set_mode(SCENE_W, SCENE_H, CGAME_HEADLESS);
+    cgame.display.set_bgcolor(24, 26, 32);
+    if (!make_sprite(&g_sprite)) {
+        fprintf(stderr, "cgame_golden: can't create the sprite\n");
+        return 2;
+    }
+    if (update) CreateDirectoryA(dir, NULL);
+
+    int failed = 0, timed = 0;
+    if (out) fprintf(out, "{\"version\":1,\"scenes\":[\n");
+    for (size_t si = 0; si < sizeof(g_scenes) / sizeof(g_scenes[0]); ++si) {
+        const Scene* s = &g_scenes[si];
+        if (filter && !strstr(s->name, filter)) continue;
+
+        // Time several renders (the first one warms glyph caches), keep the last frame
+        long long times[SCENE_RUNS];
+        render(s);
+        for (int r = 0; r < SCENE_RUNS; ++r) {
+            long long t0 = cgame.time.now_ns();
+            render(s);
+            int w, h;
+            cgame.display.get_pixels(&w, &h); // include the GDI flush
+            times[r] = cgame.time.now_ns() - t0;
+        }
+        qsort(times, SCENE_RUNS, sizeof(long long), cmp_ll);
+        double ms = times[SCENE_RUNS / 2] / 1e6;
+
+        int w, h;
+        const unsigned char* px = cgame.display.get_pixels(&w, &h);
+        char path[MAX_PATH];
+        snprintf(path, sizeof(path), "%s/%s.bmp", dir, s->name);
+
+        if (update) {
+            bool ok = px && bmp_write(path, px, w, h, w * 4);
+            printf("%-14s %8.3f ms  %s %s\n", s->name, ms, ok ? "wrote" : "FAILED to write", path);
+            if (!ok) failed++;
+        } else {
+            int gw = 0, gh = 0;
+            unsigned char* golden = bmp_read(path, &gw, &gh);
+            long long bad = 0;
+            int worst = 0;
+            if (!px || !golden || gw != w || gh != h) {
+                bad = -1;
+            } else {
+                unsigned char* diff = (unsigned char*)calloc((size_t)w * h * 4, 1);
+                for (size_t i = 0; i < (size_t)w * h; ++i) {
+                    int d = 0;
+                    for (int c = 0; c < 3; ++c) {
+                        int e = abs((int)px[i * 4 + c] - (int)golden[i * 4 + c]);
+                        if (e > d) d = e;
+                    }
+                    if (d > worst) worst = d;
+                    if (d > tolerance) bad++;
+                    if (diff) diff[i * 4 + 2] = (unsigned char)(d * 8 > 255 ? 255 : d * 8);
+                }
+                if (bad > max_bad && diff) {
+                    char extra[MAX_PATH];
+                    snprintf(extra, sizeof(extra), "%s/%s.actual.bmp", dir, s->name);
+                    bmp_write(extra, px, w, h, w * 4);
+                    snprintf(extra, sizeof(extra), "%s/%s.diff.bmp", dir, s->name);
+                    bmp_write(extra, diff, w, h, w * 4);
+                }
+                free(diff);
+            }
+            free(golden);
+
+            if (bad < 0) {
+                printf("%-14s %8.3f ms  FAIL  missing or mismatched golden %s\n", s->name, ms, path);
+                failed++;
+            } else if (bad > max_bad) {
+                printf("%-14s %8.3f ms  FAIL  %lld pixels off by more than %d (worst %d)\n",
+                       s->name, ms, bad, tolerance, worst);
+                failed++;
+            } else {
+                printf("%-14s %8.3f ms  ok    (worst channel difference %d)\n", s->name, ms, worst);
+            }
+        }
+        if (out) {
+            fprintf(out, "%s{\"scene\":\"%s\",\"ms\":%.3f,\"min_ms\":%.3f}\n",
+                    timed++ ? "," : "", s->name, ms, times[0] / 1e6);
+        }
+    }
+    if (out) {
+        fprintf(out, "]}\n");
+        fclose(out);
+    }
+
+    cgame.image.unload(&g_sprite);
+    cgame.quit();
+    return failed ? 1 : 0;
+}
@@ -24,37 +24,46 @@
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------
+// Build modes
+//  - Default: header-only. Each translation unit that includes cgame.h
+//    compiles the whole library as static functions with its own state;
+//    fine for single-file games.
+//  - Shared: #define CGAME_IMPLEMENTATION before including cgame.h in
+//    exactly one .cpp, and CGAME_SHARED everywhere else (a project-wide
+//    CGAME_SHARED is fine). Other translation units then see only the
+//    public types and the cgame table, without windows.h or GDI+, and all
+//    of them share one table and one state.
+//  - In shared mode the table is filled while the implementation unit's
+//    globals are initialized: don't call cgame.* from static constructors
+//    in other units.
+//  - Build options (CGAME_EVENT_QUEUE_SIZE, CGAME_NO_WINMAIN_SHIM, ...)
+//    only take effect in the implementation unit.
+// -----------------------------------------------------------
+#if defined(CGAME_IMPLEMENTATION) && !defined(CGAME_SHARED)
+#define CGAME_SHARED
+#endif
 
 #if defined(_WIN32) || defined(_WIN64)
 
 // |---------------------------------------------------------------------------|
-//     []   []    [] [][][] []  [] [][]    [][]  []    []   [][]
-//      []  []    []   []   [][ [] []  [] []  [] []    [] []
-// [][][][] [] [] []   []   [][][] []  [] []  [] [] [] [] [][][]
-//      []  [][][][]   []   [] ][] []  [] []  [] [][][][]     []
-//     []   []    [] [][][] []  [] [][]    [][]  []    [] [][]
+//     []   [][][] []  [] [][]   []     [][][]  [][]       []   [][][] [][][]
+//      []  []  [] []  [] []  [] []       []   []        []  [] []  []   []
+// [][][][] [][][] []  [] [][]   []       []   []        [][][] [][][]   []
+//      []  []     []  [] []  [] []       []   []        []  [] []       []
+//     []   []      [][]  [][]   [][][] [][][]  [][]     []  [] []     [][][]
 // |---------------------------------------------------------------------------|
 
-    #define WIN32_LEAN_AND_MEAN
-    #include <windows.h>
-    #include <windowsx.h>
-    #include <objidl.h>
-    // Define PROPID if it's not defined
-    #ifndef PROPID
-    #define PROPID unsigned long
-    #endif
-    #include <gdiplus.h>
-    #include <stdlib.h>
-    #include <string.h>
-    #include <math.h>
-
-    using namespace Gdiplus;
-
-    // -------------------------
-    // GDI+ helper globals
-    // -------------------------
-    static ULONG_PTR _cgame_gdiplusToken = 0;
-    static bool _cgame_gdiplus_inited = false;
+    // Win32 / GDI+ handle types exactly as windows.h (STRICT) and gdiplus.h
+    // declare them, so the public types need neither header
+    struct HWND__;
+    struct HDC__;
+    struct HGLRC__;
+    struct HINSTANCE__;
+    namespace Gdiplus { class Bitmap; }
 
     // =========================
     // Events
@@ -72,6 +81,8 @@
     #define CGAME_OPENGL      0x04
     #define CGAME_VULKAN      0x08
     #define CGAME_D3D12       0x10 
+    #define CGAME_HEADLESS    0x20   // no window: offscreen backbuffer only (benchmarks, CI, replay)
+    #define CGAME_THREADED_EVENTS 0x40 // pump window messages on a dedicated thread (GDI / headless)
 
     // =========================
     // Console colors (Windows standard 16-color palette)
@@ -96,28 +107,28 @@
     // =========================
     // Message box types
     // =========================
-    #define CGAME_MSGBOX_OK             MB_OK
-    #define CGAME_MSGBOX_OKCANCEL       MB_OKCANCEL
-    #define CGAME_MSGBOX_YESNO          MB_YESNO
-    #define CGAME_MSGBOX_ICONINFO       MB_ICONINFORMATION
-    #define CGAME_MSGBOX_ICONWARNING    MB_ICONWARNING
-    #define CGAME_MSGBOX_ICONERROR      MB_ICONERROR
+    #define CGAME_MSGBOX_OK             0x00   // MB_OK
+    #define CGAME_MSGBOX_OKCANCEL       0x01   // MB_OKCANCEL
+    #define CGAME_MSGBOX_YESNO          0x04   // MB_YESNO
+    #define CGAME_MSGBOX_ICONINFO       0x40   // MB_ICONINFORMATION
+    #define CGAME_MSGBOX_ICONWARNING    0x30   // MB_ICONWARNING
+    #define CGAME_MSGBOX_ICONERROR      0x10   // MB_ICONERROR
 
     // =========================
     // Message box results
     // =========================
-    #define CGAME_MSGBOX_IDOK           IDOK
-    #define CGAME_MSGBOX_IDCANCEL       IDCANCEL
-    #define CGAME_MSGBOX_IDYES          IDYES
-    #define CGAME_MSGBOX_IDNO           IDNO
+    #define CGAME_MSGBOX_IDOK           1      // IDOK
+    #define CGAME_MSGBOX_IDCANCEL       2      // IDCANCEL
+    #define CGAME_MSGBOX_IDYES          6      // IDYES
+    #define CGAME_MSGBOX_IDNO           7      // IDNO
 
     // =========================
     // Screen struct
     // =========================
     typedef struct {
-        HWND hwnd;
-        HDC hdc;
-        HGLRC hglrc;
+        HWND__*  hwnd;
+        HDC__*   hdc;
+        HGLRC__* hglrc;
         int width;
         int height;
 
@@ -126,16 +137,17 @@
         bool use_opengl;
         bool use_vulkan;
         bool use_d3d12;
+        bool headless;
 
         // Vulkan handles
-        HMODULE vk_lib;
+        HINSTANCE__* vk_lib;    // HMODULE
         void*   vk_instance;
         void*   vk_device;
         void*   vk_surface;
         void*   vk_swapchain;
 
         // Direct3D 12 handles
-        HMODULE        d3d12_lib;
+        HINSTANCE__*   d3d12_lib; // HMODULE
         void*          d3d12_device;
         void*          d3d12_cmdqueue;
         void*          d3d12_swapchain;
@@ -148,6 +160,7 @@
     // =========================
     typedef struct {
         unsigned long ms; // milliseconds since game start
+        long long     ns; // nanoseconds since game start (monotonic, QueryPerformanceCounter)
     } CGameTicks;
 
     // ========================= FPS MACRO
@@ -176,13 +189,13 @@
         CGAME_K_6 = '6', CGAME_K_7 = '7', CGAME_K_8 = '8',
         CGAME_K_9 = '9',
 
-        CGAME_K_SPACE  = VK_SPACE,
-        CGAME_K_RETURN = VK_RETURN,
-        CGAME_K_ESCAPE = VK_ESCAPE,
-        CGAME_K_LEFT   = VK_LEFT,
-        CGAME_K_RIGHT  = VK_RIGHT,
-        CGAME_K_UP     = VK_UP,
-        CGAME_K_DOWN   = VK_DOWN,
+        CGAME_K_SPACE  = 0x20, // VK_SPACE
+        CGAME_K_RETURN = 0x0D, // VK_RETURN
+        CGAME_K_ESCAPE = 0x1B, // VK_ESCAPE
+        CGAME_K_LEFT   = 0x25, // VK_LEFT
+        CGAME_K_RIGHT  = 0x27, // VK_RIGHT
+        CGAME_K_UP     = 0x26, // VK_UP
+        CGAME_K_DOWN   = 0x28, // VK_DOWN
     };
 
     // =========================
@@ -198,1188 +211,6898 @@
     #define CGAME_MOUSEBUTTONUP    6
     #define CGAME_MOUSEMOTION      7
     #define CGAME_MOUSEWHEEL       8
+    #define CGAME_MOUSERAW         9   // unaccelerated device motion (after cgame.mouse.set_raw)
 
+    // =========================
+    // Event record
+    // =========================
+    typedef struct {
+        int       type;        // CGAME_QUIT, CGAME_KEYDOWN, CGAME_MOUSEMOTION, ...
+        int       key;         // virtual key code (key events)
+        int       button;      // CGameButton* (mouse button events)
+        int       x, y;        // cursor position in client pixels when the event was queued
+        int       wheel;       // vertical wheel, 120 per notch (high-resolution wheels send less), positive away from the user
+        int       wheel_x;     // horizontal wheel, 120 per notch, positive to the right
+        int       dx, dy;      // raw device counts (CGAME_MOUSERAW)
+        int       width, height; // new client size (CGAME_VIDEORESIZE)
+        long long time_us;     // high-resolution timestamp, microseconds since the program started
+    } CGameEvent;
+
+    // One cursor position from the per-frame motion history
+    typedef struct {
+        int       x, y;
+        long long time_us;
+    } CGameMotionSample;
 
     // =========================
-    // Internal globals
+    // Frame counters (cgame.debug.get_stats)
     // =========================
-    static HINSTANCE   _cgame_hInstance = NULL;
-    static bool        _cgame_running = true;
-    static int         _cgame_event = 0;
-    static CGameScreen _cgame_screen = { 0 };
+    #define CGAME_PRIM_CLEAR             0
+    #define CGAME_PRIM_FILL_RECT         1
+    #define CGAME_PRIM_RECT              2
+    #define CGAME_PRIM_ROUNDED_FILL_RECT 3
+    #define CGAME_PRIM_ROUNDED_RECT      4
+    #define CGAME_PRIM_FILL_CIRCLE       5
+    #define CGAME_PRIM_CIRCLE            6
+    #define CGAME_PRIM_FILL_POLYGON      7
+    #define CGAME_PRIM_POLYGON           8
+    #define CGAME_PRIM_IMAGE             9   // image.draw, draw_scaled, draw_rotated
+    #define CGAME_PRIM_TEXT              10  // text.draw*, ttf.draw
+    #define CGAME_PRIM_COUNT             11
 
+    typedef struct {
+        int       calls [CGAME_PRIM_COUNT];  // per CGAME_PRIM_*
+        long long pixels[CGAME_PRIM_COUNT];  // estimated pixels covered per CGAME_PRIM_*
+        int       draw_calls;                // all calls except clears
+        long long pixels_filled;             // sum of pixels[]
+        int       blits;                     // calls[CGAME_PRIM_IMAGE]
+        int       text_calls;                // calls[CGAME_PRIM_TEXT]
+        long long bytes_allocated;           // heap bytes cgame requested this frame
+        long long frame_ns;                  // flip to flip
+    } CGameFrameStats;
 
+    // =========================
+    // Overdraw counters (cgame.debug.get_overdraw)
+    // =========================
+    typedef struct {
+        long long pixels[CGAME_PRIM_COUNT];  // pixels written per CGAME_PRIM_*
+        long long total;                     // sum of pixels[]
+        long long covered;                   // distinct pixels written at least once
+        int       max_layers;                // deepest pixel
+        double    average_layers;            // total / covered
+    } CGameOverdrawStats;
 
+    // =========================
+    // Images
+    // =========================
+    typedef struct {
+        int width;
+        int height;
+        int channels;
+        unsigned char* pixels;
+        Gdiplus::Bitmap* gdi_bitmap; // keep only this
+    } CGameImage;
 
-    static COLORREF    _cgame_bgcolor = RGB(0,0,0);
-    static HDC         _cgame_memdc = NULL;
-    static HBITMAP     _cgame_membmp = NULL;
-    static HGDIOBJ     _cgame_oldbmp = NULL;
+    // =========================
+    // Asset packs, fonts and offscreen contexts (opaque)
+    // =========================
+    typedef struct CGamePack    CGamePack;
+    typedef struct CGameTTF     CGameTTF;
+    typedef struct CGameContext CGameContext;
 
-    static WPARAM      _cgame_last_key = 0;
-    static bool        _cgame_key_state[512] = { false };
-    static bool        _cgame_key_prev_async[512] = { false };
+    #define CGAME_PACK_LZ4        0x01   // build flag: LZ4-compress blobs when it helps
 
-    static bool        _cgame_mouse_state[5] = { false }; // left,right,middle,X1,X2
-    static bool        _cgame_mouse_prev[5]  = { false };
-    static int         _cgame_mouse_x = 0, _cgame_mouse_y = 0;
-    static int         _cgame_mouse_wheel = 0;
+    // =========================
+    // Jobs (cgame.jobs)
+    // =========================
+    typedef void (*CGameJobFn)(void* user);
+    typedef void (*CGameRangeFn)(void* user, int begin, int end);
 
-    // font 
-    static Gdiplus::PrivateFontCollection _cgame_font_collection;
+    typedef struct {
+        volatile long pending;   // jobs run() with this group and not finished; zero-initialise
+    } CGameWaitGroup;
 
+    // =========================
+    // Fixed-timestep loop
+    // =========================
+    typedef struct {
+        double    dt;          // seconds per simulation tick
+        double    alpha;       // 0..1, how far render time is past the last tick
+        long long tick;        // simulation ticks run so far
+        long long frame;       // frames rendered so far
+        int       steps;       // ticks run this frame
+        long long dropped_ns;  // total time discarded by the catch-up limit
+        double    time;        // simulated seconds (tick * dt)
+    } CGameLoopState;
 
-    // Forward declarations
-    static void _cgame_make_backbuffer(int w, int h);
-    static void _cgame_free_backbuffer(void);
-    /* OPENGL THE GOAT :) */
-    static bool _cgame_init_opengl(HWND hwnd, HDC* hdc, HGLRC* hglrc);
-    static void _cgame_cleanup_opengl(HDC hdc, HGLRC hglrc);
+    typedef struct {
+        int    sim_hz;                  // simulation rate (default 60)
+        int    max_catchup;             // ticks per frame at most (default 8)
+        int    render_fps;              // 0 = uncapped
+        void (*update)(const CGameLoopState* state, void* user);  // once per tick
+        void (*render)(const CGameLoopState* state, void* user);  // once per frame, before flip
+        void*  user;
+    } CGameLoop;
 
-    /* Vulkan stubs / runtime detection (lightweight) */
-    static bool _cgame_init_vulkan(HWND hwnd, HMODULE* vk_lib_out);
-    static void _cgame_cleanup_vulkan(HMODULE vk_lib);
+    // =========================
+    // Profiler summary
+    // =========================
+    typedef struct {
+        int    frames;           // frame times covered (at most CGAME_PROFILE_FRAMES, newest)
+        double avg_ms;
+        double p50_ms, p95_ms, p99_ms;
+        double max_ms;
+    } CGameProfileSummary;
 
-    /* DIRECT X 12 */
-    static bool _cgame_init_d3d12(HWND hwnd, HMODULE* d3d12_lib_out);
-    static void _cgame_cleanup_d3d12(HMODULE d3d12_lib);
+    typedef struct CGameAPI {
+        void (*init)(void);
+        void (*quit)(void);
 
+        struct {
+            CGameScreen (*set_mode)(int w, int h, int flags);
+            void (*set_bgcolor)(int r, int g, int b);
+            void (*clear)(void);
+            void (*flip)(void);
+            int  (*get_width)(void);
+            int  (*get_height)(void);
+            void (*set_title)(const char* title);
+            bool (*set_icon)(const char* path);
+            bool (*set_icon_from_image)(const CGameImage* img);
+            const unsigned char* (*get_pixels)(int* w, int* h);
+        } display;
 
-    /* small helper to centralize FillRect usage */
-    static void _cgame_fill_dc(HDC dc, int w, int h, COLORREF color);
+        // offscreen render targets, one bound per thread
+        struct {
+            CGameContext* (*create)(int w, int h);
+            void          (*destroy)(CGameContext* ctx);
+            bool          (*make_current)(CGameContext* ctx);
+            CGameContext* (*current)(void);
+        } context;
 
-    static WCHAR _cgame_window_title [256] = L"CGame Window";
-    static HICON _cgame_window_icon = NULL;
+        // work-stealing jobs, shared with cgame's own parallel paths
+        struct {
+            void (*run)(CGameJobFn fn, void* user, CGameWaitGroup* wg);   // wg may be NULL
+            void (*wait)(CGameWaitGroup* wg);                              // runs queued jobs meanwhile
+            void (*parallel_for)(int count, int grain, CGameRangeFn fn, void* user);
+            int  (*worker_count)(void);
+            bool (*set_worker_count)(int count);                           // <= 0: logical cores - 1; false once started
+            int  (*thread_index)(void);                                    // 1..worker_count on workers, else 0
+        } jobs;
+
+        // per-thread scratch memory, rewound only by its own thread (see the arena notes)
+        struct {
+            void*  (*alloc)(size_t size);   // 16-byte aligned; NULL when out of memory. Valid until this thread's
+                                            // next flip, the end of the job on a worker, or arena.reset elsewhere
+            size_t (*used)(void);           // bytes this thread has taken since its last rewind
+            void   (*reset)(void);          // rewind this thread's arena now: context threads, loops that never flip
+        } arena;
 
+        // console reset and set color
+        struct {
+            void (*set_color)(int fg, int bg);
+            void (*reset_color)(void);
+        } console;
 
-    // =========================
-    // Win32 window procedure
-    // =========================
-    static LRESULT CALLBACK _cgame_WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
-        switch (msg) {
-        case WM_CLOSE:
-            _cgame_event = CGAME_QUIT;
-            _cgame_running = false;
-            DestroyWindow(hwnd);
-            return 0;
+        // msg box show 
+        struct {
+            int (*show)(const wchar_t* title, const wchar_t* text, unsigned int type);
+        } messagebox;
 
-        case WM_DESTROY:
-            PostQuitMessage(0);
-            return 0;
 
-        case WM_SIZE: {
-            int nw = LOWORD(lParam);
-            int nh = HIWORD(lParam);
+        struct {
+            int  (*get)(void);
+            bool (*poll)(CGameEvent* ev);
+            int  (*drain)(CGameEvent* out, int max);
+            int  (*dropped)(void);
+            void (*inject)(const CGameEvent* ev);
+        } event;
 
-            // Only update if we have valid dimensions
-            if (nw > 0 && nh > 0) {
-                _cgame_screen.width = nw;
-                _cgame_screen.height = nh;
-                _cgame_event = CGAME_VIDEORESIZE;
+        // input recording / deterministic replay
+        struct {
+            bool (*start)(const char* path);
+            bool (*stop)(void);
+        } record;
 
-                if (!_cgame_screen.use_opengl && !_cgame_screen.use_vulkan) {
-                    _cgame_free_backbuffer();
-                    _cgame_make_backbuffer(nw, nh);
-                } else {
-                    /* GPU-backed (OpenGL/Vulkan) — user should handle swapchain/viewport resizing */
-                }
-            }
-            return 0;
-        }
+        struct {
+            bool (*start)(const char* path);
+            void (*stop)(void);
+            bool (*active)(void);
+        } replay;
 
-        case WM_PAINT: {
-            if (!_cgame_screen.use_opengl && !_cgame_screen.use_vulkan && !_cgame_screen.use_d3d12) {
-                PAINTSTRUCT ps;
-                HDC hdc = BeginPaint(hwnd, &ps);
-                if (_cgame_memdc && _cgame_membmp) {
-                    BitBlt(hdc, 0, 0, _cgame_screen.width, _cgame_screen.height, _cgame_memdc, 0, 0, SRCCOPY);
-                } else {
-                    HBRUSH brush = CreateSolidBrush(_cgame_bgcolor);
-                    FillRect(hdc, &ps.rcPaint, brush);
-                    DeleteObject(brush);
-                }
-                EndPaint(hwnd, &ps);
-            } else {
-                /* For OpenGL/Vulkan/D3D12 we typically swap buffers / present from the GPU.
-                If you want an automatic paint fallback for GPU modes, implement here. */
-            }
+        // keyboard api
+        struct {
+            bool (*pressed)(int key);
+            bool (*just_pressed)(int key);
+            bool (*just_released)(int key);
+            uintptr_t (*get_last)(void);   // WPARAM
+        } key;
 
-        }
+        // mouse api
+        struct {
+            bool (*pressed)(int button);
+            bool (*just_pressed)(int button);
+            bool (*just_released)(int button);
+            void (*get_pos)(int* x, int* y);
+            void (*set_pos)(int x, int y);
+            int  (*get_wheel)(void);
+            int  (*get_motion)(CGameMotionSample* out, int max);
+            void (*get_wheel_delta)(float* dx, float* dy);
+            void (*set_full_rate)(bool enabled);
+            bool (*set_raw)(bool enabled);
+            void (*get_raw_delta)(int* dx, int* dy);
+        } mouse;
 
-        case WM_KEYDOWN:
-            _cgame_event = CGAME_KEYDOWN;
-            _cgame_last_key = wParam;
-            if ((wParam & 0xFF) < 512) _cgame_key_state[wParam & 0xFF] = true;
-            return 0;
+        // polygon draw api
+        struct {
+            void (*rect)(int x, int y, int w, int h, int border_width, int r, int g, int b);
+            void (*fill_rect)(int x, int y, int w, int h, int r, int g, int b);
+            void (*polygon)(const int* xs, const int* ys, int count, int border_width, int r, int g, int b);
+            void (*fill_polygon)(const int* xs, const int* ys, int count, int r, int g, int b);
+            void (*rounded_rect)(int x, int y, int w, int h, int radius, int border_width,
+                                 int r, int g, int b);
+            void (*rounded_fill_rect)(int x, int y, int w, int h, int radius,
+                                      int r, int g, int b);
+            void (*circle)(int x, int y, int radius, int border_width, int r, int g, int b);
+            void (*fill_circle)(int x, int y, int radius, int r, int g, int b);
 
-        case WM_KEYUP:
-            _cgame_event = CGAME_KEYUP;
-            _cgame_last_key = wParam;
-            if ((wParam & 0xFF) < 512) _cgame_key_state[wParam & 0xFF] = false;
-            return 0;
+        } draw;
 
-        case WM_LBUTTONDOWN:
-            _cgame_event = CGAME_MOUSEBUTTONDOWN;
-            _cgame_mouse_state[CGameButtonLeft] = true;
-            return 0;
 
-        case WM_LBUTTONUP:
-            _cgame_event = CGAME_MOUSEBUTTONUP;
-            _cgame_mouse_state[CGameButtonLeft] = false;
-            return 0;
+        // image api
+        struct {
+            CGameImage (*load)(const char* path);
+            void (*unload)(CGameImage* img);
+            void (*draw)(const CGameImage* img, int x, int y);
+            void (*draw_scaled)(const CGameImage* img, int x, int y, int w, int h);
+            CGameImage (*resize)(const CGameImage* src, int w, int h);
+            CGameImage (*flip_horizontal)(const CGameImage* img);
+            CGameImage (*flip_vertical)(const CGameImage* img);
+            int (*get_width)(const CGameImage* img);
+            int (*get_height)(const CGameImage* img);
+            int (*get_channels)(const CGameImage* img);
+            void (*draw_rotated)(const CGameImage* img, int x, int y, float angle_deg);
+            CGameImage (*rotate)(const CGameImage *src, float angle_deg);
+            CGameImage (*blur_box)(const CGameImage* src, int radius);
+            CGameImage (*blur_gaussian)(const CGameImage* src, float sigma);
+            CGameImage (*color_matrix)(const CGameImage* src, const float* m);   // 4x5 row-major, straight RGBA 0..1
 
-        case WM_RBUTTONDOWN:
-            _cgame_event = CGAME_MOUSEBUTTONDOWN;
-            _cgame_mouse_state[CGameButtonRight] = true;
-            return 0;
+        } image;
 
-        case WM_RBUTTONUP:
-            _cgame_event = CGAME_MOUSEBUTTONUP;
-            _cgame_mouse_state[CGameButtonRight] = false;
-            return 0;
+        // pre-decoded asset packs
+        struct {
+            bool        (*build)(const char* out_path, const char** paths, int count, int flags);
+            CGamePack*  (*open)(const char* path);
+            void        (*close)(CGamePack* pack);
+            int         (*count)(const CGamePack* pack);
+            const char* (*name)(const CGamePack* pack, int index);
+            int         (*find)(const CGamePack* pack, const char* name);
+            CGameImage  (*get)(const CGamePack* pack, const char* name);
+            CGameImage  (*get_index)(const CGamePack* pack, int index);
+        } pack;
+
+        // shared image cache
+        struct {
+            const CGameImage* (*acquire)(const char* path);
+            void   (*release)(const CGameImage* img);
+            void   (*set_budget)(size_t bytes);
+            size_t (*get_usage)(void);
+            int    (*get_count)(void);
+            void   (*purge)(void);
+        } cache;
 
-        case WM_MBUTTONDOWN:
-            _cgame_event = CGAME_MOUSEBUTTONDOWN;
-            _cgame_mouse_state[CGameButtonMiddle] = true;
-            return 0;
+        // timing
+        struct {
+            CGameTicks (*get_ticks)(void);
+            void  (*set_fps)(int fps);
+            void  (*delay_if_needed)(CGameTicks frame_start);
+            long long (*now_ns)(void);
+            int   (*get_missed)(void);
+        } time;
 
-        case WM_MBUTTONUP:
-            _cgame_event = CGAME_MOUSEBUTTONUP;
-            _cgame_mouse_state[CGameButtonMiddle] = false;
-            return 0;
+        // fixed-timestep loop driver
+        struct {
+            void (*run)(const CGameLoop* loop);
+            void (*stop)(void);
+        } loop;
 
-        case WM_MOUSEMOVE:
-            _cgame_event = CGAME_MOUSEMOTION;
-            _cgame_mouse_x = GET_X_LPARAM(lParam);
-            _cgame_mouse_y = GET_Y_LPARAM(lParam);
-            return 0;
+        // frame profiler (zones: CGAME_ZONE("name") or begin/end)
+        struct {
+            void (*enable)(bool enabled);
+            bool (*enabled)(void);
+            void (*begin)(const char* name);
+            void (*end)(void);
+            void (*reset)(void);
+            bool (*export_chrome)(const char* path);
+            bool (*export_binary)(const char* path);
+            bool (*summary)(CGameProfileSummary* out);
+            void (*print_summary)(void);
+        } profile;
+
+        // debug overlay and frame counters
+        struct {
+            void (*hud)(bool enabled);
+            void (*track)(bool enabled);
+            bool (*get_stats)(CGameFrameStats* out);
+            void (*overdraw)(bool enabled);
+            bool (*get_overdraw)(CGameOverdrawStats* out);
+        } debug;
 
-        case WM_MOUSEWHEEL:
-            _cgame_event = CGAME_MOUSEWHEEL;
-            _cgame_mouse_wheel = GET_WHEEL_DELTA_WPARAM(wParam) / WHEEL_DELTA;
-            return 0;
 
-        }
-        return DefWindowProc(hwnd, msg, wParam, lParam);
-    }
+        // text rendering
+        struct {
+            void (*draw)(const char* text, int x, int y, int r, int g, int b);
+            void (*draw_complex)(const char* text, int x, int y,
+                                 const wchar_t* fontName, float size,
+                                 int r, int g, int b);
+            bool (*load_font)(const char* path);
+            void (*measure)(const char* text, const wchar_t* fontName, float size,
+                            int wrap_width, int* w, int* h);
+            void (*draw_wrapped)(const char* text, int x, int y, int wrap_width,
+                                 const wchar_t* fontName, float size,
+                                 int r, int g, int b);
+            int  (*draw_fast)(const char* text, int x, int y, int scale, int r, int g, int b);
+            int  (*draw_fast_int)(long long value, int x, int y, int scale, int r, int g, int b);
+            int  (*draw_fast_float)(double value, int decimals, int x, int y, int scale, int r, int g, int b);
+        } text;
 
-    // =========================
-    // Backbuffer helpers
-    // =========================
-    static void _cgame_fill_dc(HDC dc, int w, int h, COLORREF color) {
-        if (!dc) return;
-        HBRUSH brush = CreateSolidBrush(color);
-        RECT rc = {0,0,w,h};
-        FillRect(dc, &rc, brush);
-        DeleteObject(brush);
-    }
+        // built-in TrueType fonts (no OS font services)
+        struct {
+            CGameTTF* (*load)(const char* path);
+            CGameTTF* (*load_memory)(const void* data, size_t size);
+            void (*unload)(CGameTTF* font);
+            void (*set_sdf)(CGameTTF* font, bool enabled);
+            void (*draw)(CGameTTF* font, const char* text, int x, int y, float px, int r, int g, int b);
+        } ttf;
 
-    static void _cgame_make_backbuffer(int w, int h) {
-        if (!_cgame_screen.hwnd) return;
-        HDC wnddc = GetDC(_cgame_screen.hwnd);
-        if (!wnddc) return;
 
-        _cgame_memdc = CreateCompatibleDC(wnddc);
-        if (!_cgame_memdc) { ReleaseDC(_cgame_screen.hwnd, wnddc); return; }
 
-        // --- Create 32-bit BGRA DIBSection (alpha-capable backbuffer)
-        BITMAPINFO bmi = {};
-        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-        bmi.bmiHeader.biWidth = w;
-        bmi.bmiHeader.biHeight = -h;  // top-down
-        bmi.bmiHeader.biPlanes = 1;
-        bmi.bmiHeader.biBitCount = 32;
-        bmi.bmiHeader.biCompression = BI_RGB;
 
-        void* bits = NULL;
-        _cgame_membmp = CreateDIBSection(wnddc, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
-        if (!_cgame_membmp) {
-            ReleaseDC(_cgame_screen.hwnd, wnddc);
-            return;
+        struct {
+            int (*get)(void);
+        } event2;
+
+        int QUIT;
+        int VIDEORESIZE;
+        int KEYDOWN;
+        int KEYUP;
+
+        int K_a, K_b, K_c, K_d, K_e, K_f, K_g, K_h, K_i, K_j, K_k, 
+        K_l, K_m, K_n, K_o, K_p, K_q, K_r, K_s, K_t, K_u, K_v, 
+        K_w, K_x, K_y, K_z,
+        K_0, K_1, K_2, K_3, K_4, K_5, K_6, K_7, K_8, K_9,
+        K_SPACE, K_RETURN, K_ESCAPE, K_LEFT, K_RIGHT, K_UP, K_DOWN;
+    } CGameAPI;
+
+    #if defined(CGAME_SHARED)
+    extern CGameAPI cgame;   // defined by the CGAME_IMPLEMENTATION translation unit
+    #else
+    static CGameAPI cgame;
+    #endif
+
+    #if defined(CGAME_SHARED) && !defined(CGAME_IMPLEMENTATION)
+    // Zones from declarations-only translation units go through the table;
+    // the implementation defines a direct version of CGAME_ZONE
+    struct CGameZoneScope {
+        bool active;
+        explicit CGameZoneScope(const char* name) : active(cgame.profile.enabled()) {
+            if (active) cgame.profile.begin(name);
         }
+        ~CGameZoneScope() { if (active) cgame.profile.end(); }
+    };
 
-        _cgame_oldbmp = SelectObject(_cgame_memdc, _cgame_membmp);
+    #define CGAME_ZONE_CAT2(a, b) a##b
+    #define CGAME_ZONE_CAT(a, b)  CGAME_ZONE_CAT2(a, b)
+    #define CGAME_ZONE(name)      CGameZoneScope CGAME_ZONE_CAT(_cgame_zone_, __LINE__)(name)
+    #endif
 
-        // Fill transparent
-        HBRUSH brush = CreateSolidBrush(RGB(GetRValue(_cgame_bgcolor),
-                                            GetGValue(_cgame_bgcolor),
-                                            GetBValue(_cgame_bgcolor)));
-        RECT rc = { 0, 0, w, h };
-        FillRect(_cgame_memdc, &rc, brush);
-        DeleteObject(brush);
+    // =========================
+    // Direct pixel access (C++)
+    //  - CGame::Canvas<Format, Blend> writes 32-bit pixels in place. Format
+    //    and blend mode are template parameters, so put() and the span
+    //    loops inline to plain loads and stores with no calls.
+    //  - Colours passed to put/fill_rect are straight 0..255 with optional
+    //    alpha; blend modes work on premultiplied colour, as CGameImage
+    //    pixels already are.
+    //  - Writes go straight to memory and bypass the profiler, the frame
+    //    counters and the overdraw heatmap.
+    // =========================
+    namespace CGame {
 
-        ReleaseDC(_cgame_screen.hwnd, wnddc);
-    }
+        // Pixel formats
+        struct FormatBGRX8 {   // backbuffer (display.get_pixels); the 4th byte is left alone
+            static inline void load(const unsigned char* p, unsigned& r, unsigned& g, unsigned& b, unsigned& a) {
+                b = p[0]; g = p[1]; r = p[2]; a = 255;
+            }
+            static inline void store(unsigned char* p, unsigned r, unsigned g, unsigned b, unsigned a) {
+                p[0] = (unsigned char)b; p[1] = (unsigned char)g; p[2] = (unsigned char)r; (void)a;
+            }
+        };
 
+        struct FormatRGBA8 {   // CGameImage::pixels, premultiplied
+            static inline void load(const unsigned char* p, unsigned& r, unsigned& g, unsigned& b, unsigned& a) {
+                r = p[0]; g = p[1]; b = p[2]; a = p[3];
+            }
+            static inline void store(unsigned char* p, unsigned r, unsigned g, unsigned b, unsigned a) {
+                p[0] = (unsigned char)r; p[1] = (unsigned char)g; p[2] = (unsigned char)b; p[3] = (unsigned char)a;
+            }
+        };
 
-    static void _cgame_free_backbuffer(void) {
-        if (_cgame_memdc) {
-            if (_cgame_oldbmp) {
-                SelectObject(_cgame_memdc, _cgame_oldbmp);
-                _cgame_oldbmp = NULL;
+        struct FormatBGRA8 {   // GDI+ PixelFormat32bppPARGB and asset pack blobs, premultiplied
+            static inline void load(const unsigned char* p, unsigned& r, unsigned& g, unsigned& b, unsigned& a) {
+                b = p[0]; g = p[1]; r = p[2]; a = p[3];
             }
-            if (_cgame_membmp) {
-                DeleteObject(_cgame_membmp);
-                _cgame_membmp = NULL;
+            static inline void store(unsigned char* p, unsigned r, unsigned g, unsigned b, unsigned a) {
+                p[0] = (unsigned char)b; p[1] = (unsigned char)g; p[2] = (unsigned char)r; p[3] = (unsigned char)a;
             }
-            DeleteDC(_cgame_memdc);
-            _cgame_memdc = NULL;
+        };
+
+        // v * a / 255, rounded
+        static inline unsigned mul255(unsigned v, unsigned a) {
+            unsigned t = v * a + 128;
+            return (t + (t >> 8)) >> 8;
         }
-    }
 
-    // =========================
-    // OpenGL helpers
-    // =========================
-    static bool _cgame_init_opengl(HWND hwnd, HDC* hdc, HGLRC* hglrc) {
-        PIXELFORMATDESCRIPTOR pfd = {
-            sizeof(PIXELFORMATDESCRIPTOR),
-            1,
-            PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER,
-            PFD_TYPE_RGBA,
-            32, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-            24, 8, 0,
-            PFD_MAIN_PLANE,
-            0, 0, 0, 0
+        // Blend modes; r, g, b arrive premultiplied by a
+        struct BlendCopy {
+            template <class F>
+            static inline void apply(unsigned char* d, unsigned r, unsigned g, unsigned b, unsigned a) {
+                F::store(d, r, g, b, a);
+            }
         };
 
-        *hdc = GetDC(hwnd);
-        if (!*hdc) return false;
+        struct BlendAlpha {    // source over
+            template <class F>
+            static inline void apply(unsigned char* d, unsigned r, unsigned g, unsigned b, unsigned a) {
+                if (a == 255) { F::store(d, r, g, b, a); return; }
+                unsigned dr, dg, db, da, ia = 255 - a;
+                F::load(d, dr, dg, db, da);
+                F::store(d, r + mul255(dr, ia), g + mul255(dg, ia), b + mul255(db, ia), a + mul255(da, ia));
+            }
+        };
 
-        int pixelFormat = ChoosePixelFormat(*hdc, &pfd);
-        if (!pixelFormat) {
-            ReleaseDC(hwnd, *hdc);
-            return false;
-        }
+        struct BlendAdd {      // saturating add
+            template <class F>
+            static inline void apply(unsigned char* d, unsigned r, unsigned g, unsigned b, unsigned a) {
+                unsigned dr, dg, db, da;
+                F::load(d, dr, dg, db, da);
+                dr += r; dg += g; db += b; da += a;
+                F::store(d, dr > 255 ? 255 : dr, dg > 255 ? 255 : dg, db > 255 ? 255 : db, da > 255 ? 255 : da);
+            }
+        };
 
-        if (!SetPixelFormat(*hdc, pixelFormat, &pfd)) {
-            ReleaseDC(hwnd, *hdc);
-            return false;
-        }
+        template <class Format = FormatBGRX8, class Blend = BlendCopy>
+        struct Canvas {
+            unsigned char* pixels;
+            int            width, height;
+            int            stride;   // bytes per row
 
-        *hglrc = wglCreateContext(*hdc);
-        if (!*hglrc) {
-            ReleaseDC(hwnd, *hdc);
-            return false;
-        }
+            Canvas() : pixels(0), width(0), height(0), stride(0) {}
+            Canvas(unsigned char* p, int w, int h, int stride_bytes = 0)
+                : pixels(p), width(p ? w : 0), height(p ? h : 0), stride(stride_bytes ? stride_bytes : w * 4) {}
 
-        if (!wglMakeCurrent(*hdc, *hglrc)) {
-            wglDeleteContext(*hglrc);
-            ReleaseDC(hwnd, *hdc);
-            return false;
+            bool valid(void) const { return pixels != 0; }
+            unsigned char* row(int y) const { return pixels + (size_t)y * stride; }
+
+            // One pixel, no bounds check
+            inline void put_unchecked(int x, int y, int r, int g, int b, int a = 255) {
+                if (a != 255) { r = mul255(r, a); g = mul255(g, a); b = mul255(b, a); }
+                Blend::template apply<Format>(row(y) + (size_t)x * 4, r, g, b, a);
+            }
+
+            inline void put(int x, int y, int r, int g, int b, int a = 255) {
+                if ((unsigned)x < (unsigned)width && (unsigned)y < (unsigned)height) put_unchecked(x, y, r, g, b, a);
+            }
+
+            void fill_rect(int x, int y, int w, int h, int r, int g, int b, int a = 255) {
+                int x0 = x < 0 ? 0 : x, x1 = x + w > width  ? width  : x + w;
+                int y0 = y < 0 ? 0 : y, y1 = y + h > height ? height : y + h;
+                if (x0 >= x1 || y0 >= y1) return;
+                if (a != 255) { r = mul255(r, a); g = mul255(g, a); b = mul255(b, a); }
+                for (int yy = y0; yy < y1; ++yy) {
+                    unsigned char* d = row(yy) + (size_t)x0 * 4;
+                    for (int xx = x0; xx < x1; ++xx, d += 4) Blend::template apply<Format>(d, r, g, b, a);
+                }
+            }
+
+            void clear(int r, int g, int b) {
+                Canvas<Format, BlendCopy>(pixels, width, height, stride).fill_rect(0, 0, width, height, r, g, b);
+            }
+
+            // Blend a w*h block of premultiplied SrcFormat pixels with its top-left at (x, y), clipped
+            template <class SrcFormat>
+            void blit(const unsigned char* src, int w, int h, int src_stride, int x, int y) {
+                if (!src) return;
+                int sx = x < 0 ? -x : 0, ex = x + w > width  ? width  - x : w;
+                int sy = y < 0 ? -y : 0, ey = y + h > height ? height - y : h;
+                for (int yy = sy; yy < ey; ++yy) {
+                    const unsigned char* s = src + (size_t)yy * src_stride + (size_t)sx * 4;
+                    unsigned char* d = row(y + yy) + (size_t)(x + sx) * 4;
+                    for (int xx = sx; xx < ex; ++xx, s += 4, d += 4) {
+                        unsigned r, g, b, a;
+                        SrcFormat::load(s, r, g, b, a);
+                        Blend::template apply<Format>(d, r, g, b, a);
+                    }
+                }
+            }
+
+            void blit(const CGameImage* img, int x, int y) {
+                if (img && img->pixels) blit<FormatRGBA8>(img->pixels, img->width, img->height, img->width * 4, x, y);
+            }
+        };
+
+        // The backbuffer as a canvas, once pending GDI work has landed; empty in GPU modes or
+        // before set_mode. Valid until the next set_mode or resize.
+        template <class Blend = BlendCopy>
+        static inline Canvas<FormatBGRX8, Blend> screen(void) {
+            int w = 0, h = 0;
+            unsigned char* p = (unsigned char*)cgame.display.get_pixels(&w, &h);
+            return Canvas<FormatBGRX8, Blend>(p, w, h);
         }
+    }
 
-        return true;
+#endif
+
+#if !defined(CGAME_SHARED) || defined(CGAME_IMPLEMENTATION)
+
+// |---------------------------------------------------------------------------|
+//  Platform-neutral core
+//  - Code here touches no OS API: allocation, the glyph atlas, pixel
+//    surfaces and the TrueType parser/rasterizer. The platform blocks
+//    below build on it; on a platform without one the header compiles
+//    to just this. Functions here are static inline, so a translation
+//    unit that uses none of them stays free of unused warnings.
+// |---------------------------------------------------------------------------|
+
+    #include <stdlib.h>
+    #include <string.h>
+    #include <math.h>
+    #if defined(_MSC_VER)
+    #include <intrin.h>
+    #define _cgame_atomic_add64(p, v) _InterlockedExchangeAdd64((p), (v))
+    #else
+    #define _cgame_atomic_add64(p, v) __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+    #endif
+
+    // =========================
+    // Counted allocation
+    //  - Requested bytes add to _cgame_stats_bytes while frame stats are
+    //    on; display.flip collects and zeroes the count.
+    // =========================
+    static bool               _cgame_stats_on = false;
+    static volatile long long _cgame_stats_bytes = 0;  // allocations may come from any thread
+
+    static inline void* _cgame_malloc(size_t size) {
+        if (_cgame_stats_on) _cgame_atomic_add64(&_cgame_stats_bytes, (long long)size);
+        return malloc(size);
     }
-    
 
-    static void _cgame_cleanup_opengl(HDC hdc, HGLRC hglrc) {
-        if (hglrc) {
-            wglMakeCurrent(NULL, NULL);
-            wglDeleteContext(hglrc);
-        }
-        if (hdc) {
-            ReleaseDC(_cgame_screen.hwnd, hdc);
-        }
+    static inline void* _cgame_calloc(size_t count, size_t size) {
+        if (_cgame_stats_on) _cgame_atomic_add64(&_cgame_stats_bytes, (long long)(count * size));
+        return calloc(count, size);
+    }
+
+    static inline void* _cgame_realloc(void* p, size_t size) {
+        if (_cgame_stats_on) _cgame_atomic_add64(&_cgame_stats_bytes, (long long)size);
+        return realloc(p, size);
     }
 
     // =========================
-    // Vulkan helpers (lightweight runtime detection)
-    //  - This does not implement a full Vulkan setup. It attempts to
-    //    load the Vulkan runtime (vulkan-1.dll) so the host has Vulkan
-    //    available. Full instance/device/swapchain creation is left to
-    //    the user or later extension code.
+    // Glyph atlas
     // =========================
-    static bool _cgame_init_vulkan(HWND hwnd, HMODULE* vk_lib_out) {
-        if (!vk_lib_out) return false;
-        *vk_lib_out = LoadLibraryA("vulkan-1.dll");
-        if (!*vk_lib_out) {
-            MessageBoxW(hwnd,
-                        L"Vulkan runtime (vulkan-1.dll) not found.\nInstall Vulkan runtime/SDK or remove CGAME_VULKAN flag.",
-                        L"CGame Vulkan Error",
-                        MB_OK | MB_ICONERROR);
-            return false;
+    #define CGAME_TEXT_ATLAS_WIDTH  512
+
+    // 8-bit coverage atlas, shelf packed, grows downwards
+    typedef struct {
+        unsigned char* pixels;       // CGAME_TEXT_ATLAS_WIDTH wide
+        int            height;
+        int            shelf_x, shelf_y, shelf_h;
+    } CGameAtlas;
+
+    typedef struct {
+        unsigned short x, y, w, h;   // rect in the atlas
+        short          bx, by;       // pen → bitmap left, baseline → bitmap top (up is positive)
+        short          advance;
+        bool           loaded;
+    } CGameGlyph;
+
+    // Decode one UTF-8 code point and advance; malformed bytes yield U+FFFD
+    static inline unsigned int _cgame_utf8_next(const char** s) {
+        const unsigned char* p = (const unsigned char*)*s;
+        unsigned int c = p[0];
+        int n = 0;
+        if      (c < 0x80)           { *s += 1; return c; }
+        else if ((c & 0xE0) == 0xC0) { c &= 0x1F; n = 1; }
+        else if ((c & 0xF0) == 0xE0) { c &= 0x0F; n = 2; }
+        else if ((c & 0xF8) == 0xF0) { c &= 0x07; n = 3; }
+        else                         { *s += 1; return 0xFFFD; }
+        for (int i = 1; i <= n; ++i) {
+            if ((p[i] & 0xC0) != 0x80) { *s += i; return 0xFFFD; }
+            c = (c << 6) | (p[i] & 0x3F);
         }
-        /* We don't create a Vulkan instance here — this is a safe runtime detection
-           scaffold so user code (or a later extension) can link Vulkan functions
-           and create instance/device/swapchain as desired. */
-        return true;
+        *s += n + 1;
+        return c;
     }
 
-    static void _cgame_cleanup_vulkan(HMODULE vk_lib) {
-        if (vk_lib) {
-            FreeLibrary(vk_lib);
-        }
+    static inline bool _cgame_atlas_init(CGameAtlas* at) {
+        at->height  = 256;
+        at->pixels  = (unsigned char*)_cgame_calloc((size_t)CGAME_TEXT_ATLAS_WIDTH * at->height, 1);
+        at->shelf_x = at->shelf_y = 1;
+        at->shelf_h = 0;
+        return at->pixels != NULL;
     }
 
-    static bool _cgame_init_d3d12(HWND hwnd, HMODULE* d3d12_lib_out) {
-        *d3d12_lib_out = LoadLibraryA("d3d12.dll");
-        if (!*d3d12_lib_out) {
-            MessageBoxW(hwnd,
-                L"Direct3D 12 runtime (d3d12.dll) not found.\nInstall latest DirectX runtime or remove CGAME_D3D12 flag.",
-                L"CGame D3D12 Error",
-                MB_OK | MB_ICONERROR);
-            return false;
+    // Reserve a w*h rect on the current shelf, growing the atlas downwards when needed
+    static inline bool _cgame_atlas_alloc(CGameAtlas* at, int w, int h, int* ox, int* oy) {
+        if (w + 2 > CGAME_TEXT_ATLAS_WIDTH) return false;
+        if (at->shelf_x + w + 1 > CGAME_TEXT_ATLAS_WIDTH) {
+            at->shelf_y += at->shelf_h + 1;
+            at->shelf_x = 1;
+            at->shelf_h = 0;
         }
-
-        /* Full D3D12 setup (device, swapchain, command queue) left to user.
-        We only load the runtime dynamically and provide placeholders. */
+        while (at->shelf_y + h + 1 > at->height) {
+            int nh = at->height * 2;
+            unsigned char* a = (unsigned char*)_cgame_realloc(at->pixels, (size_t)CGAME_TEXT_ATLAS_WIDTH * nh);
+            if (!a) return false;
+            memset(a + (size_t)CGAME_TEXT_ATLAS_WIDTH * at->height, 0,
+                   (size_t)CGAME_TEXT_ATLAS_WIDTH * (nh - at->height));
+            at->pixels = a;
+            at->height = nh;
+        }
+        *ox = at->shelf_x;
+        *oy = at->shelf_y;
+        at->shelf_x += w + 1;
+        if (h > at->shelf_h) at->shelf_h = h;
         return true;
     }
 
-    static void _cgame_cleanup_d3d12(HMODULE d3d12_lib) {
-        if (d3d12_lib) FreeLibrary(d3d12_lib);
+    // =========================
+    // Pixel surfaces
+    //  - A plain BGRX buffer the core text paths draw into; the Win32
+    //    side wraps the current target's backbuffer as one.
+    // =========================
+    typedef struct {
+        unsigned char* pixels;       // BGRX, top-down
+        int            width, height;
+        int            stride;       // bytes per row
+    } CGameSurface;
+
+    // d += (colour - d) * a / 255 on one BGRX pixel
+    static inline void _cgame_blend_px(unsigned char* d, int a, int r, int g, int b) {
+        if (a == 255) {
+            d[0] = (unsigned char)b; d[1] = (unsigned char)g; d[2] = (unsigned char)r;
+            return;
+        }
+        int t;
+        t = (b - d[0]) * a + 128; d[0] = (unsigned char)(d[0] + ((t + (t >> 8)) >> 8));
+        t = (g - d[1]) * a + 128; d[1] = (unsigned char)(d[1] + ((t + (t >> 8)) >> 8));
+        t = (r - d[2]) * a + 128; d[2] = (unsigned char)(d[2] + ((t + (t >> 8)) >> 8));
+    }
+
+    // Blend a coverage rect into the surface with a solid colour, clipped to it
+    static inline void _cgame_surface_blit_coverage(const CGameSurface* sf, const unsigned char* cov, int cov_stride,
+                                                    int w, int h, int dx, int dy, int r, int g, int b) {
+        int x0 = dx < 0 ? -dx : 0;
+        int y0 = dy < 0 ? -dy : 0;
+        int x1 = (dx + w > sf->width) ? sf->width - dx : w;
+        int y1 = (dy + h > sf->height) ? sf->height - dy : h;
+        for (int y = y0; y < y1; ++y) {
+            const unsigned char* src = cov + (size_t)y * cov_stride;
+            unsigned char* dst = sf->pixels + (size_t)(dy + y) * sf->stride + (size_t)dx * 4;
+            for (int x = x0; x < x1; ++x) {
+                if (src[x]) _cgame_blend_px(dst + x * 4, src[x], r, g, b);
+            }
+        }
     }
 
     // =========================================================
-    // Image subsystem
+    // Built-in TrueType fonts
+    //  - Parser, outline flattener, rasterizer and SDF generator work on
+    //    the font bytes alone: no GDI, GDI+ or OS font services.
+    //  - Bitmap mode caches glyphs per pixel size; SDF mode caches one
+    //    distance-field set per font and scales it to any size at draw.
+    //  - Reads cmap (formats 4/12), glyf/loca (simple + composite),
+    //    hmtx and the legacy 'kern' table. TrueType outlines only (no CFF).
+    //  - Everything up to _cgame_ttf_draw_surface is core; loading from
+    //    a path and drawing to a render target are per platform.
     // =========================================================
-    typedef struct {
-        int width;
-        int height;
-        int channels;
-        unsigned char* pixels;
-        Gdiplus::Bitmap* gdi_bitmap; // keep only this
-    } CGameImage;
+    #define CGAME_TTF_MAX_SIZES   8
+    #define CGAME_TTF_SDF_PX      48.0f  // size the distance fields are generated at
+    #define CGAME_TTF_SDF_SPREAD  6      // distance range in SDF pixels, also the glyph padding
 
+    typedef struct { float x0, y0, x1, y1; } CGameTTFSeg;
 
-    // Helpers: free pixel + HBITMAP
+    typedef struct {
+        CGameTTFSeg* segs;
+        int          count, cap;
+    } CGameTTFOutline;
 
-    // =========================
-// SAFETY CHECK HELPERS
-// =========================
-    static inline bool _cgame_safe_to_draw() {
-        return (_cgame_memdc && _cgame_screen.hwnd && IsWindow(_cgame_screen.hwnd));
+    typedef struct {
+        float       px;
+        CGameAtlas  atlas;
+        CGameGlyph* pages[256];   // glyph id >> 8, allocated on first use
+        unsigned long long last_used;
+    } CGameTTFSize;
+
+    typedef struct CGameTTF CGameTTF;
+
+    struct CGameTTF {
+        unsigned char* data;
+        size_t         size;
+        unsigned int   cmap, loca, glyf, hmtx, kern_pairs;
+        int            cmap_format;
+        int            num_glyphs, num_hmetrics, units_per_em, loca_long;
+        int            ascent, descent, line_gap;
+        int            kern_count;
+        bool           sdf;
+        CGameTTFSize*  sizes[CGAME_TTF_MAX_SIZES];
+        int            size_count;
+        unsigned long long clock;
+        CGameAtlas     sdf_atlas;
+        CGameGlyph*    sdf_pages[256];
+    };
+
+    static inline unsigned int _cgame_be16(const unsigned char* p) { return ((unsigned int)p[0] << 8) | p[1]; }
+    static inline int          _cgame_bes16(const unsigned char* p) { return (short)_cgame_be16(p); }
+    static inline unsigned int _cgame_be32(const unsigned char* p) {
+        return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
     }
 
-    static bool _cgame_image_from_gdiplus_bitmap(Gdiplus::Bitmap* bmp, CGameImage* out)
-    {
-        if (!bmp || !out) return false;
+    static inline unsigned int _cgame_ttf_table(const unsigned char* data, size_t size, const char* tag) {
+        if (size < 12) return 0;
+        unsigned int n = _cgame_be16(data + 4);
+        for (unsigned int i = 0; i < n; ++i) {
+            const unsigned char* rec = data + 12 + 16 * i;
+            if (rec + 16 > data + size) return 0;
+            if (memcmp(rec, tag, 4) == 0) {
+                unsigned int off = _cgame_be32(rec + 8), len = _cgame_be32(rec + 12);
+                return (off < size && len <= size - off) ? off : 0;
+            }
+        }
+        return 0;
+    }
 
-        UINT w = bmp->GetWidth();
-        UINT h = bmp->GetHeight();
-        out->width = (int)w;
-        out->height = (int)h;
-        out->channels = 4;
-        out->gdi_bitmap = NULL;
-        out->pixels = NULL;
+    static inline void _cgame_ttf_free_impl(CGameTTF* font) {
+        if (!font) return;
+        for (int i = 0; i < font->size_count; ++i) {
+            for (int p = 0; p < 256; ++p) free(font->sizes[i]->pages[p]);
+            free(font->sizes[i]->atlas.pixels);
+            free(font->sizes[i]);
+        }
+        for (int p = 0; p < 256; ++p) free(font->sdf_pages[p]);
+        free(font->sdf_atlas.pixels);
+        free(font->data);
+        free(font);
+    }
 
-        // Allocate pixel buffer (RGBA)
-        size_t total = (size_t)w * (size_t)h * 4;
-        out->pixels = (unsigned char*)malloc(total);
-        if (!out->pixels) return false;
+    // Takes a private copy of the font bytes
+    static inline CGameTTF* _cgame_ttf_load_memory_impl(const void* bytes, size_t size) {
+        if (!bytes || size < 12) return NULL;
+        CGameTTF* f = (CGameTTF*)_cgame_calloc(1, sizeof(CGameTTF));
+        if (!f) return NULL;
+        f->data = (unsigned char*)_cgame_malloc(size);
+        if (!f->data) { free(f); return NULL; }
+        memcpy(f->data, bytes, size);
+        f->size = size;
+
+        const unsigned char* d = f->data;
+        unsigned int head = _cgame_ttf_table(d, size, "head");
+        unsigned int hhea = _cgame_ttf_table(d, size, "hhea");
+        unsigned int maxp = _cgame_ttf_table(d, size, "maxp");
+        unsigned int cmap = _cgame_ttf_table(d, size, "cmap");
+        f->loca = _cgame_ttf_table(d, size, "loca");
+        f->glyf = _cgame_ttf_table(d, size, "glyf");
+        f->hmtx = _cgame_ttf_table(d, size, "hmtx");
+        if (!head || !hhea || !maxp || !cmap || !f->loca || !f->glyf || !f->hmtx ||
+            head + 54 > size || hhea + 36 > size || maxp + 6 > size) {
+            _cgame_ttf_free_impl(f);
+            return NULL;
+        }
 
-        // Lock the GDI+ bitmap and read pixels
-        Gdiplus::Rect rect(0, 0, w, h);
-        Gdiplus::BitmapData bd;
-        if (bmp->LockBits(&rect, Gdiplus::ImageLockModeRead, PixelFormat32bppPARGB, &bd) != Gdiplus::Ok)
-        {
-            free(out->pixels);
-            out->pixels = NULL;
-            return false;
+        f->units_per_em = (int)_cgame_be16(d + head + 18);
+        f->loca_long    = _cgame_bes16(d + head + 50) != 0;
+        f->ascent       = _cgame_bes16(d + hhea + 4);
+        f->descent      = _cgame_bes16(d + hhea + 6);
+        f->line_gap     = _cgame_bes16(d + hhea + 8);
+        f->num_hmetrics = (int)_cgame_be16(d + hhea + 34);
+        f->num_glyphs   = (int)_cgame_be16(d + maxp + 4);
+        if (f->units_per_em <= 0 || f->num_hmetrics <= 0 ||
+            (size_t)f->hmtx + 4u * f->num_hmetrics > size ||
+            (size_t)f->loca + (f->num_glyphs + 1) * (f->loca_long ? 4u : 2u) > size) {
+            _cgame_ttf_free_impl(f);
+            return NULL;
         }
 
-        for (UINT y = 0; y < h; ++y)
-        {
-            unsigned char* dstRow = out->pixels + (size_t)y * w * 4;
-            unsigned char* srcRow = (unsigned char*)bd.Scan0 + (size_t)y * bd.Stride;
+        // Prefer full-repertoire Unicode (format 12), then BMP (format 4)
+        unsigned int nsub = (cmap + 4 <= size) ? _cgame_be16(d + cmap + 2) : 0;
+        for (unsigned int i = 0; i < nsub; ++i) {
+            const unsigned char* rec = d + cmap + 4 + 8 * i;
+            if (rec + 8 > d + size) break;
+            unsigned int platform = _cgame_be16(rec), encoding = _cgame_be16(rec + 2);
+            unsigned long long at = (unsigned long long)cmap + _cgame_be32(rec + 4);
+            if (at + 2 > size) continue;
+            unsigned int off = (unsigned int)at;
+            unsigned int format = _cgame_be16(d + off);
+            bool unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+            if (!unicode) continue;
+            // Headers up to ngroups (format 12) or segCountX2 and the end codes (format 4)
+            if (format == 12 && at + 16 > size) continue;
+            if (format == 4 && at + 14 > size) continue;
+            if (format == 12 && f->cmap_format != 12) { f->cmap = off; f->cmap_format = 12; }
+            else if (format == 4 && !f->cmap_format)  { f->cmap = off; f->cmap_format = 4; }
+        }
+        if (!f->cmap_format) { _cgame_ttf_free_impl(f); return NULL; }
+
+        // Legacy kern table: first horizontal format-0 subtable
+        unsigned int kern = _cgame_ttf_table(d, size, "kern");
+        if (kern && kern + 18 <= size && _cgame_be16(d + kern) == 0 && _cgame_be16(d + kern + 2) > 0) {
+            unsigned int coverage = _cgame_be16(d + kern + 8);
+            unsigned int npairs   = _cgame_be16(d + kern + 10);
+            if ((coverage & 0xFF03) == 0x0001 && kern + 18 + 6 * npairs <= size) {
+                f->kern_pairs = kern + 18;
+                f->kern_count = (int)npairs;
+            }
+        }
 
-            for (UINT x = 0; x < w; ++x)
-            {
-                unsigned char b = srcRow[x*4 + 0];
-                unsigned char g = srcRow[x*4 + 1];
-                unsigned char r = srcRow[x*4 + 2];
-                unsigned char a = srcRow[x*4 + 3];
+        if (!_cgame_atlas_init(&f->sdf_atlas)) { _cgame_ttf_free_impl(f); return NULL; }
+        return f;
+    }
 
-                dstRow[x*4 + 0] = r;
-                dstRow[x*4 + 1] = g;
-                dstRow[x*4 + 2] = b;
-                dstRow[x*4 + 3] = a;
+    // Raw cmap entry for cp; unchecked against the glyph count
+    static inline unsigned int _cgame_ttf_cmap_lookup(const CGameTTF* f, unsigned int cp) {
+        const unsigned char* d = f->data;
+        if (f->cmap_format == 12) {
+            unsigned int ngroups = _cgame_be32(d + f->cmap + 12);
+            if ((size_t)f->cmap + 16 + 12ull * ngroups > f->size) return 0;
+            int lo = 0, hi = (int)ngroups - 1;
+            while (lo <= hi) {
+                int mid = (lo + hi) >> 1;
+                const unsigned char* g = d + f->cmap + 16 + 12 * mid;
+                unsigned int start = _cgame_be32(g), end = _cgame_be32(g + 4);
+                if (cp < start) hi = mid - 1;
+                else if (cp > end) lo = mid + 1;
+                else return _cgame_be32(g + 8) + (cp - start);
             }
+            return 0;
         }
 
-        bmp->UnlockBits(&bd);
+        // format 4
+        if (cp > 0xFFFF) return 0;
+        unsigned int segx2 = _cgame_be16(d + f->cmap + 6);
+        unsigned int ends = f->cmap + 14;
+        unsigned int starts = ends + segx2 + 2;
+        unsigned int deltas = starts + segx2;
+        unsigned int ranges = deltas + segx2;
+        if (ranges + segx2 > f->size) return 0;
+        for (unsigned int i = 0; i < segx2; i += 2) {
+            if (cp > _cgame_be16(d + ends + i)) continue;
+            unsigned int start = _cgame_be16(d + starts + i);
+            if (cp < start) return 0;
+            unsigned int delta = _cgame_be16(d + deltas + i);
+            unsigned int range = _cgame_be16(d + ranges + i);
+            if (range == 0) return (cp + delta) & 0xFFFF;
+            unsigned int at = ranges + i + range + 2 * (cp - start);
+            if (at + 2 > f->size) return 0;
+            unsigned int gid = _cgame_be16(d + at);
+            return gid ? (gid + delta) & 0xFFFF : 0;
+        }
+        return 0;
+    }
 
-        // Clone the bitmap for GDI+ use
-        out->gdi_bitmap = bmp->Clone(0, 0, w, h, PixelFormat32bppPARGB);
-        return (out->gdi_bitmap != NULL);
+    // Glyph id for cp, 0 (.notdef) when the cmap points past the font's glyphs
+    static inline int _cgame_ttf_glyph_index(const CGameTTF* f, unsigned int cp) {
+        unsigned int gid = _cgame_ttf_cmap_lookup(f, cp);
+        return gid < (unsigned int)f->num_glyphs ? (int)gid : 0;
     }
 
+    static inline int _cgame_ttf_advance(const CGameTTF* f, int gid) {
+        if (gid < 0) return 0;
+        int i = (gid < f->num_hmetrics) ? gid : f->num_hmetrics - 1;
+        return (int)_cgame_be16(f->data + f->hmtx + 4 * i);
+    }
 
-    static void _cgame_image_free_impl(CGameImage* img) {
-        if (!img) return;
-        if (img->gdi_bitmap) { delete img->gdi_bitmap; img->gdi_bitmap = NULL; }
-        if (img->pixels) { free(img->pixels); img->pixels = NULL; }
-        img->width = img->height = img->channels = 0;
+    static inline int _cgame_ttf_kern(const CGameTTF* f, int left, int right) {
+        if (!f->kern_count) return 0;
+        unsigned int key = ((unsigned int)left << 16) | (unsigned int)right;
+        int lo = 0, hi = f->kern_count - 1;
+        while (lo <= hi) {
+            int mid = (lo + hi) >> 1;
+            const unsigned char* p = f->data + f->kern_pairs + 6 * mid;
+            unsigned int k = _cgame_be32(p);
+            if (k == key) return _cgame_bes16(p + 4);
+            if (k < key) lo = mid + 1; else hi = mid - 1;
+        }
+        return 0;
     }
 
+    static inline bool _cgame_ttf_glyph_range(const CGameTTF* f, int gid, unsigned int* start, unsigned int* end) {
+        if (gid < 0 || gid >= f->num_glyphs) return false;
+        const unsigned char* loca = f->data + f->loca;
+        unsigned int a, b;
+        if (f->loca_long) { a = _cgame_be32(loca + 4 * gid); b = _cgame_be32(loca + 4 * gid + 4); }
+        else              { a = _cgame_be16(loca + 2 * gid) * 2; b = _cgame_be16(loca + 2 * gid + 2) * 2; }
+        if (b <= a || (size_t)f->glyf + b > f->size) return false; // empty glyph (space) or broken
+        *start = f->glyf + a;
+        *end   = f->glyf + b;
+        return true;
+    }
 
-    // Load image from file path using GDI+static 
-    CGameImage _cgame_image_load_impl(const char* path) {
-        CGameImage img = {0,0,0,NULL,NULL};
-        if (!path) return img;
+    static inline void _cgame_ttf_line(CGameTTFOutline* o, float x0, float y0, float x1, float y1) {
+        if (y0 == y1 && x0 == x1) return;
+        if (o->count == o->cap) {
+            int cap = o->cap ? o->cap * 2 : 128;
+            CGameTTFSeg* s = (CGameTTFSeg*)_cgame_realloc(o->segs, sizeof(CGameTTFSeg) * cap);
+            if (!s) return;
+            o->segs = s;
+            o->cap = cap;
+        }
+        CGameTTFSeg* s = &o->segs[o->count++];
+        s->x0 = x0; s->y0 = y0; s->x1 = x1; s->y1 = y1;
+    }
 
-        // Ensure GDI+ started
+    static inline void _cgame_ttf_quad(CGameTTFOutline* o, float x0, float y0, float cx, float cy, float x1, float y1) {
+        float ddx = x0 - 2 * cx + x1, ddy = y0 - 2 * cy + y1;
+        int n = 1 + (int)sqrtf(sqrtf(ddx * ddx + ddy * ddy) * 0.7f); // ~0.2px flatness
+        if (n > 32) n = 32;
+        float px = x0, py = y0;
+        for (int i = 1; i <= n; ++i) {
+            float t = (float)i / n, mt = 1 - t;
+            float qx = mt * mt * x0 + 2 * mt * t * cx + t * t * x1;
+            float qy = mt * mt * y0 + 2 * mt * t * cy + t * t * y1;
+            _cgame_ttf_line(o, px, py, qx, qy);
+            px = qx; py = qy;
+        }
+    }
+
+    // Append a glyph's contours as pixel-space line segments (y down, origin on the baseline).
+    // m = {a, b, c, d, e, f} maps font units: x' = a*x + c*y + e, y' = b*x + d*y + f
+    static inline void _cgame_ttf_outline(const CGameTTF* f, int gid, const float* m, float scale,
+                                          CGameTTFOutline* o, int depth) {
+        unsigned int start, end;
+        if (depth > 8 || !_cgame_ttf_glyph_range(f, gid, &start, &end) || end - start < 10) return;
+        const unsigned char* d = f->data;
+        const unsigned char* g = d + start;
+        const unsigned char* gend = d + end;
+        int ncontours = _cgame_bes16(g);
+
+        if (ncontours < 0) {
+            // Composite: transformed references to other glyphs
+            const unsigned char* p = g + 10;
+            unsigned int flags;
+            do {
+                if (p + 4 > gend) return;
+                flags = _cgame_be16(p);
+                int sub = (int)_cgame_be16(p + 2);
+                p += 4;
+                float dx, dy;
+                if (flags & 0x0001) { if (p + 4 > gend) return; dx = (float)_cgame_bes16(p); dy = (float)_cgame_bes16(p + 2); p += 4; }
+                else                { if (p + 2 > gend) return; dx = (float)(signed char)p[0]; dy = (float)(signed char)p[1]; p += 2; }
+                if (!(flags & 0x0002)) dx = dy = 0; // point matching is not supported
+                float a = 1, b = 0, c = 0, e = 1;
+                if (flags & 0x0008)      { if (p + 2 > gend) return; a = e = _cgame_bes16(p) / 16384.0f; p += 2; }
+                else if (flags & 0x0040) { if (p + 4 > gend) return; a = _cgame_bes16(p) / 16384.0f; e = _cgame_bes16(p + 2) / 16384.0f; p += 4; }
+                else if (flags & 0x0080) {
+                    if (p + 8 > gend) return;
+                    a = _cgame_bes16(p) / 16384.0f;     b = _cgame_bes16(p + 2) / 16384.0f;
+                    c = _cgame_bes16(p + 4) / 16384.0f; e = _cgame_bes16(p + 6) / 16384.0f;
+                    p += 8;
+                }
+                float sm[6] = {
+                    m[0] * a + m[2] * b,  m[1] * a + m[3] * b,
+                    m[0] * c + m[2] * e,  m[1] * c + m[3] * e,
+                    m[0] * dx + m[2] * dy + m[4],  m[1] * dx + m[3] * dy + m[5]
+                };
+                _cgame_ttf_outline(f, sub, sm, scale, o, depth + 1);
+            } while (flags & 0x0020);
+            return;
+        }
+
+        // Simple glyph: end points, instructions, packed flags, then delta-coded x and y
+        const unsigned char* p = g + 10;
+        if (ncontours == 0 || p + 2 * ncontours + 2 > gend) return;
+        int npts = (int)_cgame_be16(p + 2 * (ncontours - 1)) + 1;
+        p += 2 * ncontours;
+        p += 2 + _cgame_be16(p);
+        if (p > gend) return;
+
+        unsigned char* fl = (unsigned char*)_cgame_malloc((size_t)npts);
+        float* xy = (float*)_cgame_malloc(sizeof(float) * 2 * (size_t)npts);
+        if (!fl || !xy) { free(fl); free(xy); return; }
+
+        bool ok = true;
+        for (int i = 0; i < npts && ok; ) {
+            if (p >= gend) { ok = false; break; }
+            unsigned char flag = *p++;
+            int repeat = 0;
+            if (flag & 8) { if (p >= gend) { ok = false; break; } repeat = *p++; }
+            for (int r = 0; r <= repeat && i < npts; ++r) fl[i++] = flag;
+        }
+        int v = 0;
+        for (int i = 0; i < npts && ok; ++i) {
+            unsigned char flag = fl[i];
+            if (flag & 2)         { if (p >= gend) { ok = false; break; } v += (flag & 16) ? *p : -(int)*p; p += 1; }
+            else if (!(flag & 16)) { if (p + 2 > gend) { ok = false; break; } v += _cgame_bes16(p); p += 2; }
+            xy[2 * i] = (float)v;
+        }
+        v = 0;
+        for (int i = 0; i < npts && ok; ++i) {
+            unsigned char flag = fl[i];
+            if (flag & 4)         { if (p >= gend) { ok = false; break; } v += (flag & 32) ? *p : -(int)*p; p += 1; }
+            else if (!(flag & 32)) { if (p + 2 > gend) { ok = false; break; } v += _cgame_bes16(p); p += 2; }
+            xy[2 * i + 1] = (float)v;
+        }
+
+        // font units → pixels (y flipped)
+        for (int i = 0; ok && i < npts; ++i) {
+            float x = xy[2 * i], y = xy[2 * i + 1];
+            xy[2 * i]     =  (m[0] * x + m[2] * y + m[4]) * scale;
+            xy[2 * i + 1] = -(m[1] * x + m[3] * y + m[5]) * scale;
+        }
+
+        int first = 0;
+        const unsigned char* endpts = g + 10;
+        for (int c = 0; ok && c < ncontours; ++c) {
+            int last = (int)_cgame_be16(endpts + 2 * c);
+            if (last < first || last >= npts) break;
+            int n = last - first + 1;
+
+            // Start on an on-curve point; if there is none, at the midpoint of the first two
+            int k = 0;
+            while (k < n && !(fl[first + k] & 1)) ++k;
+            float sx, sy;
+            int base, steps;
+            if (k < n) {
+                sx = xy[2 * (first + k)];
+                sy = xy[2 * (first + k) + 1];
+                base = k + 1;
+                steps = n - 1;
+            } else {
+                int i1 = first + (n > 1 ? 1 : 0);
+                sx = (xy[2 * first] + xy[2 * i1]) * 0.5f;
+                sy = (xy[2 * first + 1] + xy[2 * i1 + 1]) * 0.5f;
+                base = 1;
+                steps = n;
+            }
+
+            float cx = sx, cy = sy, qx = 0, qy = 0;
+            bool has_ctrl = false;
+            for (int step = 0; step <= steps; ++step) {
+                bool closing = (step == steps);
+                int i = first + (base + step) % n;
+                float px = closing ? sx : xy[2 * i];
+                float py = closing ? sy : xy[2 * i + 1];
+                if (closing || (fl[i] & 1)) {
+                    if (has_ctrl) _cgame_ttf_quad(o, cx, cy, qx, qy, px, py);
+                    else          _cgame_ttf_line(o, cx, cy, px, py);
+                    cx = px; cy = py;
+                    has_ctrl = false;
+                } else {
+                    if (has_ctrl) {
+                        float mx = (qx + px) * 0.5f, my = (qy + py) * 0.5f;
+                        _cgame_ttf_quad(o, cx, cy, qx, qy, mx, my);
+                        cx = mx; cy = my;
+                    }
+                    qx = px; qy = py;
+                    has_ctrl = true;
+                }
+            }
+            first = last + 1;
+        }
+
+        free(fl);
+        free(xy);
+    }
+
+    // Signed-area coverage rasterizer: every segment deposits its exact area
+    // into the cells it crosses; a running sum along each row gives coverage.
+    static inline void _cgame_ttf_raster_line(float* acc, int w, int h, float x0, float y0, float x1, float y1) {
+        if (fabsf(y0 - y1) <= 1e-6f) return;
+        float dir = 1.0f;
+        if (y0 > y1) {
+            float t;
+            t = x0; x0 = x1; x1 = t;
+            t = y0; y0 = y1; y1 = t;
+            dir = -1.0f;
+        }
+        float dxdy = (x1 - x0) / (y1 - y0);
+        float x = x0;
+        int ys = (int)y0;
+        if (y0 < 0) { x -= y0 * dxdy; ys = 0; }
+        int ye = (int)ceilf(y1);
+        if (ye > h) ye = h;
+        const float xmax = (float)w - 1.001f;
+
+        for (int y = ys; y < ye; ++y) {
+            float* row = acc + (size_t)y * w;
+            float dy = fminf((float)(y + 1), y1) - fmaxf((float)y, y0);
+            float xnext = x + dxdy * dy;
+            float d = dy * dir;
+            float xa = fminf(fmaxf(fminf(x, xnext), 0.0f), xmax);
+            float xb = fminf(fmaxf(fmaxf(x, xnext), 0.0f), xmax);
+            float xa_floor = floorf(xa);
+            float xb_ceil  = ceilf(xb);
+            int xai = (int)xa_floor, xbi = (int)xb_ceil;
+
+            if (xbi <= xai + 1) {
+                float xmf = 0.5f * (xa + xb) - xa_floor;
+                row[xai]     += d - d * xmf;
+                row[xai + 1] += d * xmf;
+            } else {
+                float s   = 1.0f / (xb - xa);
+                float xaf = xa - xa_floor;
+                float a0  = 0.5f * s * (1.0f - xaf) * (1.0f - xaf);
+                float xbf = xb - xb_ceil + 1.0f;
+                float am  = 0.5f * s * xbf * xbf;
+                row[xai] += d * a0;
+                if (xbi == xai + 2) {
+                    row[xai + 1] += d * (1.0f - a0 - am);
+                } else {
+                    float a1 = s * (1.5f - xaf);
+                    row[xai + 1] += d * (a1 - a0);
+                    for (int xi = xai + 2; xi < xbi - 1; ++xi) row[xi] += d * s;
+                    float a2 = a1 + (float)(xbi - xai - 3) * s;
+                    row[xbi - 1] += d * (1.0f - a2 - am);
+                }
+                row[xbi] += d * am;
+            }
+            x = xnext;
+        }
+    }
+
+    static inline void _cgame_ttf_raster(const CGameTTFOutline* o, int w, int h, unsigned char* out) {
+        float* acc = (float*)_cgame_calloc((size_t)w * h + 1, sizeof(float));
+        if (!acc) { memset(out, 0, (size_t)w * h); return; }
+        for (int i = 0; i < o->count; ++i) {
+            const CGameTTFSeg* s = &o->segs[i];
+            _cgame_ttf_raster_line(acc, w, h, s->x0, s->y0, s->x1, s->y1);
+        }
+        for (int y = 0; y < h; ++y) {
+            const float* row = acc + (size_t)y * w;
+            unsigned char* dst = out + (size_t)y * w;
+            float sum = 0;
+            for (int x = 0; x < w; ++x) {
+                sum += row[x];
+                float v = fabsf(sum);
+                dst[x] = (unsigned char)(v >= 1.0f ? 255 : (int)(v * 255.0f + 0.5f));
+            }
+        }
+        free(acc);
+    }
+
+    // Coverage (sdf == false) or signed distance field (sdf == true) for one glyph.
+    // Returns a malloc'd w*h bitmap; (bx, by) place it like CGameGlyph does.
+    static inline unsigned char* _cgame_ttf_render(const CGameTTF* f, int gid, float px, bool sdf, CGameTTFOutline* o,
+                                                   int* w, int* h, int* bx, int* by) {
+        static const float identity[6] = { 1, 0, 0, 1, 0, 0 };
+        o->count = 0;
+        _cgame_ttf_outline(f, gid, identity, px / f->units_per_em, o, 0);
+        if (o->count == 0) return NULL;
+
+        float minx = o->segs[0].x0, maxx = minx, miny = o->segs[0].y0, maxy = miny;
+        for (int i = 0; i < o->count; ++i) {
+            const CGameTTFSeg* s = &o->segs[i];
+            minx = fminf(minx, fminf(s->x0, s->x1)); maxx = fmaxf(maxx, fmaxf(s->x0, s->x1));
+            miny = fminf(miny, fminf(s->y0, s->y1)); maxy = fmaxf(maxy, fmaxf(s->y0, s->y1));
+        }
+
+        int pad = sdf ? CGAME_TTF_SDF_SPREAD : 0;
+        int ix0 = (int)floorf(minx) - pad, iy0 = (int)floorf(miny) - pad;
+        *w = (int)ceilf(maxx) - ix0 + 1 + pad;
+        *h = (int)ceilf(maxy) - iy0 + pad;
+        *bx = ix0;
+        *by = -iy0;
+        if (*w <= 0 || *h <= 0 || *w > 4096 || *h > 4096) return NULL;
+
+        for (int i = 0; i < o->count; ++i) {
+            CGameTTFSeg* s = &o->segs[i];
+            s->x0 -= ix0; s->x1 -= ix0;
+            s->y0 -= iy0; s->y1 -= iy0;
+        }
+
+        unsigned char* cov = (unsigned char*)_cgame_malloc((size_t)*w * *h);
+        if (!cov) return NULL;
+        _cgame_ttf_raster(o, *w, *h, cov);
+        if (!sdf) return cov;
+
+        // Distance to the nearest edge, signed by coverage, mapped to 0..255 with 128 on the outline
+        unsigned char* field = (unsigned char*)_cgame_malloc((size_t)*w * *h);
+        if (!field) { free(cov); return NULL; }
+        const float spread = (float)CGAME_TTF_SDF_SPREAD;
+        for (int y = 0; y < *h; ++y) {
+            for (int x = 0; x < *w; ++x) {
+                float cx = x + 0.5f, cy = y + 0.5f;
+                float best = spread * spread;
+                for (int i = 0; i < o->count; ++i) {
+                    const CGameTTFSeg* s = &o->segs[i];
+                    float ex = s->x1 - s->x0, ey = s->y1 - s->y0;
+                    float qx = cx - s->x0, qy = cy - s->y0;
+                    float len2 = ex * ex + ey * ey;
+                    float t = len2 > 0 ? (qx * ex + qy * ey) / len2 : 0;
+                    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+                    float dx = qx - ex * t, dy = qy - ey * t;
+                    float d2 = dx * dx + dy * dy;
+                    if (d2 < best) best = d2;
+                }
+                float dist = sqrtf(best);
+                if (cov[(size_t)y * *w + x] < 128) dist = -dist;
+                int v = 128 + (int)lroundf(dist * 127.0f / spread);
+                field[(size_t)y * *w + x] = (unsigned char)(v < 0 ? 0 : (v > 255 ? 255 : v));
+            }
+        }
+        free(cov);
+        return field;
+    }
+
+    static inline CGameGlyph* _cgame_ttf_page_glyph(CGameGlyph** pages, int gid) {
+        CGameGlyph** page = &pages[(gid >> 8) & 0xFF];
+        if (!*page) *page = (CGameGlyph*)_cgame_calloc(256, sizeof(CGameGlyph));
+        return *page ? &(*page)[gid & 0xFF] : NULL;
+    }
+
+    static inline void _cgame_ttf_cache_glyph(const CGameTTF* f, int gid, float px, bool sdf, CGameAtlas* atlas,
+                                              CGameGlyph* g, CGameTTFOutline* o) {
+        int w, h, bx, by, ax, ay;
+        g->loaded = true;
+        unsigned char* bmp = _cgame_ttf_render(f, gid, px, sdf, o, &w, &h, &bx, &by);
+        if (!bmp) return;
+        if (_cgame_atlas_alloc(atlas, w, h, &ax, &ay)) {
+            for (int y = 0; y < h; ++y)
+                memcpy(atlas->pixels + (size_t)(ay + y) * CGAME_TEXT_ATLAS_WIDTH + ax, bmp + (size_t)y * w, (size_t)w);
+            g->x = (unsigned short)ax; g->y = (unsigned short)ay;
+            g->w = (unsigned short)w;  g->h = (unsigned short)h;
+            g->bx = (short)bx;         g->by = (short)by;
+        }
+        free(bmp);
+    }
+
+    static inline CGameTTFSize* _cgame_ttf_size_get(CGameTTF* f, float px) {
+        for (int i = 0; i < f->size_count; ++i) {
+            if (f->sizes[i]->px == px) {
+                f->sizes[i]->last_used = ++f->clock;
+                return f->sizes[i];
+            }
+        }
+        CGameTTFSize* sz = (CGameTTFSize*)_cgame_calloc(1, sizeof(CGameTTFSize));
+        if (!sz) return NULL;
+        if (!_cgame_atlas_init(&sz->atlas)) { free(sz); return NULL; }
+        sz->px = px;
+        sz->last_used = ++f->clock;
+
+        if (f->size_count == CGAME_TTF_MAX_SIZES) {
+            int lru = 0;
+            for (int i = 1; i < f->size_count; ++i)
+                if (f->sizes[i]->last_used < f->sizes[lru]->last_used) lru = i;
+            for (int p = 0; p < 256; ++p) free(f->sizes[lru]->pages[p]);
+            free(f->sizes[lru]->atlas.pixels);
+            free(f->sizes[lru]);
+            f->sizes[lru] = f->sizes[--f->size_count];
+        }
+        f->sizes[f->size_count++] = sz;
+        return sz;
+    }
+
+    // Bilinear-sample a distance field scaled by s and blend its inside in a solid colour
+    static inline void _cgame_surface_blit_sdf(const CGameSurface* sf, const unsigned char* field, int stride, int sw, int sh,
+                                               float fx, float fy, float s, int r, int g, int b) {
+        int x0 = (int)floorf(fx), y0 = (int)floorf(fy);
+        int x1 = (int)ceilf(fx + sw * s), y1 = (int)ceilf(fy + sh * s);
+        if (x0 < 0) x0 = 0;
+        if (y0 < 0) y0 = 0;
+        if (x1 > sf->width) x1 = sf->width;
+        if (y1 > sf->height) y1 = sf->height;
+
+        const float inv = 1.0f / s;
+        const float to_px = (float)CGAME_TTF_SDF_SPREAD / 127.0f * s; // field units → target pixels
+        for (int ty = y0; ty < y1; ++ty) {
+            float v = (ty + 0.5f - fy) * inv - 0.5f;
+            int vi = (int)floorf(v);
+            float vf = v - vi;
+            unsigned char* dst = sf->pixels + (size_t)ty * sf->stride;
+            for (int tx = x0; tx < x1; ++tx) {
+                float u = (tx + 0.5f - fx) * inv - 0.5f;
+                int ui = (int)floorf(u);
+                float uf = u - ui;
+                float t[4];
+                for (int k = 0; k < 4; ++k) {
+                    int sx = ui + (k & 1), sy = vi + (k >> 1);
+                    t[k] = (sx < 0 || sy < 0 || sx >= sw || sy >= sh) ? 0.0f : field[(size_t)sy * stride + sx];
+                }
+                float val = (t[0] + (t[1] - t[0]) * uf) * (1 - vf) + (t[2] + (t[3] - t[2]) * uf) * vf;
+                float a = (val - 128.0f) * to_px + 0.5f;
+                if (a <= 0.0f) continue;
+                _cgame_blend_px(dst + tx * 4, a >= 1.0f ? 255 : (int)(a * 255.0f + 0.5f), r, g, b);
+            }
+        }
+    }
+
+    static inline void _cgame_ttf_set_sdf_impl(CGameTTF* font, bool enabled) {
+        if (font) font->sdf = enabled;
+    }
+
+    // Draw text into a surface. (x, y) is the top of the first line; px is the em size in pixels.
+    // Returns the glyph area blitted; *right and *bottom get the pen extent.
+    static inline double _cgame_ttf_draw_surface(const CGameSurface* sf, CGameTTF* f, const char* text, int x, int y,
+                                                 float px, int r, int g, int b, float* right_out, float* bottom_out) {
+        if (!sf->pixels || !f || !text || px <= 0) return 0;
+        CGameTTFSize* sz = f->sdf ? NULL : _cgame_ttf_size_get(f, px);
+        if (!f->sdf && !sz) return 0;
+
+        CGameTTFOutline o = { NULL, 0, 0 };
+        const float scale  = px / f->units_per_em;
+        const float line_h = (f->ascent - f->descent + f->line_gap) * scale;
+        const float sdf_s  = px / CGAME_TTF_SDF_PX;
+        float pen = (float)x;
+        float baseline = y + f->ascent * scale;
+        float right = pen;
+        int prev = -1;
+        double area = 0;
+
+        const char* s = text;
+        while (*s) {
+            unsigned int cp = _cgame_utf8_next(&s);
+            if (cp == '\r') continue;
+            if (cp == '\n') {
+                pen = (float)x;
+                baseline += line_h;
+                prev = -1;
+                continue;
+            }
+            int gid = _cgame_ttf_glyph_index(f, cp);
+            if (prev >= 0) pen += _cgame_ttf_kern(f, prev, gid) * scale;
+
+            if (f->sdf) {
+                CGameGlyph* gl = _cgame_ttf_page_glyph(f->sdf_pages, gid);
+                if (gl && !gl->loaded) _cgame_ttf_cache_glyph(f, gid, CGAME_TTF_SDF_PX, true, &f->sdf_atlas, gl, &o);
+                if (gl && gl->w && gl->h) {
+                    _cgame_surface_blit_sdf(sf, f->sdf_atlas.pixels + (size_t)gl->y * CGAME_TEXT_ATLAS_WIDTH + gl->x,
+                                            CGAME_TEXT_ATLAS_WIDTH, gl->w, gl->h,
+                                            pen + gl->bx * sdf_s, baseline - gl->by * sdf_s, sdf_s, r, g, b);
+                    area += gl->w * gl->h * sdf_s * sdf_s;
+                }
+            } else {
+                CGameGlyph* gl = _cgame_ttf_page_glyph(sz->pages, gid);
+                if (gl && !gl->loaded) _cgame_ttf_cache_glyph(f, gid, px, false, &sz->atlas, gl, &o);
+                if (gl && gl->w && gl->h) {
+                    _cgame_surface_blit_coverage(sf, sz->atlas.pixels + (size_t)gl->y * CGAME_TEXT_ATLAS_WIDTH + gl->x,
+                                                 CGAME_TEXT_ATLAS_WIDTH, gl->w, gl->h,
+                                                 (int)floorf(pen + 0.5f) + gl->bx, (int)floorf(baseline + 0.5f) - gl->by,
+                                                 r, g, b);
+                    area += gl->w * gl->h;
+                }
+            }
+            pen += _cgame_ttf_advance(f, gid) * scale;
+            if (pen > right) right = pen;
+            prev = gid;
+        }
+        free(o.segs);
+        *right_out = right;
+        *bottom_out = baseline;
+        return area;
+    }
+
+
+#if defined(_WIN32) || defined(_WIN64)
+
+// |---------------------------------------------------------------------------|
+//     []   []    [] [][][] []  [] [][]    [][]  []    []   [][]
+//      []  []    []   []   [][ [] []  [] []  [] []    [] []
+// [][][][] [] [] []   []   [][][] []  [] []  [] [] [] [] [][][]
+//      []  [][][][]   []   [] ][] []  [] []  [] [][][][]     []
+//     []   []    [] [][][] []  [] [][]    [][]  []    [] [][]
+// |---------------------------------------------------------------------------|
+
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+    #if defined(NO_STRICT)
+    #error "cgame.h needs STRICT handle types (the public structs forward-declare HWND__, HDC__, ...)"
+    #endif
+    #include <windowsx.h>
+    #include <objidl.h>
+    // Define PROPID if it's not defined
+    #ifndef PROPID
+    #define PROPID unsigned long
+    #endif
+    #include <gdiplus.h>
+    #include <stdlib.h>
+    #include <string.h>
+    #include <math.h>
+    #include <stdio.h>
+    #include <limits.h>
+    #if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CGAME_FAST_SSE2 1
+    #include <emmintrin.h>
+    #endif
+
+    using namespace Gdiplus;
+
+    // -------------------------
+    // GDI+ helper globals
+    // -------------------------
+    static ULONG_PTR _cgame_gdiplusToken = 0;
+    static bool _cgame_gdiplus_inited = false;
+
+
+    // =========================
+    // Internal limits
+    // =========================
+    #define CGAME_WM_SET_RAW       (WM_APP + 1)  // internal: (un)register raw mouse input on the window thread
+
+    #ifndef CGAME_EVENT_QUEUE_SIZE
+    #define CGAME_EVENT_QUEUE_SIZE 1024   // power of two
+    #endif
+
+    #ifndef CGAME_MOTION_HISTORY
+    #define CGAME_MOTION_HISTORY 512   // samples kept per frame
+    #endif
+
+    // =========================
+    // Internal globals
+    // =========================
+    static HINSTANCE   _cgame_hInstance = NULL;
+    static bool        _cgame_running = true;
+    static CGameScreen _cgame_screen = { 0 };
+
+    // Event ring: the window procedure appends, event.get/poll/drain consume
+    static CGameEvent  _cgame_events[CGAME_EVENT_QUEUE_SIZE];
+    static unsigned    _cgame_event_head = 0, _cgame_event_tail = 0;
+    static unsigned    _cgame_event_dropped = 0;
+    static LARGE_INTEGER _cgame_qpc_freq = { 0 }, _cgame_qpc_start = { 0 };
+    // The clock's only seed, set while globals are initialized: before any thread can read it
+    static int         _cgame_qpc_seeded = (QueryPerformanceFrequency(&_cgame_qpc_freq),
+                                            QueryPerformanceCounter(&_cgame_qpc_start), 1);
+    static HANDLE      _cgame_pace_timer = NULL;   // frame pacer's waitable timer
+    static bool        _cgame_pace_timer_tried = false;
+    static long long   _cgame_frame_period_ns = 0;  // frame pacer period, 0 = unpaced
+
+    // Render target: a DIB section and everything draw calls keep per surface.
+    // The window's backbuffer is _cgame_screen_rt; every draw call goes to the
+    // calling thread's _cgame_rt, which is the screen until cgame.context.make_current.
+    struct CGameContext {
+        HDC            memdc;
+        HBITMAP        membmp;
+        HGDIOBJ        oldbmp;
+        unsigned char* membits;   // DIB pixels (BGRX, top-down, stride = width * 4)
+        int            memw, memh;
+        COLORREF       bgcolor;
+        struct CGameFontCaches*  fonts;    // glyph atlases, made on first text draw
+        struct CGameTextLayouts* layouts;  // cached layouts of long strings
+        volatile LONG  owner;     // id of the thread it is bound on, 0 = none (offscreen contexts)
+    };
+
+    static CGameContext               _cgame_screen_rt = { NULL, NULL, NULL, NULL, 0, 0, RGB(0,0,0), NULL, NULL, 0 };
+    static thread_local CGameContext* _cgame_rt = &_cgame_screen_rt;
+
+    // A thread that ends with a context bound gives it up, so a later thread reusing its id doesn't own it
+    struct CGameContextBinding {
+        CGameContext* ctx;
+        ~CGameContextBinding() { if (ctx) InterlockedCompareExchange(&ctx->owner, 0, (LONG)GetCurrentThreadId()); }
+    };
+    static thread_local CGameContextBinding _cgame_rt_binding = { NULL };
+
+    static WPARAM      _cgame_last_key = 0;
+
+    // Input state as bitsets (bit = virtual key / CGameButton*). The window procedure
+    // writes the live set and records transitions; once per frame the first event
+    // pump after display.flip copies them into the snapshot the queries read.
+    #define CGAME_KEY_WORDS 4 // 256 virtual keys
+    static unsigned long long _cgame_key_live[CGAME_KEY_WORDS]       = { 0 };
+    static unsigned long long _cgame_key_went_down[CGAME_KEY_WORDS]  = { 0 };
+    static unsigned long long _cgame_key_went_up[CGAME_KEY_WORDS]    = { 0 };
+    static unsigned long long _cgame_key_now[CGAME_KEY_WORDS]        = { 0 };
+    static unsigned long long _cgame_key_pressed[CGAME_KEY_WORDS]    = { 0 }; // just pressed this frame
+    static unsigned long long _cgame_key_released[CGAME_KEY_WORDS]   = { 0 }; // just released this frame
+    static unsigned int       _cgame_mouse_live = 0, _cgame_mouse_went_down = 0, _cgame_mouse_went_up = 0;
+    static unsigned int       _cgame_mouse_now = 0, _cgame_mouse_pressed = 0, _cgame_mouse_released = 0;
+    static unsigned long long _cgame_frame_index = 0;          // advanced by display.flip
+    static unsigned long long _cgame_input_frame = (unsigned long long)-1; // frame of the last snapshot
+
+    static int         _cgame_mouse_x = 0, _cgame_mouse_y = 0;
+    static int         _cgame_mouse_wheel = 0;  // 120 per notch, drained by mouse.get_wheel
+
+    // Per-frame motion history, wheel and raw deltas: accumulated live, swapped in by the snapshot
+    static CGameMotionSample _cgame_motion_live[CGAME_MOTION_HISTORY];
+    static CGameMotionSample _cgame_motion_frame[CGAME_MOTION_HISTORY];
+    static int         _cgame_motion_live_count = 0, _cgame_motion_frame_count = 0;
+    static int         _cgame_wheel_live_x = 0, _cgame_wheel_live_y = 0;
+    static int         _cgame_wheel_frame_x = 0, _cgame_wheel_frame_y = 0;
+    static int         _cgame_raw_live_dx = 0, _cgame_raw_live_dy = 0;
+    static int         _cgame_raw_frame_dx = 0, _cgame_raw_frame_dy = 0;
+    static bool        _cgame_mouse_full_rate = false;  // recover coalesced WM_MOUSEMOVE points
+    static bool        _cgame_mouse_raw = false;        // raw input registered
+
+    // font 
+    static Gdiplus::PrivateFontCollection _cgame_font_collection;
+
+
+    // Forward declarations
+    static void _cgame_make_backbuffer(int w, int h);
+    static void _cgame_free_backbuffer(void);
+    /* OPENGL THE GOAT :) */
+    static bool _cgame_init_opengl(HWND hwnd, HDC* hdc, HGLRC* hglrc);
+    static void _cgame_cleanup_opengl(HDC hdc, HGLRC hglrc);
+
+    /* Vulkan stubs / runtime detection (lightweight) */
+    static bool _cgame_init_vulkan(HWND hwnd, HMODULE* vk_lib_out);
+    static void _cgame_cleanup_vulkan(HMODULE vk_lib);
+
+    /* DIRECT X 12 */
+    static bool _cgame_init_d3d12(HWND hwnd, HMODULE* d3d12_lib_out);
+    static void _cgame_cleanup_d3d12(HMODULE d3d12_lib);
+
+
+    /* small helper to centralize FillRect usage */
+    static void _cgame_fill_dc(HDC dc, int w, int h, COLORREF color);
+
+    /* text glyph caches (released on quit) */
+    static void _cgame_font_cache_free_all(CGameContext* rt);
+
+    /* event pump thread (joined on quit) */
+    static HANDLE        _cgame_pump_thread = NULL;
+    static volatile bool _cgame_pump_quit_sent = false;   // WM_CLOSE already queued CGAME_QUIT
+    static void _cgame_pump_thread_stop(void);
+
+    /* debug overlay (drawn by display.flip) */
+    static void _cgame_hud_draw(void);
+
+    /* input recording / replay (flushed and released on quit) */
+    static bool _cgame_record_stop_impl(void);
+    static void _cgame_replay_stop_impl(void);
+    static void _cgame_replay_feed(void);
+
+    static WCHAR _cgame_window_title [256] = L"CGame Window";
+    static HICON _cgame_window_icon = NULL;
+
+
+    // =========================
+    // Event queue
+    // =========================
+    // Monotonic nanoseconds since the program started; never re-seeded, so stamps taken
+    // before cgame.init and after it stay in order
+    static long long _cgame_now_ns(void) {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        long long ticks = now.QuadPart - _cgame_qpc_start.QuadPart;
+        // split to keep ticks * 1e9 from overflowing on long uptimes
+        return (ticks / _cgame_qpc_freq.QuadPart) * 1000000000LL +
+               (ticks % _cgame_qpc_freq.QuadPart) * 1000000000LL / _cgame_qpc_freq.QuadPart;
+    }
+
+    static long long _cgame_now_us(void) { return _cgame_now_ns() / 1000; }
+
+    static void _cgame_input_key(int vk, bool down) {
+        unsigned long long bit = 1ULL << (vk & 63);
+        unsigned long long* live = &_cgame_key_live[(vk & 0xFF) >> 6];
+        if (down && !(*live & bit))  _cgame_key_went_down[(vk & 0xFF) >> 6] |= bit; // not auto-repeat
+        if (!down && (*live & bit))  _cgame_key_went_up[(vk & 0xFF) >> 6]   |= bit;
+        if (down) *live |= bit; else *live &= ~bit;
+    }
+
+    static void _cgame_input_button(int button, bool down) {
+        unsigned int bit = 1u << button;
+        if (down && !(_cgame_mouse_live & bit)) _cgame_mouse_went_down |= bit;
+        if (!down && (_cgame_mouse_live & bit)) _cgame_mouse_went_up   |= bit;
+        if (down) _cgame_mouse_live |= bit; else _cgame_mouse_live &= ~bit;
+    }
+
+    // Frame snapshot: a tap that starts and ends between two snapshots still reports both edges
+    static void _cgame_input_snapshot(void) {
+        for (int i = 0; i < CGAME_KEY_WORDS; ++i) {
+            _cgame_key_now[i]      = _cgame_key_live[i];
+            _cgame_key_pressed[i]  = _cgame_key_went_down[i];
+            _cgame_key_released[i] = _cgame_key_went_up[i];
+            _cgame_key_went_down[i] = _cgame_key_went_up[i] = 0;
+        }
+        _cgame_mouse_now      = _cgame_mouse_live;
+        _cgame_mouse_pressed  = _cgame_mouse_went_down;
+        _cgame_mouse_released = _cgame_mouse_went_up;
+        _cgame_mouse_went_down = _cgame_mouse_went_up = 0;
+
+        memcpy(_cgame_motion_frame, _cgame_motion_live, sizeof(CGameMotionSample) * _cgame_motion_live_count);
+        _cgame_motion_frame_count = _cgame_motion_live_count;
+        _cgame_motion_live_count = 0;
+        _cgame_wheel_frame_x = _cgame_wheel_live_x;
+        _cgame_wheel_frame_y = _cgame_wheel_live_y;
+        _cgame_raw_frame_dx  = _cgame_raw_live_dx;
+        _cgame_raw_frame_dy  = _cgame_raw_live_dy;
+        _cgame_wheel_live_x = _cgame_wheel_live_y = 0;
+        _cgame_raw_live_dx = _cgame_raw_live_dy = 0;
+    }
+
+    // Full history keeps the first samples and always the latest one in the last slot
+    static void _cgame_motion_append(int x, int y, long long time_us) {
+        int i = _cgame_motion_live_count < CGAME_MOTION_HISTORY ? _cgame_motion_live_count++ : CGAME_MOTION_HISTORY - 1;
+        _cgame_motion_live[i].x = x;
+        _cgame_motion_live[i].y = y;
+        _cgame_motion_live[i].time_us = time_us;
+    }
+
+    // =========================
+    // Frame counters (cgame.debug)
+    //  - Off unless the HUD or debug.track is on; every draw path then
+    //    adds one call and its estimated pixel coverage (analytic area of
+    //    the shape, minus the share of its bounds off the backbuffer).
+    //  - display.flip closes the frame: the totals move to
+    //    _cgame_stats_last and the live set starts over.
+    //  - Heap use goes through _cgame_malloc/calloc/realloc (in the core,
+    //    above) so requested bytes can be counted.
+    // =========================
+    static bool            _cgame_hud_on = false;
+    static CGameFrameStats _cgame_stats_live = { { 0 } };
+    static CGameFrameStats _cgame_stats_last = { { 0 } };
+    static long long       _cgame_stats_last_flip = 0;
+
+    // One primitive of about `area` pixels within the bounds (x, y, w, h); the share of the
+    // bounds off the backbuffer is discounted. area < 0: the bounds are fully covered.
+    // Empty bounds count area as is.
+    static void _cgame_stat_prim(int prim, int x, int y, int w, int h, double area) {
+        if (_cgame_rt != &_cgame_screen_rt || !_cgame_stats_on) return;
+        _cgame_stats_live.calls[prim]++;
+        if (w <= 0 || h <= 0) {
+            if (area > 0) _cgame_stats_live.pixels[prim] += (long long)area;
+            return;
+        }
+        int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+        int x1 = x + w > _cgame_rt->memw ? _cgame_rt->memw : x + w;
+        int y1 = y + h > _cgame_rt->memh ? _cgame_rt->memh : y + h;
+        if (x1 <= x0 || y1 <= y0) return;
+        double inside = (double)(x1 - x0) * (y1 - y0);
+        _cgame_stats_live.pixels[prim] += (long long)(area < 0 ? inside : area * inside / ((double)w * h));
+    }
+
+    // Pixels a stroke of the given length and width covers, at most its bounds
+    static double _cgame_stat_outline(double length, int width, int w, int h) {
+        double a = length * (width > 0 ? width : 1);
+        double box = (double)w * h;
+        return a < box ? a : box;
+    }
+
+    // Corner radius the rounded-rect path actually uses
+    static double _cgame_stat_corner(int w, int h, int radius) {
+        int d = radius * 2;
+        if (d > w) d = w;
+        if (d > h) d = h;
+        return d > 0 ? d / 2.0 : 0.0;
+    }
+
+    static void _cgame_stat_bounds(const int* xs, const int* ys, int count, int* x, int* y, int* w, int* h) {
+        int x0 = xs[0], x1 = xs[0], y0 = ys[0], y1 = ys[0];
+        for (int i = 1; i < count; i++) {
+            if (xs[i] < x0) x0 = xs[i];
+            if (xs[i] > x1) x1 = xs[i];
+            if (ys[i] < y0) y0 = ys[i];
+            if (ys[i] > y1) y1 = ys[i];
+        }
+        *x = x0; *y = y0; *w = x1 - x0 + 1; *h = y1 - y0 + 1;
+    }
+
+    // Close the frame's counters (display.flip)
+    static void _cgame_stats_frame(void) {
+        long long now = _cgame_now_ns();
+        CGameFrameStats* s = &_cgame_stats_live;
+        s->frame_ns = _cgame_stats_last_flip ? now - _cgame_stats_last_flip : 0;
+        _cgame_stats_last_flip = now;
+        if (!_cgame_stats_on) return;
+
+        s->draw_calls = s->pixels_filled = 0;
+        for (int i = 0; i < CGAME_PRIM_COUNT; ++i) {
+            if (i != CGAME_PRIM_CLEAR) s->draw_calls += s->calls[i];
+            s->pixels_filled += s->pixels[i];
+        }
+        s->blits = s->calls[CGAME_PRIM_IMAGE];
+        s->text_calls = s->calls[CGAME_PRIM_TEXT];
+        s->bytes_allocated = InterlockedExchange64(&_cgame_stats_bytes, 0);
+        _cgame_stats_last = *s;
+        memset(s, 0, sizeof(*s));
+    }
+
+    // =========================
+    // Profiler (zones; export and summary live after the timing helpers)
+    //  - CGAME_ZONE("name") times the rest of the enclosing scope;
+    //    cgame.profile.begin/end do the same by hand. Names are kept by
+    //    pointer, so pass string literals.
+    //  - Each thread records into its own ring, allocated on its first
+    //    zone; the oldest zones are overwritten. No locks on the hot path.
+    //  - Disabled (the default) a zone costs one flag test.
+    //  - display.flip closes a "frame" zone and feeds the frame-time
+    //    percentiles.
+    // =========================
+    #ifndef CGAME_PROFILE_RING
+    #define CGAME_PROFILE_RING    65536   // zones kept per thread, power of two
+    #endif
+    #define CGAME_PROFILE_DEPTH   64      // deeper nesting is tracked but not recorded
+    #define CGAME_PROFILE_THREADS 64
+    #define CGAME_PROFILE_FRAMES  4096    // frame times kept for the summary
+
+    typedef struct {
+        const char* name;
+        long long   start_ns;   // cgame.time.now_ns clock
+        long long   dur_ns;
+        int         depth;      // 0 = outermost on its thread
+    } CGameProfileZone;
+
+    typedef struct {
+        DWORD             tid;
+        CGameProfileZone* ring;
+        unsigned int      head;         // next slot
+        volatile bool     full;         // ring has wrapped
+        int               depth;
+        const char*       open_name [CGAME_PROFILE_DEPTH];
+        long long         open_start[CGAME_PROFILE_DEPTH];
+    } CGameProfileThread;
+
+    static volatile bool       _cgame_prof_enabled = false;
+    static CGameProfileThread* _cgame_prof_threads[CGAME_PROFILE_THREADS];
+    static volatile LONG       _cgame_prof_thread_count = 0;
+    static thread_local CGameProfileThread* _cgame_prof_self = NULL;
+    static thread_local bool   _cgame_prof_self_failed = false;
+
+    static long long    _cgame_prof_frames[CGAME_PROFILE_FRAMES];  // frame times, ns
+    static unsigned int _cgame_prof_frame_count = 0;               // ever recorded
+    static long long    _cgame_prof_last_flip = 0;
+
+    // Calling thread's buffer, registered on first use; NULL once the thread table is full
+    static CGameProfileThread* _cgame_prof_thread(void) {
+        if (_cgame_prof_self || _cgame_prof_self_failed) return _cgame_prof_self;
+        CGameProfileThread* t = (CGameProfileThread*)_cgame_calloc(1, sizeof(CGameProfileThread));
+        if (t) t->ring = (CGameProfileZone*)_cgame_malloc(sizeof(CGameProfileZone) * CGAME_PROFILE_RING);
+        LONG slot = (t && t->ring) ? InterlockedIncrement(&_cgame_prof_thread_count) - 1 : CGAME_PROFILE_THREADS;
+        if (slot >= CGAME_PROFILE_THREADS) {
+            if (t) free(t->ring);
+            free(t);
+            _cgame_prof_self_failed = true;
+            return NULL;
+        }
+        t->tid = GetCurrentThreadId();
+        _cgame_prof_threads[slot] = t;
+        _cgame_prof_self = t;
+        return t;
+    }
+
+    static void _cgame_prof_record(CGameProfileThread* t, const char* name, long long start, long long end, int depth) {
+        CGameProfileZone* z = &t->ring[t->head];
+        z->name     = name;
+        z->start_ns = start;
+        z->dur_ns   = end - start;
+        z->depth    = depth;
+        MemoryBarrier(); // a reader on another thread sees the zone before the new head
+        t->head = (t->head + 1) & (CGAME_PROFILE_RING - 1);
+        if (!t->head) t->full = true;
+    }
+
+    static void _cgame_prof_begin(const char* name) {
+        CGameProfileThread* t = _cgame_prof_thread();
+        if (!t) return;
+        if (t->depth < CGAME_PROFILE_DEPTH) {
+            t->open_name [t->depth] = name;
+            t->open_start[t->depth] = _cgame_now_ns();
+        }
+        t->depth++;
+    }
+
+    static void _cgame_prof_end(void) {
+        CGameProfileThread* t = _cgame_prof_self;
+        if (!t || t->depth <= 0) return;
+        int d = --t->depth;
+        if (d < CGAME_PROFILE_DEPTH) _cgame_prof_record(t, t->open_name[d], t->open_start[d], _cgame_now_ns(), d);
+    }
+
+    // Called at the top of display.flip: the time since the previous flip is one frame
+    static void _cgame_prof_frame(void) {
+        if (!_cgame_prof_enabled) return;
+        long long now = _cgame_now_ns();
+        if (_cgame_prof_last_flip) {
+            _cgame_prof_frames[_cgame_prof_frame_count++ % CGAME_PROFILE_FRAMES] = now - _cgame_prof_last_flip;
+            CGameProfileThread* t = _cgame_prof_thread();
+            if (t) _cgame_prof_record(t, "frame", _cgame_prof_last_flip, now, 0);
+        }
+        _cgame_prof_last_flip = now;
+    }
+
+    // Scope guard behind CGAME_ZONE; a zone opened while enabled is always closed.
+    // Unnamed namespace: it calls static functions, so each unit needs its own copy.
+    namespace {
+    struct _cgame_zone_guard {
+        bool active;
+        explicit _cgame_zone_guard(const char* name) : active(_cgame_prof_enabled) {
+            if (active) _cgame_prof_begin(name);
+        }
+        ~_cgame_zone_guard() { if (active) _cgame_prof_end(); }
+    };
+    }
+
+    #define CGAME_ZONE_CAT2(a, b) a##b
+    #define CGAME_ZONE_CAT(a, b)  CGAME_ZONE_CAT2(a, b)
+    #define CGAME_ZONE(name)      _cgame_zone_guard CGAME_ZONE_CAT(_cgame_zone_, __LINE__)(name)
+
+    // =========================
+    // Input recording (state; file I/O lives with the event pump)
+    // =========================
+    typedef struct {
+        long long      time_us;  // since recording started
+        unsigned int   frame;    // frames since recording started
+        unsigned short type;
+        unsigned short key;
+        int            x, y;     // cursor position, new size (CGAME_VIDEORESIZE) or raw counts (CGAME_MOUSERAW)
+        short          wheel;
+        unsigned short button;
+        short          wheel_x;
+        unsigned short reserved;
+    } CGameInputRecord;          // 32 bytes on disk, little-endian
+
+    static CGameInputRecord*  _cgame_rec_items = NULL;
+    static int                _cgame_rec_count = 0, _cgame_rec_cap = 0;
+    static bool               _cgame_recording = false;
+    static unsigned long long _cgame_rec_frame0 = 0;
+    static long long          _cgame_rec_time0 = 0;
+
+    static CGameInputRecord*  _cgame_replay_items = NULL;  // non-NULL while a replay runs
+    static int                _cgame_replay_count = 0, _cgame_replay_pos = 0;
+    static unsigned long long _cgame_replay_frame0 = 0;
+    static long long          _cgame_replay_time0 = 0;
+
+    static void _cgame_record_append(const CGameEvent* ev) {
+        if (_cgame_rec_count == _cgame_rec_cap) {
+            int cap = _cgame_rec_cap ? _cgame_rec_cap * 2 : 4096;
+            CGameInputRecord* items = (CGameInputRecord*)_cgame_realloc(_cgame_rec_items, sizeof(CGameInputRecord) * cap);
+            if (!items) return;
+            _cgame_rec_items = items;
+            _cgame_rec_cap = cap;
+        }
+        CGameInputRecord* r = &_cgame_rec_items[_cgame_rec_count++];
+        memset(r, 0, sizeof(*r));
+        r->time_us = ev->time_us - _cgame_rec_time0;
+        r->frame   = (unsigned int)(_cgame_frame_index - _cgame_rec_frame0);
+        r->type    = (unsigned short)ev->type;
+        r->key     = (unsigned short)ev->key;
+        r->x       = ev->type == CGAME_VIDEORESIZE ? ev->width  : (ev->type == CGAME_MOUSERAW ? ev->dx : ev->x);
+        r->y       = ev->type == CGAME_VIDEORESIZE ? ev->height : (ev->type == CGAME_MOUSERAW ? ev->dy : ev->y);
+        r->wheel   = (short)ev->wheel;
+        r->wheel_x = (short)ev->wheel_x;
+        r->button  = (unsigned short)ev->button;
+    }
+
+    // =========================
+    // Event inbox (CGAME_THREADED_EVENTS)
+    //  - Events produced off the render thread (the pump thread's window
+    //    procedure, event.inject from workers) go into a bounded lock-free
+    //    MPSC queue; the render thread drains it in the event pump and
+    //    submits each one there, so input state is only touched by it.
+    // =========================
+    #ifndef CGAME_EVENT_INBOX_SIZE
+    #define CGAME_EVENT_INBOX_SIZE 4096   // power of two
+    #endif
+
+    typedef struct {
+        volatile LONG seq;   // ticket: == pos when free for producer pos, == pos + 1 when filled
+        bool          live;
+        CGameEvent    ev;
+    } CGameInboxCell;
+
+    static CGameInboxCell _cgame_inbox[CGAME_EVENT_INBOX_SIZE];
+    static volatile LONG  _cgame_inbox_tail = 0;   // producers
+    static LONG           _cgame_inbox_head = 0;   // render thread only
+    static volatile LONG  _cgame_inbox_dropped = 0;
+    static bool           _cgame_inbox_enabled = false;
+    static DWORD          _cgame_render_thread = 0;
+
+    static void _cgame_inbox_reset(void) {
+        for (LONG i = 0; i < CGAME_EVENT_INBOX_SIZE; ++i) _cgame_inbox[i].seq = i;
+        _cgame_inbox_tail = _cgame_inbox_head = 0;
+    }
+
+    static void _cgame_inbox_push(const CGameEvent* ev, bool live) {
+        LONG pos = InterlockedCompareExchange(&_cgame_inbox_tail, 0, 0);
+        for (;;) {
+            CGameInboxCell* cell = &_cgame_inbox[pos & (CGAME_EVENT_INBOX_SIZE - 1)];
+            LONG dif = InterlockedCompareExchange(&cell->seq, 0, 0) - pos; // atomic read
+            if (dif == 0) {
+                LONG seen = InterlockedCompareExchange(&_cgame_inbox_tail, pos + 1, pos);
+                if (seen == pos) {
+                    cell->ev   = *ev;
+                    cell->live = live;
+                    InterlockedExchange(&cell->seq, pos + 1); // publish
+                    return;
+                }
+                pos = seen;
+            } else if (dif < 0) {
+                InterlockedIncrement(&_cgame_inbox_dropped); // full
+                return;
+            } else {
+                pos = InterlockedCompareExchange(&_cgame_inbox_tail, 0, 0);
+            }
+        }
+    }
+
+    static bool _cgame_inbox_pop(CGameEvent* ev, bool* live) {
+        CGameInboxCell* cell = &_cgame_inbox[_cgame_inbox_head & (CGAME_EVENT_INBOX_SIZE - 1)];
+        if (InterlockedCompareExchange(&cell->seq, 0, 0) - (_cgame_inbox_head + 1) != 0) return false;
+        *ev   = cell->ev;
+        *live = cell->live;
+        InterlockedExchange(&cell->seq, _cgame_inbox_head + CGAME_EVENT_INBOX_SIZE); // free for the next lap
+        _cgame_inbox_head++;
+        return true;
+    }
+
+    // =========================
+    // Event submission
+    // =========================
+    // Append a copy to the ring; when full the new event is dropped
+    static void _cgame_event_push(const CGameEvent* ev) {
+        if (_cgame_event_tail - _cgame_event_head >= CGAME_EVENT_QUEUE_SIZE) {
+            _cgame_event_dropped++;
+            return;
+        }
+        _cgame_events[_cgame_event_tail++ & (CGAME_EVENT_QUEUE_SIZE - 1)] = *ev;
+    }
+
+    static void _cgame_display_resized(int w, int h) {
+        _cgame_screen.width = w;
+        _cgame_screen.height = h;
+        if (!_cgame_screen.use_opengl && !_cgame_screen.use_vulkan) {
+            _cgame_free_backbuffer();
+            _cgame_make_backbuffer(w, h);
+        } else {
+            /* GPU-backed (OpenGL/Vulkan) — user should handle swapchain/viewport resizing */
+        }
+    }
+
+    // Every event source ends here (window procedure, replay, inject): apply the event to
+    // the live input state, record it, then queue it. While a replay runs, live
+    // keyboard and mouse input is ignored so the recorded stream plays unchanged.
+    static void _cgame_event_submit(CGameEvent* ev, bool live) {
+        if (_cgame_inbox_enabled && GetCurrentThreadId() != _cgame_render_thread) {
+            _cgame_inbox_push(ev, live);
+            return;
+        }
+        bool input = ev->type != CGAME_QUIT && ev->type != CGAME_VIDEORESIZE;
+        if (live && input && _cgame_replay_items) return;
+        bool button = ev->type == CGAME_MOUSEBUTTONDOWN || ev->type == CGAME_MOUSEBUTTONUP;
+        if (button && (ev->button < CGameButtonLeft || ev->button > CGameButtonX2)) return; // mouse.* knows 1..5
+
+        // Buttons and wheels carry a position; getting there is a motion like any other
+        if ((button || ev->type == CGAME_MOUSEWHEEL) && (ev->x != _cgame_mouse_x || ev->y != _cgame_mouse_y)) {
+            CGameEvent move;
+            memset(&move, 0, sizeof(move));
+            move.type    = CGAME_MOUSEMOTION;
+            move.x       = ev->x;
+            move.y       = ev->y;
+            move.time_us = ev->time_us;
+            _cgame_event_submit(&move, live);
+        }
+
+        switch (ev->type) {
+        case CGAME_QUIT:            _cgame_running = false; break;
+        case CGAME_VIDEORESIZE:     _cgame_display_resized(ev->width, ev->height); break;
+        case CGAME_KEYDOWN:         _cgame_input_key(ev->key, true); break;
+        case CGAME_KEYUP:           _cgame_input_key(ev->key, false); break;
+        case CGAME_MOUSEBUTTONDOWN: _cgame_input_button(ev->button, true); break;
+        case CGAME_MOUSEBUTTONUP:   _cgame_input_button(ev->button, false); break;
+        case CGAME_MOUSEMOTION:
+            _cgame_mouse_x = ev->x;
+            _cgame_mouse_y = ev->y;
+            _cgame_motion_append(ev->x, ev->y, ev->time_us);
+            break;
+        case CGAME_MOUSEWHEEL:
+            _cgame_mouse_wheel  += ev->wheel;
+            _cgame_wheel_live_y += ev->wheel;
+            _cgame_wheel_live_x += ev->wheel_x;
+            break;
+        case CGAME_MOUSERAW:
+            _cgame_raw_live_dx += ev->dx;
+            _cgame_raw_live_dy += ev->dy;
+            break;
+        }
+        if (ev->type != CGAME_MOUSEMOTION) {
+            ev->x = _cgame_mouse_x;
+            ev->y = _cgame_mouse_y;
+        }
+
+        if (_cgame_recording) _cgame_record_append(ev);
+        _cgame_event_push(ev);
+    }
+
+    // Window-procedure side: build a record from the message and submit it
+    static void _cgame_event_os(int type, int key) {
+        CGameEvent ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.type    = type;
+        ev.key     = key;
+        ev.time_us = _cgame_now_us();
+        _cgame_event_submit(&ev, true);
+    }
+
+    // Button and wheel messages: the cursor comes from lParam (screen coordinates for wheels)
+    static void _cgame_event_os_pointer(HWND hwnd, int type, int button, int wheel, int wheel_x,
+                                        LPARAM lParam, bool screen) {
+        POINT p = { GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) };
+        if (screen) ScreenToClient(hwnd, &p);
+        CGameEvent ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.type    = type;
+        ev.button  = button;
+        ev.wheel   = wheel;
+        ev.wheel_x = wheel_x;
+        ev.x       = p.x;
+        ev.y       = p.y;
+        ev.time_us = _cgame_now_us();
+        _cgame_event_submit(&ev, true);
+    }
+
+    // Windows coalesces WM_MOUSEMOVE; ask for the points it folded into this one (up to 64, newest first)
+    static DWORD _cgame_mmp_last_time = 0;
+    static int   _cgame_mmp_last_x = 0, _cgame_mmp_last_y = 0;
+    static bool  _cgame_mmp_valid = false;
+
+    static void _cgame_mouse_recover_points(HWND hwnd, int x, int y) {
+        POINT cur = { x, y };
+        ClientToScreen(hwnd, &cur);
+        MOUSEMOVEPOINT in;
+        memset(&in, 0, sizeof(in));
+        in.x    = cur.x & 0xFFFF;
+        in.y    = cur.y & 0xFFFF;
+        in.time = (DWORD)GetMessageTime();
+
+        MOUSEMOVEPOINT pts[64];
+        int n = GetMouseMovePointsEx(sizeof(MOUSEMOVEPOINT), &in, pts, 64, GMMP_USE_DISPLAY_POINTS);
+        if (n > 1 && _cgame_mmp_valid) {
+            // pts[0] is this message; walk back to where the previous message left off
+            int end = 1;
+            while (end < n && (int)(pts[end].time - _cgame_mmp_last_time) >= 0 &&
+                   !(pts[end].time == _cgame_mmp_last_time && pts[end].x == _cgame_mmp_last_x &&
+                     pts[end].y == _cgame_mmp_last_y))
+                end++;
+
+            DWORD     now_ms = GetTickCount();
+            long long now_us = _cgame_now_us();
+            for (int i = end - 1; i >= 1; --i) {
+                POINT p = { pts[i].x > 32767 ? pts[i].x - 65536 : pts[i].x,   // multi-monitor negative coordinates
+                            pts[i].y > 32767 ? pts[i].y - 65536 : pts[i].y };
+                ScreenToClient(hwnd, &p);
+                CGameEvent ev;
+                memset(&ev, 0, sizeof(ev));
+                ev.type    = CGAME_MOUSEMOTION;
+                ev.x       = p.x;
+                ev.y       = p.y;
+                ev.time_us = now_us - (long long)(DWORD)(now_ms - pts[i].time) * 1000;
+                _cgame_event_submit(&ev, true);
+            }
+        }
+        _cgame_mmp_last_time = in.time;
+        _cgame_mmp_last_x    = in.x;
+        _cgame_mmp_last_y    = in.y;
+        _cgame_mmp_valid     = true;
+    }
+
+    // =========================
+    // Win32 window procedure
+    // =========================
+    static LRESULT CALLBACK _cgame_WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+        switch (msg) {
+        case WM_CLOSE:
+            _cgame_event_os(CGAME_QUIT, 0);
+            _cgame_pump_quit_sent = true;
+            DestroyWindow(hwnd);
+            return 0;
+
+        case WM_DESTROY:
+            PostQuitMessage(0);
+            return 0;
+
+        case WM_SIZE: {
+            int nw = LOWORD(lParam);
+            int nh = HIWORD(lParam);
+
+            // Only update if we have valid dimensions
+            if (nw > 0 && nh > 0) {
+                CGameEvent ev;
+                memset(&ev, 0, sizeof(ev));
+                ev.type    = CGAME_VIDEORESIZE;
+                ev.width   = nw;
+                ev.height  = nh;
+                ev.time_us = _cgame_now_us();
+                _cgame_event_submit(&ev, true);
+            }
+            return 0;
+        }
+
+        case WM_PAINT: {
+            if (_cgame_inbox_enabled) {
+                ValidateRect(hwnd, NULL); // the render thread owns the backbuffer; display.flip presents
+            } else if (!_cgame_screen.use_opengl && !_cgame_screen.use_vulkan && !_cgame_screen.use_d3d12) {
+                PAINTSTRUCT ps;
+                HDC hdc = BeginPaint(hwnd, &ps);
+                if (_cgame_screen_rt.memdc && _cgame_screen_rt.membmp) {
+                    BitBlt(hdc, 0, 0, _cgame_screen.width, _cgame_screen.height, _cgame_screen_rt.memdc, 0, 0, SRCCOPY);
+                } else {
+                    HBRUSH brush = CreateSolidBrush(_cgame_screen_rt.bgcolor);
+                    FillRect(hdc, &ps.rcPaint, brush);
+                    DeleteObject(brush);
+                }
+                EndPaint(hwnd, &ps);
+            } else {
+                /* For OpenGL/Vulkan/D3D12 we typically swap buffers / present from the GPU.
+                If you want an automatic paint fallback for GPU modes, implement here. */
+            }
+            return 0;
+        }
+
+        case WM_KEYDOWN:
+            _cgame_event_os(CGAME_KEYDOWN, (int)wParam);
+            return 0;
+
+        case WM_KEYUP:
+            _cgame_event_os(CGAME_KEYUP, (int)wParam);
+            return 0;
+
+        case WM_LBUTTONDOWN:
+            _cgame_event_os_pointer(hwnd, CGAME_MOUSEBUTTONDOWN, CGameButtonLeft, 0, 0, lParam, false);
+            return 0;
+
+        case WM_LBUTTONUP:
+            _cgame_event_os_pointer(hwnd, CGAME_MOUSEBUTTONUP, CGameButtonLeft, 0, 0, lParam, false);
+            return 0;
+
+        case WM_RBUTTONDOWN:
+            _cgame_event_os_pointer(hwnd, CGAME_MOUSEBUTTONDOWN, CGameButtonRight, 0, 0, lParam, false);
+            return 0;
+
+        case WM_RBUTTONUP:
+            _cgame_event_os_pointer(hwnd, CGAME_MOUSEBUTTONUP, CGameButtonRight, 0, 0, lParam, false);
+            return 0;
+
+        case WM_MBUTTONDOWN:
+            _cgame_event_os_pointer(hwnd, CGAME_MOUSEBUTTONDOWN, CGameButtonMiddle, 0, 0, lParam, false);
+            return 0;
+
+        case WM_MBUTTONUP:
+            _cgame_event_os_pointer(hwnd, CGAME_MOUSEBUTTONUP, CGameButtonMiddle, 0, 0, lParam, false);
+            return 0;
+
+        case WM_MOUSEMOVE: {
+            CGameEvent ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.type    = CGAME_MOUSEMOTION;
+            ev.x       = GET_X_LPARAM(lParam);
+            ev.y       = GET_Y_LPARAM(lParam);
+            if (_cgame_mouse_full_rate) _cgame_mouse_recover_points(hwnd, ev.x, ev.y);
+            ev.time_us = _cgame_now_us();
+            _cgame_event_submit(&ev, true);
+            return 0;
+        }
+
+        case WM_MOUSEWHEEL:
+            _cgame_event_os_pointer(hwnd, CGAME_MOUSEWHEEL, 0, GET_WHEEL_DELTA_WPARAM(wParam), 0, lParam, true);
+            return 0;
+
+        case WM_MOUSEHWHEEL:
+            _cgame_event_os_pointer(hwnd, CGAME_MOUSEWHEEL, 0, 0, GET_WHEEL_DELTA_WPARAM(wParam), lParam, true);
+            return 0;
+
+        case CGAME_WM_SET_RAW: {
+            RAWINPUTDEVICE rid;
+            rid.usUsagePage = 0x01; // generic desktop
+            rid.usUsage     = 0x02; // mouse
+            rid.dwFlags     = wParam ? 0 : RIDEV_REMOVE;
+            rid.hwndTarget  = wParam ? hwnd : NULL;
+            return RegisterRawInputDevices(&rid, 1, sizeof(rid)) ? 1 : 0;
+        }
+
+        case WM_INPUT: {
+            RAWINPUT ri;
+            UINT size = sizeof(ri);
+            if (GetRawInputData((HRAWINPUT)lParam, RID_INPUT, &ri, &size, sizeof(RAWINPUTHEADER)) != (UINT)-1 &&
+                ri.header.dwType == RIM_TYPEMOUSE && !(ri.data.mouse.usFlags & MOUSE_MOVE_ABSOLUTE) &&
+                (ri.data.mouse.lLastX || ri.data.mouse.lLastY)) {
+                CGameEvent ev;
+                memset(&ev, 0, sizeof(ev));
+                ev.type    = CGAME_MOUSERAW;
+                ev.dx      = (int)ri.data.mouse.lLastX;
+                ev.dy      = (int)ri.data.mouse.lLastY;
+                ev.time_us = _cgame_now_us();
+                _cgame_event_submit(&ev, true);
+            }
+            break; // DefWindowProc releases the raw input buffer
+        }
+
+        }
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+    }
+
+    // =========================
+    // Backbuffer helpers
+    // =========================
+    static void _cgame_fill_dc(HDC dc, int w, int h, COLORREF color) {
+        if (!dc) return;
+        HBRUSH brush = CreateSolidBrush(color);
+        RECT rc = {0,0,w,h};
+        FillRect(dc, &rc, brush);
+        DeleteObject(brush);
+    }
+
+    // Give a render target a w*h DIB section compatible with ref (NULL = the screen), filled with its bgcolor
+    static bool _cgame_rt_alloc(CGameContext* rt, HDC ref, int w, int h) {
+        rt->memdc = CreateCompatibleDC(ref);
+        if (!rt->memdc) return false;
+
+        // --- Create 32-bit BGRA DIBSection (alpha-capable backbuffer)
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = w;
+        bmi.bmiHeader.biHeight = -h;  // top-down
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        void* bits = NULL;
+        rt->membmp = CreateDIBSection(ref, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+        if (!rt->membmp) {
+            DeleteDC(rt->memdc);
+            rt->memdc = NULL;
+            return false;
+        }
+
+        rt->oldbmp = SelectObject(rt->memdc, rt->membmp);
+        rt->membits = (unsigned char*)bits;
+        rt->memw = w;
+        rt->memh = h;
+
+        // Fill transparent
+        HBRUSH brush = CreateSolidBrush(RGB(GetRValue(rt->bgcolor),
+                                            GetGValue(rt->bgcolor),
+                                            GetBValue(rt->bgcolor)));
+        RECT rc = { 0, 0, w, h };
+        FillRect(rt->memdc, &rc, brush);
+        DeleteObject(brush);
+        return true;
+    }
+
+    static void _cgame_rt_release(CGameContext* rt) {
+        if (rt->memdc) {
+            if (rt->oldbmp) {
+                SelectObject(rt->memdc, rt->oldbmp);
+                rt->oldbmp = NULL;
+            }
+            if (rt->membmp) {
+                DeleteObject(rt->membmp);
+                rt->membmp = NULL;
+            }
+            rt->membits = NULL;
+            rt->memw = rt->memh = 0;
+            DeleteDC(rt->memdc);
+            rt->memdc = NULL;
+        }
+    }
+
+    static void _cgame_make_backbuffer(int w, int h) {
+        if (!_cgame_screen.hwnd && !_cgame_screen.headless) return;
+        HDC wnddc = _cgame_screen.hwnd ? GetDC(_cgame_screen.hwnd) : NULL; // headless: screen-compatible
+        if (_cgame_screen.hwnd && !wnddc) return;
+        _cgame_rt_alloc(&_cgame_screen_rt, wnddc, w, h);
+        if (wnddc) ReleaseDC(_cgame_screen.hwnd, wnddc);
+    }
+
+    static void _cgame_free_backbuffer(void) {
+        _cgame_rt_release(&_cgame_screen_rt);
+    }
+
+    // =========================
+    // Overdraw heatmap (cgame.debug.overdraw)
+    //  - Each draw call is replayed in white into a black mask DIB the
+    //    size of the backbuffer; every non-black mask pixel in the call's
+    //    bounds then bumps a per-pixel layer counter and the call's
+    //    CGAME_PRIM_* total, and is cleared again. Coverage is exact for
+    //    shapes and text; clears and image blits count their whole
+    //    destination rect.
+    //  - The replay binds the mask as the drawing thread's own context, so
+    //    the screen context (and a WM_PAINT blitting it) never sees it.
+    //  - display.flip replaces the frame with the colour-mapped counters
+    //    (black 0, blue 1, green 2, yellow 3, orange 4, red 5, magenta 6,
+    //    white 7+), then resets them.
+    // =========================
+
+    static bool               _cgame_overdraw_on = false;
+    static unsigned char*     _cgame_overdraw_layers = NULL;   // per pixel, saturating
+    static HDC                _cgame_overdraw_dc = NULL;
+    static HBITMAP            _cgame_overdraw_bmp = NULL;
+    static HGDIOBJ            _cgame_overdraw_oldbmp = NULL;
+    static unsigned char*     _cgame_overdraw_bits = NULL;
+    static int                _cgame_overdraw_w = 0, _cgame_overdraw_h = 0;
+    static CGameOverdrawStats _cgame_overdraw_live = { { 0 } };
+    static CGameOverdrawStats _cgame_overdraw_last = { { 0 } };
+    static CGameContext       _cgame_overdraw_rt = { NULL, NULL, NULL, NULL, 0, 0, RGB(0,0,0), NULL, NULL, 0 }; // the mask, bound during a replay
+
+    static void _cgame_overdraw_free(void) {
+        if (_cgame_overdraw_dc) {
+            if (_cgame_overdraw_oldbmp) SelectObject(_cgame_overdraw_dc, _cgame_overdraw_oldbmp);
+            DeleteDC(_cgame_overdraw_dc);
+        }
+        if (_cgame_overdraw_bmp) DeleteObject(_cgame_overdraw_bmp);
+        free(_cgame_overdraw_layers);
+        _cgame_overdraw_dc = NULL;
+        _cgame_overdraw_bmp = NULL;
+        _cgame_overdraw_oldbmp = NULL;
+        _cgame_overdraw_bits = NULL;
+        _cgame_overdraw_layers = NULL;
+        _cgame_overdraw_w = _cgame_overdraw_h = 0;
+    }
+
+    // Mask and counters matching the backbuffer; false when they can't be made
+    static bool _cgame_overdraw_ensure(void) {
+        if (_cgame_overdraw_bits && _cgame_overdraw_w == _cgame_screen_rt.memw && _cgame_overdraw_h == _cgame_screen_rt.memh) return true;
+        _cgame_overdraw_free();
+        if (!_cgame_screen_rt.memdc || !_cgame_screen_rt.membits) return false;
+
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = _cgame_screen_rt.memw;
+        bmi.bmiHeader.biHeight = -_cgame_screen_rt.memh;  // top-down, like the backbuffer
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        void* bits = NULL;
+        _cgame_overdraw_dc = CreateCompatibleDC(_cgame_screen_rt.memdc);
+        _cgame_overdraw_bmp = _cgame_overdraw_dc ? CreateDIBSection(_cgame_screen_rt.memdc, &bmi, DIB_RGB_COLORS, &bits, NULL, 0) : NULL;
+        _cgame_overdraw_layers = (unsigned char*)_cgame_calloc((size_t)_cgame_screen_rt.memw * _cgame_screen_rt.memh, 1);
+        if (!_cgame_overdraw_bmp || !bits || !_cgame_overdraw_layers) {
+            _cgame_overdraw_free();
+            return false;
+        }
+        _cgame_overdraw_oldbmp = SelectObject(_cgame_overdraw_dc, _cgame_overdraw_bmp);
+        _cgame_overdraw_bits = (unsigned char*)bits;  // DIB sections start zeroed
+        _cgame_overdraw_w = _cgame_screen_rt.memw;
+        _cgame_overdraw_h = _cgame_screen_rt.memh;
+        return true;
+    }
+
+    // Count a fully written rect
+    static void _cgame_overdraw_rect(int prim, int x, int y, int w, int h) {
+        if (_cgame_rt != &_cgame_screen_rt || !_cgame_overdraw_on || !_cgame_overdraw_ensure()) return;
+        int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+        int x1 = x + w > _cgame_screen_rt.memw ? _cgame_screen_rt.memw : x + w;
+        int y1 = y + h > _cgame_screen_rt.memh ? _cgame_screen_rt.memh : y + h;
+        if (x1 <= x0 || y1 <= y0) return;
+        for (int py = y0; py < y1; ++py) {
+            unsigned char* layer = _cgame_overdraw_layers + (size_t)py * _cgame_screen_rt.memw;
+            for (int px = x0; px < x1; ++px) if (layer[px] < 255) layer[px]++;
+        }
+        _cgame_overdraw_live.pixels[prim] += (long long)(x1 - x0) * (y1 - y0);
+    }
+
+    // Start replaying a draw call into the mask: true means the caller draws again
+    // (in white) and then calls _cgame_overdraw_end. Only this thread's _cgame_rt
+    // moves; stats and a nested replay skip themselves since it isn't the screen.
+    static bool _cgame_overdraw_begin(void) {
+        if (_cgame_rt != &_cgame_screen_rt || !_cgame_overdraw_on || !_cgame_overdraw_ensure()) return false;
+        GdiFlush();
+        _cgame_overdraw_rt.memdc   = _cgame_overdraw_dc;
+        _cgame_overdraw_rt.membits = _cgame_overdraw_bits;
+        _cgame_overdraw_rt.memw    = _cgame_overdraw_w;
+        _cgame_overdraw_rt.memh    = _cgame_overdraw_h;
+        _cgame_overdraw_rt.fonts   = _cgame_screen_rt.fonts;     // replayed text reuses the screen's atlases
+        _cgame_overdraw_rt.layouts = _cgame_screen_rt.layouts;
+        _cgame_rt = &_cgame_overdraw_rt;
+        return true;
+    }
+
+    // Count and clear the mask pixels the replay touched within (x, y, w, h)
+    static void _cgame_overdraw_end(int prim, int x, int y, int w, int h) {
+        GdiFlush();
+        _cgame_rt = &_cgame_screen_rt;
+        _cgame_screen_rt.fonts   = _cgame_overdraw_rt.fonts;     // in case the replay made them
+        _cgame_screen_rt.layouts = _cgame_overdraw_rt.layouts;
+
+        int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+        int x1 = x + w > _cgame_screen_rt.memw ? _cgame_screen_rt.memw : x + w;
+        int y1 = y + h > _cgame_screen_rt.memh ? _cgame_screen_rt.memh : y + h;
+        long long written = 0;
+        for (int py = y0; py < y1; ++py) {
+            unsigned int*  mask  = (unsigned int*)(_cgame_overdraw_bits + (size_t)py * _cgame_screen_rt.memw * 4);
+            unsigned char* layer = _cgame_overdraw_layers + (size_t)py * _cgame_screen_rt.memw;
+            for (int px = x0; px < x1; ++px) {
+                if (!(mask[px] & 0xFFFFFFu)) continue;
+                mask[px] = 0;
+                if (layer[px] < 255) layer[px]++;
+                written++;
+            }
+        }
+        _cgame_overdraw_live.pixels[prim] += written;
+    }
+
+    // display.flip: show the counters in place of the frame, close the frame's totals
+    static void _cgame_overdraw_present(void) {
+        static const unsigned int palette[8] = {
+            0x000000u, 0x2040C0u, 0x20B040u, 0xE0E020u, 0xF09020u, 0xE02020u, 0xE020E0u, 0xFFFFFFu
+        };
+        CGameOverdrawStats* s = &_cgame_overdraw_live;
+        if (_cgame_overdraw_ensure()) {
+            GdiFlush();
+            size_t n = (size_t)_cgame_screen_rt.memw * _cgame_screen_rt.memh;
+            unsigned int* out = (unsigned int*)_cgame_screen_rt.membits;
+            for (size_t i = 0; i < n; ++i) {
+                unsigned char c = _cgame_overdraw_layers[i];
+                out[i] = palette[c < 7 ? c : 7];
+                if (c) s->covered++;
+                if (c > s->max_layers) s->max_layers = c;
+            }
+            memset(_cgame_overdraw_layers, 0, n);
+        }
+        s->total = 0;
+        for (int i = 0; i < CGAME_PRIM_COUNT; ++i) s->total += s->pixels[i];
+        s->average_layers = s->covered ? (double)s->total / s->covered : 0.0;
+        _cgame_overdraw_last = *s;
+        memset(s, 0, sizeof(*s));
+    }
+
+    // =========================
+    // OpenGL helpers
+    // =========================
+    static bool _cgame_init_opengl(HWND hwnd, HDC* hdc, HGLRC* hglrc) {
+        PIXELFORMATDESCRIPTOR pfd = {
+            sizeof(PIXELFORMATDESCRIPTOR),
+            1,
+            PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER,
+            PFD_TYPE_RGBA,
+            32, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            24, 8, 0,
+            PFD_MAIN_PLANE,
+            0, 0, 0, 0
+        };
+
+        *hdc = GetDC(hwnd);
+        if (!*hdc) return false;
+
+        int pixelFormat = ChoosePixelFormat(*hdc, &pfd);
+        if (!pixelFormat) {
+            ReleaseDC(hwnd, *hdc);
+            return false;
+        }
+
+        if (!SetPixelFormat(*hdc, pixelFormat, &pfd)) {
+            ReleaseDC(hwnd, *hdc);
+            return false;
+        }
+
+        *hglrc = wglCreateContext(*hdc);
+        if (!*hglrc) {
+            ReleaseDC(hwnd, *hdc);
+            return false;
+        }
+
+        if (!wglMakeCurrent(*hdc, *hglrc)) {
+            wglDeleteContext(*hglrc);
+            ReleaseDC(hwnd, *hdc);
+            return false;
+        }
+
+        return true;
+    }
+    
+
+    static void _cgame_cleanup_opengl(HDC hdc, HGLRC hglrc) {
+        if (hglrc) {
+            wglMakeCurrent(NULL, NULL);
+            wglDeleteContext(hglrc);
+        }
+        if (hdc) {
+            ReleaseDC(_cgame_screen.hwnd, hdc);
+        }
+    }
+
+    // =========================
+    // Vulkan helpers (lightweight runtime detection)
+    //  - This does not implement a full Vulkan setup. It attempts to
+    //    load the Vulkan runtime (vulkan-1.dll) so the host has Vulkan
+    //    available. Full instance/device/swapchain creation is left to
+    //    the user or later extension code.
+    // =========================
+    static bool _cgame_init_vulkan(HWND hwnd, HMODULE* vk_lib_out) {
+        if (!vk_lib_out) return false;
+        *vk_lib_out = LoadLibraryA("vulkan-1.dll");
+        if (!*vk_lib_out) {
+            MessageBoxW(hwnd,
+                        L"Vulkan runtime (vulkan-1.dll) not found.\nInstall Vulkan runtime/SDK or remove CGAME_VULKAN flag.",
+                        L"CGame Vulkan Error",
+                        MB_OK | MB_ICONERROR);
+            return false;
+        }
+        /* We don't create a Vulkan instance here — this is a safe runtime detection
+           scaffold so user code (or a later extension) can link Vulkan functions
+           and create instance/device/swapchain as desired. */
+        return true;
+    }
+
+    static void _cgame_cleanup_vulkan(HMODULE vk_lib) {
+        if (vk_lib) {
+            FreeLibrary(vk_lib);
+        }
+    }
+
+    static bool _cgame_init_d3d12(HWND hwnd, HMODULE* d3d12_lib_out) {
+        *d3d12_lib_out = LoadLibraryA("d3d12.dll");
+        if (!*d3d12_lib_out) {
+            MessageBoxW(hwnd,
+                L"Direct3D 12 runtime (d3d12.dll) not found.\nInstall latest DirectX runtime or remove CGAME_D3D12 flag.",
+                L"CGame D3D12 Error",
+                MB_OK | MB_ICONERROR);
+            return false;
+        }
+
+        /* Full D3D12 setup (device, swapchain, command queue) left to user.
+        We only load the runtime dynamically and provide placeholders. */
+        return true;
+    }
+
+    static void _cgame_cleanup_d3d12(HMODULE d3d12_lib) {
+        if (d3d12_lib) FreeLibrary(d3d12_lib);
+    }
+
+    // =========================
+    // Frame arena (cgame.arena)
+    //  - One bump allocator per thread, rewound only at points its own
+    //    thread controls: display.flip rewinds the flipping thread's,
+    //    workers rewind theirs between jobs, and any other thread calls
+    //    arena.reset. No thread ever touches another's memory.
+    //  - So an allocation lasts until the next flip on the thread that
+    //    flips, until the job returns on a worker, and until the next
+    //    arena.reset elsewhere.
+    //  - Library paths bracket their scratch with a mark and release it
+    //    before returning: buffers are reused call after call and, once
+    //    the arena has grown to the frame's peak, never reach the heap.
+    //  - A rewind waits while a mark is open. Once per frame it also
+    //    folds the block chain into one block sized to the last frame's
+    //    peak, so a one-off spike goes back to the heap on the next frame.
+    // =========================
+    #define CGAME_ARENA_BLOCK (64 * 1024)
+    #define CGAME_ARENA_SLACK (sizeof(CGameArenaBlock) + 15)   // header plus alignment, per block
+
+    typedef struct CGameArenaBlock {
+        struct CGameArenaBlock* next;
+        unsigned char*          base;       // first 16-byte aligned byte after the header
+        size_t                  size;       // usable bytes from base
+    } CGameArenaBlock;
+
+    typedef struct {
+        CGameArenaBlock* first;
+        CGameArenaBlock* cur;               // NULL: nothing handed out since the rewind
+        size_t           used;              // bytes of cur in use
+        size_t           total, peak;       // this frame, across blocks
+        size_t           reserve;           // last frame's peak
+        int              depth;             // open marks
+        LONG             epoch;             // frame of the last fold (workers)
+    } CGameArena;
+
+    typedef struct {
+        CGameArenaBlock* cur;
+        size_t           used, total;
+    } CGameArenaMark;
+
+    static void _cgame_arena_free_chain(CGameArenaBlock* b) {
+        while (b) {
+            CGameArenaBlock* next = b->next;
+            free(b);
+            b = next;
+        }
+    }
+
+    // The blocks go back to the heap when their thread ends, whoever started it
+    struct CGameArenaSlot {
+        CGameArena a;
+        ~CGameArenaSlot() { _cgame_arena_free_chain(a.first); }
+    };
+
+    static volatile LONG               _cgame_arena_epoch = 0;   // flips so far; workers fold once per change
+    static thread_local CGameArenaSlot _cgame_arena = { { NULL, NULL, 0, 0, 0, 0, 0, 0 } };
+
+    // Hand everything back; fold also trims the blocks to the peak since the last fold
+    static void _cgame_arena_rewind(CGameArena* a, bool fold) {
+        a->cur   = NULL;
+        a->used  = 0;
+        a->total = 0;
+        if (!fold) return;
+        size_t want = a->peak > CGAME_ARENA_BLOCK ? a->peak : CGAME_ARENA_BLOCK;
+        if (a->first && (a->first->next || a->first->size > 2 * want)) {
+            _cgame_arena_free_chain(a->first);
+            a->first = NULL;
+        }
+        a->reserve = want;
+        a->peak    = 0;
+    }
+
+    // 16-byte aligned; valid until this thread's arena rewinds (or the enclosing mark's release)
+    static void* _cgame_arena_alloc(size_t size) {
+        CGameArena* a = &_cgame_arena.a;
+        const size_t room = (size_t)-1 - CGAME_ARENA_SLACK;   // largest block malloc can be asked for
+        if (size > room - 15) return NULL;
+        size = (size + 15) & ~(size_t)15;
+        if (!size) size = 16;
+
+        if (!a->cur || size > a->cur->size - a->used) {
+            CGameArenaBlock** link = a->cur ? &a->cur->next : &a->first;
+            CGameArenaBlock*  b = *link;
+            if (!b || b->size < size) {
+                // spares too small for this request: replace them with one that fits
+                _cgame_arena_free_chain(b);
+                *link = NULL;
+                size_t cap = !a->cur ? a->reserve : (a->cur->size <= room / 2 ? a->cur->size * 2 : room);
+                if (cap < CGAME_ARENA_BLOCK) cap = CGAME_ARENA_BLOCK;
+                if (cap < size) cap = size;
+                b = (CGameArenaBlock*)_cgame_malloc(CGAME_ARENA_SLACK + cap);
+                if (!b) return NULL;
+                b->next = NULL;
+                b->base = (unsigned char*)(((uintptr_t)(b + 1) + 15) & ~(uintptr_t)15);
+                b->size = cap;
+                *link = b;
+            }
+            a->cur  = b;
+            a->used = 0;
+        }
+
+        void* p = a->cur->base + a->used;
+        a->used  += size;
+        a->total += size;
+        if (a->total > a->peak) a->peak = a->total;
+        return p;
+    }
+
+    static CGameArenaMark _cgame_arena_mark(void) {
+        CGameArena* a = &_cgame_arena.a;
+        a->depth++;
+        CGameArenaMark m = { a->cur, a->used, a->total };
+        return m;
+    }
+
+    static void _cgame_arena_release(const CGameArenaMark* m) {
+        CGameArena* a = &_cgame_arena.a;
+        a->cur   = m->cur;
+        a->used  = m->used;
+        a->total = m->total;
+        a->depth--;
+    }
+
+    // The calling thread's blocks, on quit and when a worker exits
+    static void _cgame_arena_free(void) {
+        CGameArena* a = &_cgame_arena.a;
+        _cgame_arena_free_chain(a->first);
+        memset(a, 0, sizeof(*a));
+    }
+
+    static size_t _cgame_arena_used_impl(void) { return _cgame_arena.a.total; }
+
+    // Rewind the calling thread's arena now: display.flip does it for the flipping
+    // thread; context threads and loops that never flip call it themselves
+    static void _cgame_arena_reset_impl(void) {
+        CGameArena* a = &_cgame_arena.a;
+        if (a->depth) return;
+        _cgame_arena_rewind(a, true);
+    }
+
+    // On a worker once a job has returned; folds at most once per frame
+    static void _cgame_arena_job_done(void) {
+        CGameArena* a = &_cgame_arena.a;
+        if (a->depth || (!a->cur && a->epoch == _cgame_arena_epoch)) return;
+        LONG e = _cgame_arena_epoch;
+        _cgame_arena_rewind(a, a->epoch != e);
+        a->epoch = e;
+    }
+
+    // UTF-8 → wide in the frame arena; NULL on bad input
+    static wchar_t* _cgame_utf8_to_wide_arena(const char* s) {
+        if (!s) return NULL;
+        int len = MultiByteToWideChar(CP_UTF8, 0, s, -1, NULL, 0);
+        if (len <= 0) return NULL;
+        wchar_t* w = (wchar_t*)_cgame_arena_alloc((size_t)len * sizeof(wchar_t));
+        if (w) MultiByteToWideChar(CP_UTF8, 0, s, -1, w, len);
+        return w;
+    }
+
+    // =========================
+    // Job system (cgame.jobs)
+    //  - One queue per worker plus queue 0 for every other thread. Owners
+    //    push and pop at the tail (LIFO, cache-warm); idle threads steal
+    //    from the head of the injection queue, then of a random victim.
+    //  - Workers (logical cores - 1, or set_worker_count before first
+    //    use, at most CGAME_JOBS_MAX) start on first use and sleep on a
+    //    semaphore when every queue is empty. jobs.wait runs other jobs
+    //    instead of blocking, so nested waits never add threads or
+    //    deadlock.
+    //  - parallel_for splits [0, count) into fixed chunks of `grain`
+    //    claimed from a shared counter: chunking never depends on the
+    //    worker count, so per-item results are identical on any machine.
+    //    Its caller only ever works on its own range: once the chunks are
+    //    gone it cancels helpers still queued and waits for the running
+    //    ones, never picking up unrelated jobs. Library code can hold an
+    //    arena mark across it.
+    //  - A full queue, or no workers, runs the job inline.
+    // =========================
+    #define CGAME_JOBS_MAX    64      // WaitForMultipleObjects limit
+    #define CGAME_JOBS_QUEUE  512     // slots per queue, power of two
+    #define CGAME_JOBS_ROWS   16      // default grain for row kernels
+
+    typedef struct {
+        CGameJobFn      fn;
+        void*           user;
+        CGameWaitGroup* wg;
+    } CGameJob;
+
+    typedef struct {
+        volatile LONG lock;
+        volatile LONG head, tail;       // thieves take head, the owner works at tail
+        CGameJob      slots[CGAME_JOBS_QUEUE];
+    } CGameJobQueue;
+
+    static HANDLE          _cgame_jobs_threads[CGAME_JOBS_MAX];
+    static CGameJobQueue*  _cgame_jobs_q = NULL;            // [0] injection, [1..count] workers
+    static volatile LONG   _cgame_jobs_count = 0;
+    static volatile LONG   _cgame_jobs_state = 0;           // 0 stopped, 1 starting or resizing, 2 running
+    static volatile LONG   _cgame_jobs_sleepers = 0;
+    static volatile bool   _cgame_jobs_quit = false;
+    static HANDLE          _cgame_jobs_sem = NULL;
+    static int             _cgame_jobs_wanted = 0;          // <= 0: logical cores - 1
+    static thread_local int      _cgame_jobs_self = 0;      // own queue; 0 off the workers
+    static thread_local uint32_t _cgame_jobs_rng = 0;
+
+    static void _cgame_jobs_lock(CGameJobQueue* q) {
+        while (InterlockedCompareExchange(&q->lock, 1, 0) != 0) YieldProcessor();
+    }
+
+    static void _cgame_jobs_unlock(CGameJobQueue* q) {
+        InterlockedExchange(&q->lock, 0);
+    }
+
+    static bool _cgame_jobs_push(CGameJobQueue* q, const CGameJob* job) {
+        _cgame_jobs_lock(q);
+        bool ok = q->tail - q->head < CGAME_JOBS_QUEUE;
+        if (ok) {
+            q->slots[q->tail & (CGAME_JOBS_QUEUE - 1)] = *job;
+            q->tail = q->tail + 1;
+        }
+        _cgame_jobs_unlock(q);
+        return ok;
+    }
+
+    static bool _cgame_jobs_take(CGameJobQueue* q, CGameJob* out, bool lifo) {
+        if (q->head == q->tail) return false;
+        _cgame_jobs_lock(q);
+        bool ok = q->head != q->tail;
+        if (ok) {
+            if (lifo) {
+                q->tail = q->tail - 1;
+                *out = q->slots[q->tail & (CGAME_JOBS_QUEUE - 1)];
+            } else {
+                *out = q->slots[q->head & (CGAME_JOBS_QUEUE - 1)];
+                q->head = q->head + 1;
+            }
+        }
+        _cgame_jobs_unlock(q);
+        return ok;
+    }
+
+    static bool _cgame_jobs_find(CGameJob* out) {
+        if (!_cgame_jobs_q) return false;
+        int self = _cgame_jobs_self;
+        if (self > 0 && _cgame_jobs_take(&_cgame_jobs_q[self], out, true)) return true;
+        if (_cgame_jobs_take(&_cgame_jobs_q[0], out, false)) return true;
+
+        int n = (int)_cgame_jobs_count;
+        if (n <= 0) return false;
+        uint32_t r = _cgame_jobs_rng ? _cgame_jobs_rng : (uint32_t)GetCurrentThreadId() | 1u;
+        r ^= r << 13; r ^= r >> 17; r ^= r << 5;
+        _cgame_jobs_rng = r;
+        for (int i = 0; i < n; ++i) {
+            int v = 1 + (int)((r + (uint32_t)i) % (uint32_t)n);
+            if (v != self && _cgame_jobs_take(&_cgame_jobs_q[v], out, false)) return true;
+        }
+        return false;
+    }
+
+    static bool _cgame_jobs_any(void) {
+        for (int i = 0; i <= (int)_cgame_jobs_count; ++i)
+            if (_cgame_jobs_q[i].head != _cgame_jobs_q[i].tail) return true;
+        return false;
+    }
+
+    static void _cgame_jobs_exec(const CGameJob* job) {
+        job->fn(job->user);
+        if (job->wg) InterlockedDecrement(&job->wg->pending);
+    }
+
+    // Claim one sleeper; false when none is left to claim
+    static bool _cgame_jobs_claim_sleeper(void) {
+        for (;;) {
+            LONG s = _cgame_jobs_sleepers;
+            if (s <= 0) return false;
+            if (InterlockedCompareExchange(&_cgame_jobs_sleepers, s - 1, s) == s) return true;
+        }
+    }
+
+    static DWORD WINAPI _cgame_jobs_thread_proc(LPVOID param) {
+        _cgame_jobs_self = (int)(intptr_t)param;
+        for (;;) {
+            CGameJob job;
+            if (_cgame_jobs_find(&job)) {
+                _cgame_jobs_exec(&job);
+                _cgame_arena_job_done();
+                continue;
+            }
+            if (_cgame_jobs_quit) break;
+
+            // Announce, re-check, then sleep; a pusher that claimed us has released the semaphore
+            InterlockedIncrement(&_cgame_jobs_sleepers);
+            if ((_cgame_jobs_any() || _cgame_jobs_quit) && _cgame_jobs_claim_sleeper()) continue;
+            WaitForSingleObject(_cgame_jobs_sem, INFINITE);
+        }
+        _cgame_arena_free();
+        return 0;
+    }
+
+    static void _cgame_jobs_wake(int n) {
+        while (n-- > 0 && _cgame_jobs_claim_sleeper()) ReleaseSemaphore(_cgame_jobs_sem, 1, NULL);
+    }
+
+    // Start the workers once; false on a single core or when threads can't be made
+    static bool _cgame_jobs_start(void) {
+        for (;;) {
+            LONG state = InterlockedCompareExchange(&_cgame_jobs_state, 1, 0);
+            if (state == 0) break;
+            if (state == 2) return _cgame_jobs_count > 0;
+            SwitchToThread(); // another thread is starting the pool or setting its size
+        }
+
+        int n = _cgame_jobs_wanted;
+        if (n <= 0) {
+            SYSTEM_INFO si;
+            GetSystemInfo(&si);
+            n = (int)si.dwNumberOfProcessors - 1;
+        }
+        if (n > CGAME_JOBS_MAX) n = CGAME_JOBS_MAX;
+
+        _cgame_jobs_quit = false;
+        _cgame_jobs_sleepers = 0;
+        if (n > 0) {
+            _cgame_jobs_q   = (CGameJobQueue*)_cgame_calloc((size_t)n + 1, sizeof(CGameJobQueue));
+            _cgame_jobs_sem = _cgame_jobs_q ? CreateSemaphoreW(NULL, 0, 0x7FFFFFFF, NULL) : NULL;
+        }
+        if (_cgame_jobs_sem) {
+            for (int i = 0; i < n; ++i) {
+                HANDLE t = CreateThread(NULL, 0, _cgame_jobs_thread_proc, (LPVOID)(intptr_t)(i + 1), 0, NULL);
+                if (!t) break;
+                _cgame_jobs_threads[i] = t;
+                InterlockedIncrement(&_cgame_jobs_count);
+            }
+        }
+        InterlockedExchange(&_cgame_jobs_state, 2);
+        return _cgame_jobs_count > 0;
+    }
+
+    // Drain the queues and join the workers; the next job starts them again
+    static void _cgame_jobs_stop(void) {
+        if (_cgame_jobs_state != 2) return;
+        int n = (int)_cgame_jobs_count;
+        if (n) {
+            _cgame_jobs_quit = true;
+            ReleaseSemaphore(_cgame_jobs_sem, n, NULL);
+            WaitForMultipleObjects((DWORD)n, _cgame_jobs_threads, TRUE, INFINITE);
+            for (int i = 0; i < n; ++i) CloseHandle(_cgame_jobs_threads[i]);
+        }
+        if (_cgame_jobs_sem) CloseHandle(_cgame_jobs_sem);
+        free(_cgame_jobs_q);
+        _cgame_jobs_sem   = NULL;
+        _cgame_jobs_q     = NULL;
+        _cgame_jobs_count = 0;
+        _cgame_jobs_quit  = false;
+        InterlockedExchange(&_cgame_jobs_state, 0);
+    }
+
+    static void _cgame_jobs_run_impl(CGameJobFn fn, void* user, CGameWaitGroup* wg) {
+        if (!fn) return;
+        CGameJob job = { fn, user, wg };
+        if (wg) InterlockedIncrement(&wg->pending);
+        if (!_cgame_jobs_start() || !_cgame_jobs_push(&_cgame_jobs_q[_cgame_jobs_self], &job)) {
+            _cgame_jobs_exec(&job);
+            return;
+        }
+        _cgame_jobs_wake(1);
+    }
+
+    static void _cgame_jobs_nop(void* user) { (void)user; }
+
+    // Turn q's still-queued jobs for `user` into no-ops; returns how many
+    static int _cgame_jobs_cancel(CGameJobQueue* q, void* user) {
+        int n = 0;
+        _cgame_jobs_lock(q);
+        for (LONG i = q->head; i != q->tail; ++i) {
+            CGameJob* job = &q->slots[i & (CGAME_JOBS_QUEUE - 1)];
+            if (job->user != user || job->fn == _cgame_jobs_nop) continue;
+            job->fn = _cgame_jobs_nop;
+            job->wg = NULL;
+            ++n;
+        }
+        _cgame_jobs_unlock(q);
+        return n;
+    }
+
+    static void _cgame_jobs_wait_impl(CGameWaitGroup* wg) {
+        if (!wg) return;
+        int idle = 0;
+        while (wg->pending > 0) {
+            CGameJob job;
+            if (_cgame_jobs_find(&job)) {
+                _cgame_jobs_exec(&job);
+                idle = 0;
+            } else if (++idle < 64) {
+                YieldProcessor();
+            } else {
+                SwitchToThread();
+            }
+        }
+    }
+
+    typedef struct {
+        CGameRangeFn  fn;
+        void*         user;
+        int           count, grain, chunks;
+        volatile LONG next;
+    } CGameJobRange;
+
+    static void _cgame_jobs_range_work(void* param) {
+        CGameJobRange* r = (CGameJobRange*)param;
+        for (;;) {
+            LONG i = InterlockedIncrement(&r->next) - 1;
+            if (i >= r->chunks) break;
+            int begin = (int)i * r->grain;
+            int end = r->count - begin > r->grain ? begin + r->grain : r->count;
+            r->fn(r->user, begin, end);
+        }
+    }
+
+    // Blocks until every chunk has run; the caller takes chunks too but runs nothing else
+    static void _cgame_parallel_for(int count, int grain, CGameRangeFn fn, void* user) {
+        if (count <= 0 || !fn) return;
+        if (grain < 1) grain = 1;
+
+        CGameJobRange r;
+        r.fn     = fn;
+        r.user   = user;
+        r.count  = count;
+        r.grain  = grain;
+        r.chunks = (int)(((int64_t)count + grain - 1) / grain);
+        r.next   = 0;
+
+        CGameWaitGroup wg = { 0 };
+        if (r.chunks > 1 && _cgame_jobs_start()) {
+            int helpers = r.chunks - 1 < (int)_cgame_jobs_count ? r.chunks - 1 : (int)_cgame_jobs_count;
+            for (int i = 0; i < helpers; ++i) _cgame_jobs_run_impl(_cgame_jobs_range_work, &r, &wg);
+        }
+        _cgame_jobs_range_work(&r);
+        if (wg.pending <= 0) return;
+
+        // Every chunk is claimed: drop helpers nobody has started, then wait out the running ones
+        int queued = _cgame_jobs_cancel(&_cgame_jobs_q[_cgame_jobs_self], &r);
+        if (queued) InterlockedExchangeAdd(&wg.pending, -queued);
+        int idle = 0;
+        while (wg.pending > 0) {
+            if (++idle < 64) YieldProcessor();
+            else             SwitchToThread();
+        }
+    }
+
+    static int _cgame_jobs_worker_count_impl(void) {
+        return _cgame_jobs_start() ? (int)_cgame_jobs_count : 0;
+    }
+
+    // Only before the pool starts (first job, parallel_for or worker_count; again after quit).
+    // Stopping a running pool would free queues other threads may be pushing to or stealing from.
+    static bool _cgame_jobs_set_worker_count_impl(int count) {
+        if (InterlockedCompareExchange(&_cgame_jobs_state, 1, 0) != 0) return false;
+        _cgame_jobs_wanted = count;
+        InterlockedExchange(&_cgame_jobs_state, 0);
+        return true;
+    }
+
+    static int _cgame_jobs_thread_index_impl(void) { return _cgame_jobs_self; }
+
+    // =========================================================
+    // Image subsystem
+    // =========================================================
+
+
+    // Helpers: free pixel + HBITMAP
+
+    // =========================
+// SAFETY CHECK HELPERS
+// =========================
+    static inline bool _cgame_safe_to_draw() {
+        return (_cgame_rt->memdc && (_cgame_rt != &_cgame_screen_rt || _cgame_screen.headless || (_cgame_screen.hwnd && IsWindow(_cgame_screen.hwnd))));
+    }
+
+    static bool _cgame_image_from_gdiplus_bitmap(Gdiplus::Bitmap* bmp, CGameImage* out)
+    {
+        if (!bmp || !out) return false;
+
+        UINT w = bmp->GetWidth();
+        UINT h = bmp->GetHeight();
+        out->width = (int)w;
+        out->height = (int)h;
+        out->channels = 4;
+        out->gdi_bitmap = NULL;
+        out->pixels = NULL;
+
+        // Allocate pixel buffer (RGBA)
+        size_t total = (size_t)w * (size_t)h * 4;
+        out->pixels = (unsigned char*)_cgame_malloc(total);
+        if (!out->pixels) return false;
+
+        // Lock the GDI+ bitmap and read pixels
+        Gdiplus::Rect rect(0, 0, w, h);
+        Gdiplus::BitmapData bd;
+        if (bmp->LockBits(&rect, Gdiplus::ImageLockModeRead, PixelFormat32bppPARGB, &bd) != Gdiplus::Ok)
+        {
+            free(out->pixels);
+            out->pixels = NULL;
+            return false;
+        }
+
+        for (UINT y = 0; y < h; ++y)
+        {
+            unsigned char* dstRow = out->pixels + (size_t)y * w * 4;
+            unsigned char* srcRow = (unsigned char*)bd.Scan0 + (size_t)y * bd.Stride;
+
+            for (UINT x = 0; x < w; ++x)
+            {
+                unsigned char b = srcRow[x*4 + 0];
+                unsigned char g = srcRow[x*4 + 1];
+                unsigned char r = srcRow[x*4 + 2];
+                unsigned char a = srcRow[x*4 + 3];
+
+                dstRow[x*4 + 0] = r;
+                dstRow[x*4 + 1] = g;
+                dstRow[x*4 + 2] = b;
+                dstRow[x*4 + 3] = a;
+            }
+        }
+
+        bmp->UnlockBits(&bd);
+
+        // Clone the bitmap for GDI+ use
+        out->gdi_bitmap = bmp->Clone(0, 0, w, h, PixelFormat32bppPARGB);
+        return (out->gdi_bitmap != NULL);
+    }
+
+
+    static void _cgame_image_free_impl(CGameImage* img) {
+        if (!img) return;
+        if (img->gdi_bitmap) { delete img->gdi_bitmap; img->gdi_bitmap = NULL; }
+        if (img->pixels) { free(img->pixels); img->pixels = NULL; }
+        img->width = img->height = img->channels = 0;
+    }
+
+
+    // Load image from file path using GDI+static 
+    CGameImage _cgame_image_load_impl(const char* path) {
+        CGameImage img = {0,0,0,NULL,NULL};
+        if (!path) return img;
+
+        // Ensure GDI+ started
+        if (!_cgame_gdiplus_inited) {
+            Gdiplus::GdiplusStartupInput input;
+            Gdiplus::GdiplusStartup(&_cgame_gdiplusToken, &input, NULL);
+            _cgame_gdiplus_inited = true;
+        }
+
+        // Convert UTF-8 → wide (C-compatible)
+        int len = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
+        if (len <= 0) return img;
+
+        wchar_t* wpath = (wchar_t*)_cgame_malloc(len * sizeof(wchar_t));
+        if (!wpath) return img;
+
+        MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, len);
+
+        // Load the bitmap
+        Gdiplus::Bitmap* bmp = Gdiplus::Bitmap::FromFile(wpath, FALSE);
+        free(wpath);
+
+        if (!bmp || bmp->GetLastStatus() != Gdiplus::Ok) {
+            if (bmp) delete bmp;
+            return img;
+        }
+
+        img.width  = bmp->GetWidth();
+        img.height = bmp->GetHeight();
+        img.channels = 4;
+        img.gdi_bitmap = bmp;
+
+        return img;
+    }
+
+    // Free image
+    static void _cgame_image_unload_impl(CGameImage* img) {
+        if (!img) return;
+        _cgame_image_free_impl(img);
+    }
+
+    // =========================
+    // CPU image kernels
+    //  - Sources are read as premultiplied BGRA through LockBits; results
+    //    are built in a w*h*4 buffer that is copied into the new bitmap and
+    //    then swizzled in place to become the image's RGBA `pixels`.
+    //  - Every kernel writes whole rows (or column strips) through
+    //    _cgame_parallel_for on the job system, and uses integer or
+    //    fixed-point math only.
+    // =========================
+    typedef struct {
+        const unsigned char* src;       // premultiplied BGRA
+        int                  src_stride, sw, sh;
+        unsigned char*       dst;       // dw*4 bytes per row
+        int                  dw, dh;
+        const int*           map;       // resize: source column per target column
+        int                  radius;    // box blur
+        int64_t              u0, v0, ux, vx, uy, vy;    // rotate: 16.16 source position
+        int                  m[20];     // colour matrix, 16.16
+        int                  inv[256];  // colour matrix: 255/a, 16.16
+    } CGameImageJob;
+
+    static bool _cgame_image_begin_read(const CGameImage* img, Gdiplus::BitmapData* bd) {
+        if (!img || !img->gdi_bitmap || img->width <= 0 || img->height <= 0) return false;
+        Gdiplus::Rect rect(0, 0, img->width, img->height);
+        return img->gdi_bitmap->LockBits(&rect, Gdiplus::ImageLockModeRead, PixelFormat32bppPARGB, bd) == Gdiplus::Ok;
+    }
+
+    static void _cgame_image_swizzle_rows(void* user, int y0, int y1) {
+        const CGameImageJob* j = (const CGameImageJob*)user;
+        for (int y = y0; y < y1; ++y) {
+            uint32_t* p = (uint32_t*)(j->dst + (size_t)y * j->dw * 4);
+            int x = 0;
+        #ifdef CGAME_FAST_SSE2
+            const __m128i ga = _mm_set1_epi32((int)0xFF00FF00);
+            const __m128i lo = _mm_set1_epi32(0xFF);
+            for (; x + 4 <= j->dw; x += 4) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(p + x));
+                __m128i r = _mm_and_si128(_mm_srli_epi32(v, 16), lo);
+                __m128i b = _mm_slli_epi32(_mm_and_si128(v, lo), 16);
+                _mm_storeu_si128((__m128i*)(p + x), _mm_or_si128(_mm_and_si128(v, ga), _mm_or_si128(r, b)));
+            }
+        #endif
+            for (; x < j->dw; ++x) {
+                uint32_t v = p[x];
+                p[x] = (v & 0xFF00FF00u) | ((v >> 16) & 0xFFu) | ((v & 0xFFu) << 16);
+            }
+        }
+    }
+
+    // Wrap a finished BGRA buffer as an image; takes ownership of `bgra`
+    static CGameImage _cgame_image_from_bgra(unsigned char* bgra, int w, int h) {
+        CGameImage out = {0, 0, 0, NULL, NULL};
+        if (!bgra) return out;
+
+        Gdiplus::Bitmap* bmp = new Gdiplus::Bitmap(w, h, PixelFormat32bppPARGB);
+        Gdiplus::Rect rect(0, 0, w, h);
+        Gdiplus::BitmapData bd;
+        bd.Width       = (UINT)w;
+        bd.Height      = (UINT)h;
+        bd.Stride      = w * 4;
+        bd.PixelFormat = PixelFormat32bppPARGB;
+        bd.Scan0       = bgra;
+        bd.Reserved    = 0;
+        if (bmp->GetLastStatus() != Gdiplus::Ok ||
+            bmp->LockBits(&rect, Gdiplus::ImageLockModeWrite | Gdiplus::ImageLockModeUserInputBuf,
+                          PixelFormat32bppPARGB, &bd) != Gdiplus::Ok) {
+            delete bmp;
+            free(bgra);
+            return out;
+        }
+        bmp->UnlockBits(&bd);   // copies the buffer into the bitmap
+
+        CGameImageJob job;
+        memset(&job, 0, sizeof(job));
+        job.dst = bgra;
+        job.dw  = w;
+        job.dh  = h;
+        _cgame_parallel_for(h, CGAME_JOBS_ROWS, _cgame_image_swizzle_rows, &job);
+
+        out.width      = w;
+        out.height     = h;
+        out.channels   = 4;
+        out.pixels     = bgra;
+        out.gdi_bitmap = bmp;
+        return out;
+    }
+
+    static void _cgame_image_resize_rows(void* user, int y0, int y1) {
+        const CGameImageJob* j = (const CGameImageJob*)user;
+        for (int y = y0; y < y1; ++y) {
+            int sy = (int)(((int64_t)(2 * y + 1) * j->sh) / (2 * (int64_t)j->dh));
+            const uint32_t* s = (const uint32_t*)(j->src + (size_t)sy * j->src_stride);
+            uint32_t* d = (uint32_t*)(j->dst + (size_t)y * j->dw * 4);
+            for (int x = 0; x < j->dw; ++x) d[x] = s[j->map[x]];
+        }
+    }
+
+    // Nearest-resize a locked source into dst (new_w * 4 bytes per row), sampling at pixel centres
+    static bool _cgame_image_resize_into(const CGameImage* src, const Gdiplus::BitmapData* bd,
+                                         unsigned char* dst, int new_w, int new_h) {
+        CGameArenaMark mark = _cgame_arena_mark();
+        int* map = (int*)_cgame_arena_alloc((size_t)new_w * sizeof(int));
+        if (map) {
+            CGameImageJob job;
+            memset(&job, 0, sizeof(job));
+            job.src = (const unsigned char*)bd->Scan0;
+            job.src_stride = bd->Stride;
+            job.sw = src->width;
+            job.sh = src->height;
+            job.dst = dst;
+            job.dw = new_w;
+            job.dh = new_h;
+            for (int x = 0; x < new_w; ++x)
+                map[x] = (int)(((int64_t)(2 * x + 1) * job.sw) / (2 * (int64_t)new_w));
+            job.map = map;
+            _cgame_parallel_for(new_h, CGAME_JOBS_ROWS, _cgame_image_resize_rows, &job);
+        }
+        _cgame_arena_release(&mark);
+        return map != NULL;
+    }
+
+    // Create nearest-neighbour resized copy
+    static CGameImage _cgame_image_resize_nearest(const CGameImage* src, int new_w, int new_h) {
+        CGameImage out = {0, 0, 0, NULL, NULL};
+        if (new_w <= 0 || new_h <= 0) return out;
+        Gdiplus::BitmapData bd;
+        if (!_cgame_image_begin_read(src, &bd)) return out;
+
+        unsigned char* dst = (unsigned char*)_cgame_malloc((size_t)new_w * new_h * 4);
+        if (dst && !_cgame_image_resize_into(src, &bd, dst, new_w, new_h)) {
+            free(dst);
+            dst = NULL;
+        }
+        src->gdi_bitmap->UnlockBits(&bd);
+        return _cgame_image_from_bgra(dst, new_w, new_h);
+    }
+
+    static void _cgame_image_flip_h_rows(void* user, int y0, int y1) {
+        const CGameImageJob* j = (const CGameImageJob*)user;
+        for (int y = y0; y < y1; ++y) {
+            const uint32_t* s = (const uint32_t*)(j->src + (size_t)y * j->src_stride);
+            uint32_t* d = (uint32_t*)(j->dst + (size_t)y * j->dw * 4);
+            int x = 0;
+        #ifdef CGAME_FAST_SSE2
+            for (; x + 4 <= j->dw; x += 4) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(s + j->dw - 4 - x));
+                _mm_storeu_si128((__m128i*)(d + x), _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)));
+            }
+        #endif
+            for (; x < j->dw; ++x) d[x] = s[j->dw - 1 - x];
+        }
+    }
+
+    static void _cgame_image_flip_v_rows(void* user, int y0, int y1) {
+        const CGameImageJob* j = (const CGameImageJob*)user;
+        for (int y = y0; y < y1; ++y)
+            memcpy(j->dst + (size_t)y * j->dw * 4, j->src + (size_t)(j->dh - 1 - y) * j->src_stride, (size_t)j->dw * 4);
+    }
+
+    // Run a same-size row kernel over src into a new image
+    static CGameImage _cgame_image_map_rows(const CGameImage* src, CGameRangeFn fn, CGameImageJob* job) {
+        Gdiplus::BitmapData bd;
+        if (!_cgame_image_begin_read(src, &bd)) {
+            CGameImage none = {0, 0, 0, NULL, NULL};
+            return none;
+        }
+        job->src = (const unsigned char*)bd.Scan0;
+        job->src_stride = bd.Stride;
+        job->sw = job->dw = src->width;
+        job->sh = job->dh = src->height;
+        job->dst = (unsigned char*)_cgame_malloc((size_t)src->width * src->height * 4);
+        if (job->dst) _cgame_parallel_for(src->height, CGAME_JOBS_ROWS, fn, job);
+        src->gdi_bitmap->UnlockBits(&bd);
+        return _cgame_image_from_bgra(job->dst, src->width, src->height);
+    }
+
+    static CGameImage _cgame_image_flip_horizontal_impl(const CGameImage* src)
+    {
+        CGameImageJob job;
+        memset(&job, 0, sizeof(job));
+        return _cgame_image_map_rows(src, _cgame_image_flip_h_rows, &job);
+    }
+
+    static CGameImage _cgame_image_flip_vertical_impl(const CGameImage* src)
+    {
+        CGameImageJob job;
+        memset(&job, 0, sizeof(job));
+        return _cgame_image_map_rows(src, _cgame_image_flip_v_rows, &job);
+    }
+
+
+    // Draw image at (x,y). If image has HBITMAP, use AlphaBlend with compatible DC.
+    static void _cgame_image_draw_impl(const CGameImage* img, int x, int y) {
+        CGAME_ZONE("image.draw");
+        if (!img || !img->gdi_bitmap) return;
+
+        HDC hdc = _cgame_rt->memdc;
+        Gdiplus::Graphics g(hdc);
+        g.SetCompositingMode(Gdiplus::CompositingModeSourceOver);
+        g.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor);
+
+        g.SetSmoothingMode(Gdiplus::SmoothingModeHighQuality);
+
+        g.DrawImage(img->gdi_bitmap, (Gdiplus::REAL)x, (Gdiplus::REAL)y, 
+                    (Gdiplus::REAL)img->width, (Gdiplus::REAL)img->height);
+        _cgame_stat_prim(CGAME_PRIM_IMAGE, x, y, img->width, img->height, -1);
+        _cgame_overdraw_rect(CGAME_PRIM_IMAGE, x, y, img->width, img->height);
+    }
+
+
+    static inline uint32_t _cgame_image_texel(const CGameImageJob* j, int x, int y) {
+        if ((unsigned)x >= (unsigned)j->sw || (unsigned)y >= (unsigned)j->sh) return 0;
+        return ((const uint32_t*)(j->src + (size_t)y * j->src_stride))[x];
+    }
+
+    // Bilinear, transparent outside the source; each row restarts from its own 16.16 origin
+    static void _cgame_image_rotate_rows(void* user, int y0, int y1) {
+        const CGameImageJob* j = (const CGameImageJob*)user;
+        for (int y = y0; y < y1; ++y) {
+            int64_t u = j->u0 + j->uy * y;
+            int64_t v = j->v0 + j->vy * y;
+            uint32_t* d = (uint32_t*)(j->dst + (size_t)y * j->dw * 4);
+            for (int x = 0; x < j->dw; ++x, u += j->ux, v += j->vx) {
+                int xi = (int)(u >> 16), yi = (int)(v >> 16);
+                if (xi < -1 || yi < -1 || xi >= j->sw || yi >= j->sh) { d[x] = 0; continue; }
+
+                uint32_t fx = (uint32_t)(u >> 8) & 0xFF, fy = (uint32_t)(v >> 8) & 0xFF;
+                uint32_t w00 = (256 - fx) * (256 - fy), w10 = fx * (256 - fy);
+                uint32_t w01 = (256 - fx) * fy,         w11 = fx * fy;
+                uint32_t p00 = _cgame_image_texel(j, xi, yi),     p10 = _cgame_image_texel(j, xi + 1, yi);
+                uint32_t p01 = _cgame_image_texel(j, xi, yi + 1), p11 = _cgame_image_texel(j, xi + 1, yi + 1);
+
+                uint32_t px = 0;
+                for (int sh = 0; sh < 32; sh += 8) {
+                    uint32_t c = ((p00 >> sh) & 0xFF) * w00 + ((p10 >> sh) & 0xFF) * w10 +
+                                 ((p01 >> sh) & 0xFF) * w01 + ((p11 >> sh) & 0xFF) * w11;
+                    px |= ((c + 32768) >> 16) << sh;
+                }
+                d[x] = px;
+            }
+        }
+    }
+
+    // Canvas that holds src rotated by angle degrees, at least 1x1
+    static void _cgame_image_rotated_size(int w, int h, float angle, int* new_w, int* new_h) {
+        double radians = angle * M_PI / 180.0;
+        double c = fabs(cos(radians)), s = fabs(sin(radians));
+        *new_w = int(w * c + h * s + 0.5);
+        *new_h = int(w * s + h * c + 0.5);
+        if (*new_w < 1) *new_w = 1;
+        if (*new_h < 1) *new_h = 1;
+    }
+
+    // Rotate clockwise into dst (new_w*new_h BGRA), centred; bd is src's locked bits
+    static void _cgame_image_rotate_into(const CGameImage* src, const Gdiplus::BitmapData* bd, float angle,
+                                         unsigned char* dst, int new_w, int new_h) {
+        double radians = angle * M_PI / 180.0;
+        double c = cos(radians), s = sin(radians);
+
+        // source = R(-angle) * (target centre offset) + source centre, at pixel centres
+        double dx = 0.5 - new_w * 0.5, dy = 0.5 - new_h * 0.5;
+        CGameImageJob job;
+        memset(&job, 0, sizeof(job));
+        job.src = (const unsigned char*)bd->Scan0;
+        job.src_stride = bd->Stride;
+        job.sw = src->width;
+        job.sh = src->height;
+        job.dw = new_w;
+        job.dh = new_h;
+        job.u0 = llround(( dx * c + dy * s + src->width  * 0.5 - 0.5) * 65536.0);
+        job.v0 = llround((-dx * s + dy * c + src->height * 0.5 - 0.5) * 65536.0);
+        job.ux = llround( c * 65536.0);
+        job.vx = llround(-s * 65536.0);
+        job.uy = llround( s * 65536.0);
+        job.vy = llround( c * 65536.0);
+        job.dst = dst;
+        _cgame_parallel_for(new_h, CGAME_JOBS_ROWS, _cgame_image_rotate_rows, &job);
+    }
+
+    // Rotate clockwise into an expanded canvas, centred
+    static CGameImage _cgame_image_rotate_impl(const CGameImage* src, float angle) {
+        CGameImage out = {0, 0, 0, NULL, NULL};
+        Gdiplus::BitmapData bd;
+        if (!_cgame_image_begin_read(src, &bd)) return out;
+
+        int new_w, new_h;
+        _cgame_image_rotated_size(src->width, src->height, angle, &new_w, &new_h);
+        unsigned char* dst = (unsigned char*)_cgame_malloc((size_t)new_w * new_h * 4);
+        if (dst) _cgame_image_rotate_into(src, &bd, angle, dst, new_w, new_h);
+        src->gdi_bitmap->UnlockBits(&bd);
+        return _cgame_image_from_bgra(dst, new_w, new_h);
+    }
+
+    // Same bilinear kernel as image.rotate, into the frame arena, centred on (x,y)
+    static void _cgame_image_draw_rotated_impl(const CGameImage* img, int x, int y, float angle_deg)
+    {
+        CGAME_ZONE("image.draw_rotated");
+        if (!img || !_cgame_rt->memdc) return;
+        Gdiplus::BitmapData bd;
+        if (!_cgame_image_begin_read(img, &bd)) return;
+
+        int new_w, new_h;
+        _cgame_image_rotated_size(img->width, img->height, angle_deg, &new_w, &new_h);
+        CGameArenaMark mark = _cgame_arena_mark();
+        unsigned char* px = (unsigned char*)_cgame_arena_alloc((size_t)new_w * new_h * 4);
+        if (px) _cgame_image_rotate_into(img, &bd, angle_deg, px, new_w, new_h);
+        img->gdi_bitmap->UnlockBits(&bd);
+        if (px) {
+            Gdiplus::Bitmap tmp(new_w, new_h, new_w * 4, PixelFormat32bppPARGB, px);
+            Gdiplus::Graphics g(_cgame_rt->memdc);
+            g.SetCompositingMode(Gdiplus::CompositingModeSourceOver);
+            g.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor);
+            g.DrawImage(&tmp, (Gdiplus::REAL)(x - new_w / 2), (Gdiplus::REAL)(y - new_h / 2),
+                        (Gdiplus::REAL)new_w, (Gdiplus::REAL)new_h);
+        }
+        _cgame_arena_release(&mark);
+        if (!px) return;
+        _cgame_stat_prim(CGAME_PRIM_IMAGE, x - new_w / 2, y - new_h / 2, new_w, new_h, (double)img->width * img->height);
+        _cgame_overdraw_rect(CGAME_PRIM_IMAGE, x - new_w / 2, y - new_h / 2, new_w, new_h);
+    }
+
+    // =========================
+    // Blur and colour matrix
+    //  - Box blur is two sliding-window passes with clamped edges: rows,
+    //    then column strips of CGAME_BLUR_STRIP so each chunk walks
+    //    contiguous bytes. Gaussian is three box passes sized from sigma.
+    //  - The colour matrix works on straight RGBA and re-premultiplies.
+    //  - SSE2 runs the sliding sums four channels to a register and the
+    //    matrix two channels to a register; both round like the scalar code.
+    // =========================
+    #define CGAME_BLUR_STRIP 64
+
+    #ifdef CGAME_FAST_SSE2
+    // Four bytes widened to four 32-bit lanes, and back with saturation
+    static inline __m128i _cgame_blur_load_sse2(const unsigned char* p) {
+        int v;
+        memcpy(&v, p, 4);
+        const __m128i z = _mm_setzero_si128();
+        return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), z), z);
+    }
+
+    static inline void _cgame_blur_store_sse2(unsigned char* p, __m128i v) {
+        v = _mm_packs_epi32(v, v);
+        int o = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+        memcpy(p, &o, 4);
+    }
+
+    // (sum * recip + 2^31) >> 32 per lane, as the scalar path rounds; recip must fit 32 bits (r > 0)
+    static inline __m128i _cgame_blur_div_sse2(__m128i sum, __m128i recip, __m128i half) {
+        __m128i even = _mm_add_epi64(_mm_mul_epu32(sum, recip), half);
+        __m128i odd  = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(sum, 32), recip), half);
+        return _mm_or_si128(_mm_srli_epi64(even, 32), _mm_and_si128(odd, _mm_set_epi32(-1, 0, -1, 0)));
+    }
+    #endif
+
+    static void _cgame_image_blur_h_rows(void* user, int y0, int y1) {
+        const CGameImageJob* j = (const CGameImageJob*)user;
+        const int w = j->sw, r = j->radius;
+        const uint64_t recip = ((uint64_t)1 << 32) / (uint64_t)(2 * r + 1);
+    #ifdef CGAME_FAST_SSE2
+        const __m128i vrecip = _mm_set1_epi32((int)(uint32_t)recip);
+        const __m128i half = _mm_set_epi32(0, (int)0x80000000u, 0, (int)0x80000000u);
+    #endif
+        for (int y = y0; y < y1; ++y) {
+            const unsigned char* s = j->src + (size_t)y * j->src_stride;
+            unsigned char* d = j->dst + (size_t)y * j->dw * 4;
+            uint32_t sum[4];
+            for (int c = 0; c < 4; ++c) sum[c] = (uint32_t)(r + 1) * s[c];
+            for (int i = 1; i <= r; ++i) {
+                const unsigned char* p = s + (size_t)(i < w ? i : w - 1) * 4;
+                for (int c = 0; c < 4; ++c) sum[c] += p[c];
+            }
+            int x = 0;
+        #ifdef CGAME_FAST_SSE2
+            if (r > 0) {
+                __m128i acc = _mm_loadu_si128((const __m128i*)sum);
+                for (; x < w; ++x) {
+                    _cgame_blur_store_sse2(d + x * 4, _cgame_blur_div_sse2(acc, vrecip, half));
+                    const unsigned char* add = s + (size_t)(x + r + 1 < w ? x + r + 1 : w - 1) * 4;
+                    const unsigned char* sub = s + (size_t)(x - r > 0 ? x - r : 0) * 4;
+                    acc = _mm_sub_epi32(_mm_add_epi32(acc, _cgame_blur_load_sse2(add)), _cgame_blur_load_sse2(sub));
+                }
+            }
+        #endif
+            for (; x < w; ++x) {
+                for (int c = 0; c < 4; ++c)
+                    d[x * 4 + c] = (unsigned char)((sum[c] * recip + 0x80000000u) >> 32);
+                const unsigned char* add = s + (size_t)(x + r + 1 < w ? x + r + 1 : w - 1) * 4;
+                const unsigned char* sub = s + (size_t)(x - r > 0 ? x - r : 0) * 4;
+                for (int c = 0; c < 4; ++c) sum[c] = sum[c] + add[c] - sub[c];
+            }
+        }
+    }
+
+    static void _cgame_image_blur_v_cols(void* user, int x0, int x1) {
+        const CGameImageJob* j = (const CGameImageJob*)user;
+        const int h = j->sh, r = j->radius, n = (x1 - x0) * 4;
+        const uint64_t recip = ((uint64_t)1 << 32) / (uint64_t)(2 * r + 1);
+        const unsigned char* base = j->src + (size_t)x0 * 4;
+        uint32_t sum[CGAME_BLUR_STRIP * 4];
+    #ifdef CGAME_FAST_SSE2
+        const __m128i vrecip = _mm_set1_epi32((int)(uint32_t)recip);
+        const __m128i half = _mm_set_epi32(0, (int)0x80000000u, 0, (int)0x80000000u);
+    #endif
+
+        for (int i = 0; i < n; ++i) sum[i] = (uint32_t)(r + 1) * base[i];
+        for (int k = 1; k <= r; ++k) {
+            const unsigned char* p = base + (size_t)(k < h ? k : h - 1) * j->src_stride;
+            for (int i = 0; i < n; ++i) sum[i] += p[i];
+        }
+        for (int y = 0; y < h; ++y) {
+            unsigned char* d = j->dst + (size_t)y * j->dw * 4 + (size_t)x0 * 4;
+            const unsigned char* add = base + (size_t)(y + r + 1 < h ? y + r + 1 : h - 1) * j->src_stride;
+            const unsigned char* sub = base + (size_t)(y - r > 0 ? y - r : 0) * j->src_stride;
+            int i = 0;
+        #ifdef CGAME_FAST_SSE2
+            if (r > 0) {
+                for (; i + 4 <= n; i += 4) {
+                    __m128i acc = _mm_loadu_si128((const __m128i*)(sum + i));
+                    _cgame_blur_store_sse2(d + i, _cgame_blur_div_sse2(acc, vrecip, half));
+                    acc = _mm_sub_epi32(_mm_add_epi32(acc, _cgame_blur_load_sse2(add + i)), _cgame_blur_load_sse2(sub + i));
+                    _mm_storeu_si128((__m128i*)(sum + i), acc);
+                }
+            }
+        #endif
+            for (; i < n; ++i) {
+                d[i] = (unsigned char)((sum[i] * recip + 0x80000000u) >> 32);
+                sum[i] = sum[i] + add[i] - sub[i];
+            }
+        }
+    }
+
+    static CGameImage _cgame_image_blur_passes(const CGameImage* src, const int* radii, int passes) {
+        CGameImage out = {0, 0, 0, NULL, NULL};
+        Gdiplus::BitmapData bd;
+        if (!_cgame_image_begin_read(src, &bd)) return out;
+
+        // Scratch is image-sized and one-shot: the heap, not the arena, which a thread
+        // that never rewinds would keep at this size
+        const int w = src->width, h = src->height;
+        unsigned char* tmp = (unsigned char*)_cgame_malloc((size_t)w * h * 4);
+        unsigned char* dst = (unsigned char*)_cgame_malloc((size_t)w * h * 4);
+        if (!tmp || !dst) {
+            free(tmp);
+            free(dst);
+            src->gdi_bitmap->UnlockBits(&bd);
+            return out;
+        }
+
+        CGameImageJob job;
+        memset(&job, 0, sizeof(job));
+        job.sw = job.dw = w;
+        job.sh = job.dh = h;
+        const unsigned char* in = (const unsigned char*)bd.Scan0;
+        int in_stride = bd.Stride;
+        for (int p = 0; p < passes; ++p) {
+            job.radius = radii[p];
+            job.src = in;
+            job.src_stride = in_stride;
+            job.dst = tmp;
+            _cgame_parallel_for(h, CGAME_JOBS_ROWS, _cgame_image_blur_h_rows, &job);
+            if (p == 0) src->gdi_bitmap->UnlockBits(&bd);
+
+            job.src = tmp;
+            job.src_stride = w * 4;
+            job.dst = dst;
+            _cgame_parallel_for(w, CGAME_BLUR_STRIP, _cgame_image_blur_v_cols, &job);
+            in = dst;
+            in_stride = w * 4;
+        }
+        free(tmp);
+        return _cgame_image_from_bgra(dst, w, h);
+    }
+
+    static CGameImage _cgame_image_blur_box_impl(const CGameImage* src, int radius) {
+        if (radius < 0) radius = 0;
+        if (radius > 65535) radius = 65535;
+        return _cgame_image_blur_passes(src, &radius, 1);
+    }
+
+    // Three box passes whose combined variance matches sigma (Kovesi)
+    static CGameImage _cgame_image_blur_gaussian_impl(const CGameImage* src, float sigma) {
+        int radii[3] = {0, 0, 0};
+        if (sigma > 65535.0f) sigma = 65535.0f;   // boxes already cap at radius 65535; keeps wl in int range
+        if (sigma > 0.0f) {
+            double var12 = 12.0 * (double)sigma * sigma;
+            int wl = (int)floor(sqrt(var12 / 3.0 + 1.0));
+            if (wl % 2 == 0) wl--;
+            int m = (int)floor((var12 - 3.0 * wl * wl - 12.0 * wl - 9.0) / (-4.0 * wl - 4.0) + 0.5);
+            for (int i = 0; i < 3; ++i) {
+                int size = i < m ? wl : wl + 2;
+                radii[i] = size > 1 ? (size - 1) / 2 : 0;
+                if (radii[i] > 65535) radii[i] = 65535;
+            }
+        }
+        return _cgame_image_blur_passes(src, radii, 3);
+    }
+
+    static void _cgame_image_color_rows(void* user, int y0, int y1) {
+        const CGameImageJob* j = (const CGameImageJob*)user;
+    #ifdef CGAME_FAST_SSE2
+        // Two output channels per register in doubles: every product and sum stays an
+        // integer below 2^35, so the result matches the int64 path bit for bit
+        __m128d col_rg[4], col_ba[4];
+        for (int k = 0; k < 4; ++k) {
+            col_rg[k] = _mm_setr_pd(j->m[k], j->m[5 + k]);
+            col_ba[k] = _mm_setr_pd(j->m[10 + k], j->m[15 + k]);
+        }
+        const __m128d off_rg = _mm_setr_pd(j->m[4] + 32768.0, j->m[9] + 32768.0);
+        const __m128d off_ba = _mm_setr_pd(j->m[14] + 32768.0, j->m[19] + 32768.0);
+        const __m128d scale = _mm_set1_pd(1.0 / 65536.0), lo = _mm_setzero_pd(), hi = _mm_set1_pd(255.0);
+    #endif
+        for (int y = y0; y < y1; ++y) {
+            const unsigned char* s = j->src + (size_t)y * j->src_stride;
+            unsigned char* d = j->dst + (size_t)y * j->dw * 4;
+            for (int x = 0; x < j->dw; ++x, s += 4, d += 4) {
+                uint32_t inv = (uint32_t)j->inv[s[3]];
+                int in[4] = {
+                    (int)((s[2] * inv + 32768u) >> 16), (int)((s[1] * inv + 32768u) >> 16),
+                    (int)((s[0] * inv + 32768u) >> 16), s[3]
+                };
+                int o[4];
+            #ifdef CGAME_FAST_SSE2
+                __m128d rg = off_rg, ba = off_ba;
+                for (int k = 0; k < 4; ++k) {
+                    __m128d v = _mm_set1_pd((double)in[k]);
+                    rg = _mm_add_pd(rg, _mm_mul_pd(col_rg[k], v));
+                    ba = _mm_add_pd(ba, _mm_mul_pd(col_ba[k], v));
+                }
+                // Clamp first, then truncation is the scalar floor
+                rg = _mm_min_pd(_mm_max_pd(_mm_mul_pd(rg, scale), lo), hi);
+                ba = _mm_min_pd(_mm_max_pd(_mm_mul_pd(ba, scale), lo), hi);
+                _mm_storeu_si128((__m128i*)o, _mm_unpacklo_epi64(_mm_cvttpd_epi32(rg), _mm_cvttpd_epi32(ba)));
+            #else
+                for (int k = 0; k < 4; ++k) {
+                    const int* m = j->m + k * 5;
+                    int64_t v = (int64_t)m[0] * in[0] + (int64_t)m[1] * in[1] +
+                                (int64_t)m[2] * in[2] + (int64_t)m[3] * in[3] + m[4];
+                    v = (v + 32768) >> 16;
+                    o[k] = v < 0 ? 0 : v > 255 ? 255 : (int)v;
+                }
+            #endif
+                for (int k = 0; k < 3; ++k) {
+                    int t = o[k] * o[3] + 128;
+                    o[k] = (t + (t >> 8)) >> 8;
+                }
+                d[0] = (unsigned char)o[2];
+                d[1] = (unsigned char)o[1];
+                d[2] = (unsigned char)o[0];
+                d[3] = (unsigned char)o[3];
+            }
+        }
+    }
+
+    // m: 4x5 row-major over straight RGBA in 0..1, last column an offset; entries clamp to +-127
+    static CGameImage _cgame_image_color_matrix_impl(const CGameImage* src, const float* m) {
+        CGameImage out = {0, 0, 0, NULL, NULL};
+        if (!m) return out;
+
+        CGameImageJob job;
+        memset(&job, 0, sizeof(job));
+        for (int i = 0; i < 20; ++i) {
+            double f = m[i] < -127.0f ? -127.0 : m[i] > 127.0f ? 127.0 : (double)m[i];
+            job.m[i] = (int)llround(f * (i % 5 == 4 ? 255.0 * 65536.0 : 65536.0));
+        }
+        for (int a = 1; a < 256; ++a) job.inv[a] = (255 * 65536 + a / 2) / a;
+        return _cgame_image_map_rows(src, _cgame_image_color_rows, &job);
+    }
+
+
+
+    // Draw scaled (new_w,new_h): nearest-resize into the frame arena and draw from there
+    static void _cgame_image_draw_scaled_impl(const CGameImage* src, int x, int y, int new_w, int new_h) {
+        CGAME_ZONE("image.draw_scaled");
+        if (!src || new_w <= 0 || new_h <= 0 || !_cgame_rt->memdc) return;
+        Gdiplus::BitmapData bd;
+        if (!_cgame_image_begin_read(src, &bd)) return;
+
+        CGameArenaMark mark = _cgame_arena_mark();
+        unsigned char* px = (unsigned char*)_cgame_arena_alloc((size_t)new_w * new_h * 4);
+        bool ok = px && _cgame_image_resize_into(src, &bd, px, new_w, new_h);
+        src->gdi_bitmap->UnlockBits(&bd);
+        if (ok) {
+            Gdiplus::Bitmap tmp(new_w, new_h, new_w * 4, PixelFormat32bppPARGB, px);
+            Gdiplus::Graphics g(_cgame_rt->memdc);
+            g.SetCompositingMode(Gdiplus::CompositingModeSourceOver);
+            g.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor);
+            g.DrawImage(&tmp, (Gdiplus::REAL)x, (Gdiplus::REAL)y, (Gdiplus::REAL)new_w, (Gdiplus::REAL)new_h);
+        }
+        _cgame_arena_release(&mark);
+        if (!ok) return;
+        _cgame_stat_prim(CGAME_PRIM_IMAGE, x, y, new_w, new_h, -1);
+        _cgame_overdraw_rect(CGAME_PRIM_IMAGE, x, y, new_w, new_h);
+    }
+
+    // Getters
+    static int _cgame_image_get_width_impl(const CGameImage* img) { return img ? img->width : 0; }
+    static int _cgame_image_get_height_impl(const CGameImage* img) { return img ? img->height : 0; }
+    static int _cgame_image_get_channels_impl(const CGameImage* img) { return img ? img->channels : 0; }
+
+    static HICON _cgame_create_icon_from_image(const CGameImage* img) {
+        if (!img || !img->pixels) return NULL;
+
+        // Prepare BITMAPV5HEADER for 32-bit ARGB
+        BITMAPV5HEADER bi;
+        ZeroMemory(&bi, sizeof(bi));
+        bi.bV5Size        = sizeof(BITMAPV5HEADER);
+        bi.bV5Width       =  img->width;
+        bi.bV5Height      = -img->height; // top-down
+        bi.bV5Planes      = 1;
+        bi.bV5BitCount    = 32;
+        bi.bV5Compression = BI_BITFIELDS;
+        bi.bV5RedMask     =  0x00FF0000;
+        bi.bV5GreenMask   =  0x0000FF00;
+        bi.bV5BlueMask    =  0x000000FF;
+        bi.bV5AlphaMask   =  0xFF000000;
+
+        HDC hdc = GetDC(NULL);
+        void* bits = NULL;
+        HBITMAP colorBmp = CreateDIBSection(hdc, (BITMAPINFO*)&bi, DIB_RGB_COLORS, &bits, NULL, 0);
+        ReleaseDC(NULL, hdc);
+        if (!colorBmp || !bits) {
+            if (colorBmp) DeleteObject(colorBmp);
+            return NULL;
+        }
+
+        // Copy pixels (straight RGBA → BGRA with alpha)
+        int w = img->width, h = img->height, c = img->channels;
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                unsigned char* dst = (unsigned char*)bits + (y * w + x) * 4;
+                const unsigned char* src = img->pixels + ((y * w + x) * c);
+
+                dst[0] = src[2]; // B
+                dst[1] = src[1]; // G
+                dst[2] = src[0]; // R
+                dst[3] = (c >= 4) ? src[3] : 255; // A
+            }
+        }
+
+        // Create monochrome mask (unused but required)
+        HBITMAP maskBmp = CreateBitmap(w, h, 1, 1, NULL);
+
+        ICONINFO ii;
+        ZeroMemory(&ii, sizeof(ii));
+        ii.fIcon    = TRUE;
+        ii.xHotspot = 0;
+        ii.yHotspot = 0;
+        ii.hbmMask  = maskBmp;
+        ii.hbmColor = colorBmp;
+
+        HICON hIcon = CreateIconIndirect(&ii);
+
+        DeleteObject(colorBmp);
+        DeleteObject(maskBmp);
+
+        return hIcon;
+    }
+
+    static bool _cgame_display_set_icon_from_image(const CGameImage* img) {
+        if (!img) return false;
+        HICON hIcon = _cgame_create_icon_from_image(img);
+        if (!hIcon) return false;
+
+        _cgame_window_icon = hIcon;
+        if (_cgame_screen.hwnd) {
+            SendMessage(_cgame_screen.hwnd, WM_SETICON, ICON_BIG,   (LPARAM)hIcon);
+            SendMessage(_cgame_screen.hwnd, WM_SETICON, ICON_SMALL, (LPARAM)hIcon);
+        }
+        return true;
+    }
+
+    // =========================================================
+    // Asset packs (pre-decoded, memory-mapped images)
+    //  - Layout: header, table of contents, then one blob per image.
+    //  - Pixels are stored as 32bpp premultiplied BGRA, the same layout
+    //    CGameImage bitmaps use (PixelFormat32bppPARGB), so raw entries
+    //    are wrapped straight from the mapping without any copy.
+    //  - Every blob starts on a page boundary: images that are never
+    //    drawn are never paged in.
+    // =========================================================
+
+    #define CGAME_PACK_MAGIC      0x4B504743u // "CGPK"
+    #define CGAME_PACK_VERSION    1
+    #define CGAME_PACK_ALIGN      4096
+    #define CGAME_PACK_NAME_MAX   96
+
+    #define CGAME_PACK_CODEC_RAW  0
+    #define CGAME_PACK_CODEC_LZ4  1
+
+    #define CGAME_FNV64_BASIS     0xcbf29ce484222325ull
+
+    typedef struct {
+        unsigned int magic;
+        unsigned int version;
+        unsigned int count;
+        unsigned int flags;
+    } CGamePackHeader;
+
+    typedef struct {
+        char               name[CGAME_PACK_NAME_MAX];
+        unsigned int       width;
+        unsigned int       height;
+        unsigned int       stride;
+        unsigned int       codec;
+        unsigned long long name_hash;
+        unsigned long long offset;    // from start of file, CGAME_PACK_ALIGN aligned
+        unsigned long long size;      // stored bytes
+        unsigned long long raw_size;  // decoded bytes (stride * height)
+    } CGamePackEntry;
+
+    struct CGamePack {
+        HANDLE                file;
+        HANDLE                mapping;
+        const unsigned char*  base;
+        unsigned long long    size;
+        int                   count;
+        const CGamePackEntry* entries;
+    };
+
+    static unsigned long long _cgame_fnv1a64(const void* data, size_t len, unsigned long long h) {
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t i = 0; i < len; ++i) {
+            h ^= p[i];
+            h *= 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    // UTF-8 → wide, malloc'd (caller frees)
+    static wchar_t* _cgame_utf8_to_wide_alloc(const char* s) {
+        if (!s) return NULL;
+        int len = MultiByteToWideChar(CP_UTF8, 0, s, -1, NULL, 0);
+        if (len <= 0) return NULL;
+        wchar_t* w = (wchar_t*)_cgame_malloc(len * sizeof(wchar_t));
+        if (!w) return NULL;
+        MultiByteToWideChar(CP_UTF8, 0, s, -1, w, len);
+        return w;
+    }
+
+    // -------------------------
+    // LZ4 block format (no frame header)
+    // -------------------------
+    static inline unsigned int _cgame_read32(const unsigned char* p) {
+        unsigned int v;
+        memcpy(&v, p, 4);
+        return v;
+    }
+
+    static int _cgame_lz4_bound(int n) { return n + n / 255 + 16; }
+
+    static int _cgame_lz4_write_len(unsigned char* dst, int op, int cap, int len) {
+        while (len >= 255) {
+            if (op >= cap) return -1;
+            dst[op++] = 255;
+            len -= 255;
+        }
+        if (op >= cap) return -1;
+        dst[op++] = (unsigned char)len;
+        return op;
+    }
+
+    // Greedy single-probe compressor. Returns compressed size, 0 if it does not fit in dst_cap.
+    static int _cgame_lz4_compress(const unsigned char* src, int src_len, unsigned char* dst, int dst_cap) {
+        enum { HASH_BITS = 12, MIN_MATCH = 4, MFLIMIT = 12, LASTLITERALS = 5 };
+        int table[1 << HASH_BITS];
+        memset(table, 0, sizeof(table));
+
+        int ip = 0, anchor = 0, op = 0;
+        const int mflimit    = src_len - MFLIMIT;
+        const int matchlimit = src_len - LASTLITERALS;
+
+        while (ip < mflimit) {
+            unsigned int seq = _cgame_read32(src + ip);
+            unsigned int h   = (seq * 2654435761u) >> (32 - HASH_BITS);
+            int ref = table[h];
+            table[h] = ip;
+
+            if (ref >= ip || ip - ref > 65535 || _cgame_read32(src + ref) != seq) {
+                ++ip;
+                continue;
+            }
+
+            int mlen = MIN_MATCH;
+            while (ip + mlen < matchlimit && src[ref + mlen] == src[ip + mlen]) ++mlen;
+
+            int lit = ip - anchor;
+            if (op + 1 + lit + lit / 255 + 3 + mlen / 255 > dst_cap) return 0;
+
+            int token = op++;
+            dst[token] = (unsigned char)(((lit < 15) ? lit : 15) << 4);
+            if (lit >= 15) op = _cgame_lz4_write_len(dst, op, dst_cap, lit - 15);
+            if (op < 0) return 0;
+            memcpy(dst + op, src + anchor, lit);
+            op += lit;
+
+            int off = ip - ref;
+            dst[op++] = (unsigned char)(off & 0xFF);
+            dst[op++] = (unsigned char)(off >> 8);
+
+            int ml = mlen - MIN_MATCH;
+            dst[token] |= (unsigned char)((ml < 15) ? ml : 15);
+            if (ml >= 15) op = _cgame_lz4_write_len(dst, op, dst_cap, ml - 15);
+            if (op < 0) return 0;
+
+            ip += mlen;
+            anchor = ip;
+        }
+
+        // Last literals
+        int lit = src_len - anchor;
+        if (op + 1 + lit + lit / 255 + 1 > dst_cap) return 0;
+        int token = op++;
+        dst[token] = (unsigned char)(((lit < 15) ? lit : 15) << 4);
+        if (lit >= 15) op = _cgame_lz4_write_len(dst, op, dst_cap, lit - 15);
+        if (op < 0) return 0;
+        memcpy(dst + op, src + anchor, lit);
+        op += lit;
+        return op;
+    }
+
+    // Bounds-checked decoder. Returns decoded size, -1 on malformed input.
+    static int _cgame_lz4_decompress(const unsigned char* src, int src_len, unsigned char* dst, int dst_len) {
+        int ip = 0, op = 0;
+        while (ip < src_len) {
+            int token = src[ip++];
+
+            int lit = token >> 4;
+            if (lit == 15) {
+                int b;
+                do {
+                    if (ip >= src_len) return -1;
+                    b = src[ip++];
+                    lit += b;
+                    if (lit > dst_len - op) return -1; // before a run of 255s can overflow it
+                } while (b == 255);
+            }
+            if (lit > src_len - ip || lit > dst_len - op) return -1;
+            memcpy(dst + op, src + ip, lit);
+            ip += lit;
+            op += lit;
+            if (ip >= src_len) break; // last sequence has no match
+
+            if (src_len - ip < 2) return -1;
+            int off = src[ip] | (src[ip + 1] << 8);
+            ip += 2;
+            if (off == 0 || off > op) return -1;
+
+            int mlen = token & 15;
+            if (mlen == 15) {
+                int b;
+                do {
+                    if (ip >= src_len) return -1;
+                    b = src[ip++];
+                    mlen += b;
+                    if (mlen > dst_len - op) return -1;
+                } while (b == 255);
+            }
+            if (mlen > dst_len - op - 4) return -1;
+            mlen += 4;
+
+            // byte copy: matches may overlap their own output
+            unsigned char* d = dst + op;
+            const unsigned char* s = d - off;
+            for (int i = 0; i < mlen; ++i) d[i] = s[i];
+            op += mlen;
+        }
+        return op;
+    }
+
+    // -------------------------
+    // Packer
+    // -------------------------
+    static bool _cgame_pack_write_all(HANDLE f, const void* data, size_t len) {
+        const unsigned char* p = (const unsigned char*)data;
+        while (len > 0) {
+            DWORD chunk = (len > 0x40000000) ? 0x40000000 : (DWORD)len;
+            DWORD written = 0;
+            if (!WriteFile(f, p, chunk, &written, NULL) || written != chunk) return false;
+            p += chunk;
+            len -= chunk;
+        }
+        return true;
+    }
+
+    static bool _cgame_pack_pad_to(HANDLE f, unsigned long long* pos, unsigned long long align) {
+        static const unsigned char zeros[CGAME_PACK_ALIGN] = { 0 };
+        unsigned long long pad = (align - (*pos % align)) % align;
+        if (pad && !_cgame_pack_write_all(f, zeros, (size_t)pad)) return false;
+        *pos += pad;
+        return true;
+    }
+
+    // Decode every image once and write them into a pack at out_path.
+    static bool _cgame_pack_build_impl(const char* out_path, const char** paths, int count, int flags) {
+        if (!out_path || !paths || count <= 0) return false;
+
+        // Ensure GDI+ started (the packer usually runs as a standalone tool)
         if (!_cgame_gdiplus_inited) {
             Gdiplus::GdiplusStartupInput input;
             Gdiplus::GdiplusStartup(&_cgame_gdiplusToken, &input, NULL);
             _cgame_gdiplus_inited = true;
         }
 
-        // Convert UTF-8 → wide (C-compatible)
-        int len = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
-        if (len <= 0) return img;
+        // Written to "<out>.tmp" and renamed over out_path only once complete
+        wchar_t* wout = _cgame_utf8_to_wide_alloc(out_path);
+        if (!wout) return false;
+        size_t wlen = wcslen(wout);
+        wchar_t* wtmp = (wchar_t*)_cgame_malloc((wlen + 5) * sizeof(wchar_t));
+        if (!wtmp) { free(wout); return false; }
+        memcpy(wtmp, wout, wlen * sizeof(wchar_t));
+        memcpy(wtmp + wlen, L".tmp", 5 * sizeof(wchar_t));
+
+        HANDLE f = CreateFileW(wtmp, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (f == INVALID_HANDLE_VALUE) { free(wtmp); free(wout); return false; }
+
+        CGamePackEntry* toc = (CGamePackEntry*)_cgame_calloc((size_t)count, sizeof(CGamePackEntry));
+        if (!toc) {
+            CloseHandle(f);
+            DeleteFileW(wtmp);
+            free(wtmp);
+            free(wout);
+            return false;
+        }
+
+        CGamePackHeader hdr;
+        hdr.magic   = CGAME_PACK_MAGIC;
+        hdr.version = CGAME_PACK_VERSION;
+        hdr.count   = (unsigned int)count;
+        hdr.flags   = (unsigned int)flags;
+
+        // Reserve header + TOC, rewritten once the offsets are known
+        bool ok = _cgame_pack_write_all(f, &hdr, sizeof(hdr)) &&
+                  _cgame_pack_write_all(f, toc, sizeof(CGamePackEntry) * (size_t)count);
+        unsigned long long pos = sizeof(hdr) + sizeof(CGamePackEntry) * (unsigned long long)count;
+
+        for (int i = 0; ok && i < count; ++i) {
+            CGamePackEntry* e = &toc[i];
+            size_t nlen = strlen(paths[i]);
+            if (nlen >= CGAME_PACK_NAME_MAX) { ok = false; break; }
+            memcpy(e->name, paths[i], nlen);
+            e->name_hash = _cgame_fnv1a64(paths[i], nlen, CGAME_FNV64_BASIS);
+
+            wchar_t* wpath = _cgame_utf8_to_wide_alloc(paths[i]);
+            if (!wpath) { ok = false; break; }
+            Gdiplus::Bitmap* bmp = Gdiplus::Bitmap::FromFile(wpath, FALSE);
+            free(wpath);
+            if (!bmp || bmp->GetLastStatus() != Gdiplus::Ok) {
+                if (bmp) delete bmp;
+                ok = false;
+                break;
+            }
+
+            UINT w = bmp->GetWidth();
+            UINT h = bmp->GetHeight();
+            Gdiplus::Rect rect(0, 0, w, h);
+            Gdiplus::BitmapData bd;
+            if (bmp->LockBits(&rect, Gdiplus::ImageLockModeRead, PixelFormat32bppPARGB, &bd) != Gdiplus::Ok) {
+                delete bmp;
+                ok = false;
+                break;
+            }
+
+            // Tightly packed rows; the loader takes sizes as int
+            size_t stride = (size_t)w * 4;
+            size_t raw_size = stride * h;
+            if ((unsigned long long)w * 4 * h > INT_MAX) {
+                bmp->UnlockBits(&bd);
+                delete bmp;
+                ok = false;
+                break;
+            }
+            unsigned char* raw = (unsigned char*)_cgame_malloc(raw_size ? raw_size : 1);
+            if (raw) {
+                for (UINT y = 0; y < h; ++y)
+                    memcpy(raw + y * stride, (unsigned char*)bd.Scan0 + (size_t)y * bd.Stride, stride);
+            }
+            bmp->UnlockBits(&bd);
+            delete bmp;
+            if (!raw) { ok = false; break; }
+
+            e->width    = w;
+            e->height   = h;
+            e->stride   = (unsigned int)stride;
+            e->codec    = CGAME_PACK_CODEC_RAW;
+            e->raw_size = raw_size;
+            e->size     = raw_size;
+
+            const unsigned char* blob = raw;
+            unsigned char* packed = NULL;
+            if ((flags & CGAME_PACK_LZ4) && raw_size > 0 && raw_size < 0x7FFFFFF0u) {
+                int cap = _cgame_lz4_bound((int)raw_size);
+                packed = (unsigned char*)_cgame_malloc((size_t)cap);
+                int n = packed ? _cgame_lz4_compress(raw, (int)raw_size, packed, cap) : 0;
+                if (n > 0 && (size_t)n < raw_size) {
+                    e->codec = CGAME_PACK_CODEC_LZ4;
+                    e->size  = (unsigned long long)n;
+                    blob     = packed;
+                }
+            }
+
+            ok = _cgame_pack_pad_to(f, &pos, CGAME_PACK_ALIGN);
+            e->offset = pos;
+            if (ok) ok = _cgame_pack_write_all(f, blob, (size_t)e->size);
+            pos += e->size;
+
+            free(packed);
+            free(raw);
+        }
+
+        if (ok) {
+            LARGE_INTEGER zero;
+            zero.QuadPart = 0;
+            ok = SetFilePointerEx(f, zero, NULL, FILE_BEGIN) &&
+                 _cgame_pack_write_all(f, &hdr, sizeof(hdr)) &&
+                 _cgame_pack_write_all(f, toc, sizeof(CGamePackEntry) * (size_t)count);
+        }
+
+        free(toc);
+        CloseHandle(f);
+        if (ok) ok = MoveFileExW(wtmp, wout, MOVEFILE_REPLACE_EXISTING) != 0;
+        if (!ok) DeleteFileW(wtmp);
+        free(wtmp);
+        free(wout);
+        return ok;
+    }
+
+    // -------------------------
+    // Runtime loader
+    // -------------------------
+    static void _cgame_pack_close_impl(CGamePack* pack) {
+        if (!pack) return;
+        if (pack->base)    UnmapViewOfFile(pack->base);
+        if (pack->mapping) CloseHandle(pack->mapping);
+        if (pack->file && pack->file != INVALID_HANDLE_VALUE) CloseHandle(pack->file);
+        free(pack);
+    }
+
+    static CGamePack* _cgame_pack_open_impl(const char* path) {
+        wchar_t* wpath = _cgame_utf8_to_wide_alloc(path);
+        if (!wpath) return NULL;
+
+        CGamePack* pack = (CGamePack*)_cgame_calloc(1, sizeof(CGamePack));
+        if (!pack) { free(wpath); return NULL; }
+
+        pack->file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL, NULL);
+        free(wpath);
+        if (pack->file == INVALID_HANDLE_VALUE) { pack->file = NULL; _cgame_pack_close_impl(pack); return NULL; }
+
+        LARGE_INTEGER sz;
+        if (!GetFileSizeEx(pack->file, &sz) || (unsigned long long)sz.QuadPart < sizeof(CGamePackHeader)) {
+            _cgame_pack_close_impl(pack);
+            return NULL;
+        }
+        pack->size = (unsigned long long)sz.QuadPart;
+
+        pack->mapping = CreateFileMappingW(pack->file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!pack->mapping) { _cgame_pack_close_impl(pack); return NULL; }
+        pack->base = (const unsigned char*)MapViewOfFile(pack->mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!pack->base) { _cgame_pack_close_impl(pack); return NULL; }
+
+        // Validate header and every entry once, so lookups can trust the TOC
+        const CGamePackHeader* hdr = (const CGamePackHeader*)pack->base;
+        unsigned long long toc_end = sizeof(CGamePackHeader) + (unsigned long long)hdr->count * sizeof(CGamePackEntry);
+        if (hdr->magic != CGAME_PACK_MAGIC || hdr->version != CGAME_PACK_VERSION || toc_end > pack->size ||
+            hdr->count > INT_MAX) {
+            _cgame_pack_close_impl(pack);
+            return NULL;
+        }
+        pack->count   = (int)hdr->count;
+        pack->entries = (const CGamePackEntry*)(pack->base + sizeof(CGamePackHeader));
+
+        // Sizes reach GDI+ and LZ4 as int: anything past INT_MAX is rejected here
+        for (int i = 0; i < pack->count; ++i) {
+            const CGamePackEntry* e = &pack->entries[i];
+            if (e->offset < toc_end || e->offset > pack->size || e->size > pack->size - e->offset ||
+                e->size > INT_MAX || e->raw_size > INT_MAX || e->stride > INT_MAX ||
+                e->width > INT_MAX / 4 || e->height > INT_MAX ||
+                e->stride < (unsigned long long)e->width * 4 ||
+                e->raw_size != (unsigned long long)e->stride * e->height ||
+                (e->codec == CGAME_PACK_CODEC_RAW && e->size != e->raw_size) ||
+                e->codec > CGAME_PACK_CODEC_LZ4 || e->name[CGAME_PACK_NAME_MAX - 1] != '\0') {
+                _cgame_pack_close_impl(pack);
+                return NULL;
+            }
+        }
+        return pack;
+    }
+
+    static int _cgame_pack_count_impl(const CGamePack* pack) { return pack ? pack->count : 0; }
+
+    static const char* _cgame_pack_name_impl(const CGamePack* pack, int index) {
+        if (!pack || index < 0 || index >= pack->count) return NULL;
+        return pack->entries[index].name;
+    }
+
+    static int _cgame_pack_find_impl(const CGamePack* pack, const char* name) {
+        if (!pack || !name) return -1;
+        size_t len = strlen(name);
+        unsigned long long h = _cgame_fnv1a64(name, len, CGAME_FNV64_BASIS);
+        for (int i = 0; i < pack->count; ++i) {
+            if (pack->entries[i].name_hash == h && strcmp(pack->entries[i].name, name) == 0) return i;
+        }
+        return -1;
+    }
+
+    // Raw entries borrow the mapping (the pack must outlive the image);
+    // LZ4 entries decode into a bitmap the image owns.
+    static CGameImage _cgame_pack_get_index_impl(const CGamePack* pack, int index) {
+        CGameImage img = {0, 0, 0, NULL, NULL};
+        if (!pack || index < 0 || index >= pack->count) return img;
+        const CGamePackEntry* e = &pack->entries[index];
+        if (e->width == 0 || e->height == 0) return img;
+
+        Gdiplus::Bitmap* bmp = NULL;
+        if (e->codec == CGAME_PACK_CODEC_RAW) {
+            bmp = new Gdiplus::Bitmap((int)e->width, (int)e->height, (int)e->stride,
+                                      PixelFormat32bppPARGB, (BYTE*)(pack->base + e->offset));
+        } else {
+            bmp = new Gdiplus::Bitmap((int)e->width, (int)e->height, PixelFormat32bppPARGB);
+            Gdiplus::Rect rect(0, 0, (int)e->width, (int)e->height);
+            Gdiplus::BitmapData bd;
+            if (bmp->LockBits(&rect, Gdiplus::ImageLockModeWrite, PixelFormat32bppPARGB, &bd) != Gdiplus::Ok) {
+                delete bmp;
+                return img;
+            }
+            int decoded = -1;
+            if (bd.Stride == (int)e->stride) {
+                decoded = _cgame_lz4_decompress(pack->base + e->offset, (int)e->size,
+                                                (unsigned char*)bd.Scan0, (int)e->raw_size);
+            } else {
+                unsigned char* tmp = (unsigned char*)_cgame_malloc((size_t)e->raw_size);
+                if (tmp) {
+                    decoded = _cgame_lz4_decompress(pack->base + e->offset, (int)e->size, tmp, (int)e->raw_size);
+                    for (unsigned int y = 0; decoded >= 0 && y < e->height; ++y)
+                        memcpy((unsigned char*)bd.Scan0 + (size_t)y * bd.Stride, tmp + (size_t)y * e->stride,
+                               (size_t)e->width * 4);
+                    free(tmp);
+                }
+            }
+            bmp->UnlockBits(&bd);
+            if (decoded != (int)e->raw_size) {
+                delete bmp;
+                return img;
+            }
+        }
+
+        if (!bmp || bmp->GetLastStatus() != Gdiplus::Ok) {
+            if (bmp) delete bmp;
+            return img;
+        }
+
+        img.width      = (int)e->width;
+        img.height     = (int)e->height;
+        img.channels   = 4;
+        img.gdi_bitmap = bmp;
+        return img;
+    }
+
+    static CGameImage _cgame_pack_get_impl(const CGamePack* pack, const char* name) {
+        return _cgame_pack_get_index_impl(pack, _cgame_pack_find_impl(pack, name));
+    }
+
+    // =========================================================
+    // Image cache
+    //  - acquire() returns a shared image, refcounted per caller.
+    //  - Keyed by path, deduplicated by content hash: two paths with
+    //    the same bytes share one decoded bitmap.
+    //  - Unreferenced images stay resident until the byte budget is
+    //    exceeded, then the least recently used ones are evicted.
+    //    Referenced images are never evicted.
+    // =========================================================
+    typedef struct {
+        CGameImage         image;        // first member: handles point here
+        unsigned long long content_hash;
+        size_t             bytes;
+        int                refs;
+        unsigned long long last_used;
+    } CGameCacheImage;
+
+    typedef struct {
+        char*              path;
+        unsigned long long path_hash;
+        CGameCacheImage*   entry;
+    } CGameCachePath;
+
+    static CGameCacheImage**  _cgame_cache_images      = NULL; // entries are individually allocated: handles stay valid
+    static int                _cgame_cache_image_count = 0;
+    static int                _cgame_cache_image_cap   = 0;
+    static CGameCachePath*    _cgame_cache_paths       = NULL;
+    static int                _cgame_cache_path_count  = 0;
+    static int                _cgame_cache_path_cap    = 0;
+    static size_t             _cgame_cache_bytes       = 0;
+    static size_t             _cgame_cache_budget      = 0;    // 0 = unlimited
+    static unsigned long long _cgame_cache_clock       = 0;
+
+    static bool _cgame_cache_hash_file(const char* path, unsigned long long* out) {
+        wchar_t* wpath = _cgame_utf8_to_wide_alloc(path);
+        if (!wpath) return false;
+        HANDLE f = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        free(wpath);
+        if (f == INVALID_HANDLE_VALUE) return false;
+
+        unsigned char buf[64 * 1024];
+        unsigned long long h = CGAME_FNV64_BASIS;
+        DWORD got = 0;
+        bool ok = true;
+        for (;;) {
+            if (!ReadFile(f, buf, sizeof(buf), &got, NULL)) { ok = false; break; }
+            if (got == 0) break;
+            h = _cgame_fnv1a64(buf, got, h);
+        }
+        CloseHandle(f);
+        *out = h;
+        return ok;
+    }
+
+    static void _cgame_cache_evict_entry(int index) {
+        CGameCacheImage* e = _cgame_cache_images[index];
+
+        // Drop every path alias that resolves to this image
+        for (int i = 0; i < _cgame_cache_path_count; ) {
+            if (_cgame_cache_paths[i].entry == e) {
+                free(_cgame_cache_paths[i].path);
+                _cgame_cache_paths[i] = _cgame_cache_paths[--_cgame_cache_path_count];
+            } else {
+                ++i;
+            }
+        }
+
+        _cgame_cache_bytes -= e->bytes;
+        _cgame_image_unload_impl(&e->image);
+        free(e);
+        _cgame_cache_images[index] = _cgame_cache_images[--_cgame_cache_image_count];
+    }
+
+    // Evict unreferenced images, oldest first, until usage fits the budget
+    static void _cgame_cache_enforce_budget(void) {
+        if (_cgame_cache_budget == 0) return;
+        while (_cgame_cache_bytes > _cgame_cache_budget) {
+            int victim = -1;
+            for (int i = 0; i < _cgame_cache_image_count; ++i) {
+                CGameCacheImage* e = _cgame_cache_images[i];
+                if (e->refs == 0 && (victim < 0 || e->last_used < _cgame_cache_images[victim]->last_used))
+                    victim = i;
+            }
+            if (victim < 0) return; // everything left is in use
+            _cgame_cache_evict_entry(victim);
+        }
+    }
+
+    static bool _cgame_cache_add_path(const char* path, unsigned long long path_hash, CGameCacheImage* e) {
+        if (_cgame_cache_path_count == _cgame_cache_path_cap) {
+            int cap = _cgame_cache_path_cap ? _cgame_cache_path_cap * 2 : 32;
+            CGameCachePath* p = (CGameCachePath*)_cgame_realloc(_cgame_cache_paths, sizeof(CGameCachePath) * cap);
+            if (!p) return false;
+            _cgame_cache_paths = p;
+            _cgame_cache_path_cap = cap;
+        }
+        size_t len = strlen(path);
+        char* copy = (char*)_cgame_malloc(len + 1);
+        if (!copy) return false;
+        memcpy(copy, path, len + 1);
+
+        CGameCachePath* slot = &_cgame_cache_paths[_cgame_cache_path_count++];
+        slot->path      = copy;
+        slot->path_hash = path_hash;
+        slot->entry     = e;
+        return true;
+    }
+
+    static const CGameImage* _cgame_cache_acquire_impl(const char* path) {
+        if (!path) return NULL;
+        size_t len = strlen(path);
+        unsigned long long path_hash = _cgame_fnv1a64(path, len, CGAME_FNV64_BASIS);
+
+        // 1. Same path seen before
+        for (int i = 0; i < _cgame_cache_path_count; ++i) {
+            CGameCachePath* p = &_cgame_cache_paths[i];
+            if (p->path_hash == path_hash && strcmp(p->path, path) == 0) {
+                p->entry->refs++;
+                p->entry->last_used = ++_cgame_cache_clock;
+                return &p->entry->image;
+            }
+        }
+
+        // 2. Same bytes under another path
+        unsigned long long content_hash;
+        if (!_cgame_cache_hash_file(path, &content_hash)) return NULL;
+        for (int i = 0; i < _cgame_cache_image_count; ++i) {
+            CGameCacheImage* e = _cgame_cache_images[i];
+            if (e->content_hash == content_hash) {
+                if (!_cgame_cache_add_path(path, path_hash, e)) return NULL;
+                e->refs++;
+                e->last_used = ++_cgame_cache_clock;
+                return &e->image;
+            }
+        }
+
+        // 3. Decode once
+        if (_cgame_cache_image_count == _cgame_cache_image_cap) {
+            int cap = _cgame_cache_image_cap ? _cgame_cache_image_cap * 2 : 32;
+            CGameCacheImage** arr = (CGameCacheImage**)_cgame_realloc(_cgame_cache_images, sizeof(CGameCacheImage*) * cap);
+            if (!arr) return NULL;
+            _cgame_cache_images = arr;
+            _cgame_cache_image_cap = cap;
+        }
+
+        CGameCacheImage* e = (CGameCacheImage*)_cgame_calloc(1, sizeof(CGameCacheImage));
+        if (!e) return NULL;
+        e->image = _cgame_image_load_impl(path);
+        if (!e->image.gdi_bitmap) { free(e); return NULL; }
+        e->content_hash = content_hash;
+        e->bytes        = (size_t)e->image.width * (size_t)e->image.height * 4;
+        e->refs         = 1;
+        e->last_used    = ++_cgame_cache_clock;
+
+        if (!_cgame_cache_add_path(path, path_hash, e)) {
+            _cgame_image_unload_impl(&e->image);
+            free(e);
+            return NULL;
+        }
+        _cgame_cache_images[_cgame_cache_image_count++] = e;
+        _cgame_cache_bytes += e->bytes;
+
+        _cgame_cache_enforce_budget();
+        return &e->image;
+    }
+
+    static void _cgame_cache_release_impl(const CGameImage* img) {
+        if (!img) return;
+        for (int i = 0; i < _cgame_cache_image_count; ++i) {
+            CGameCacheImage* e = _cgame_cache_images[i];
+            if (&e->image == img) {
+                if (e->refs > 0) e->refs--;
+                if (e->refs == 0) _cgame_cache_enforce_budget();
+                return;
+            }
+        }
+    }
+
+    static void _cgame_cache_set_budget_impl(size_t bytes) {
+        _cgame_cache_budget = bytes;
+        _cgame_cache_enforce_budget();
+    }
+
+    static size_t _cgame_cache_get_usage_impl(void) { return _cgame_cache_bytes; }
+    static int    _cgame_cache_get_count_impl(void) { return _cgame_cache_image_count; }
+
+    // Drop every unreferenced image regardless of budget
+    static void _cgame_cache_purge_impl(void) {
+        for (int i = 0; i < _cgame_cache_image_count; ) {
+            if (_cgame_cache_images[i]->refs == 0) _cgame_cache_evict_entry(i);
+            else ++i;
+        }
+    }
+
+    // Called from quit: bitmaps must go before GDI+ shuts down
+    static void _cgame_cache_free_all(void) {
+        while (_cgame_cache_image_count > 0) _cgame_cache_evict_entry(_cgame_cache_image_count - 1);
+        free(_cgame_cache_images);
+        free(_cgame_cache_paths);
+        _cgame_cache_images = NULL;
+        _cgame_cache_paths  = NULL;
+        _cgame_cache_image_cap = _cgame_cache_path_cap = 0;
+        _cgame_cache_bytes = 0;
+    }
+
+
+
+    // =========================
+    // Core functions
+    // =========================
+    static void _cgame_init(void) {
+        _cgame_hInstance = GetModuleHandleW(NULL);
+        _cgame_running = true;
+        _cgame_event_head = _cgame_event_tail = 0;
+        _cgame_event_dropped = 0;
+
+        // Start GDI+ (if not already)
+        if (!_cgame_gdiplus_inited) {
+            Gdiplus::GdiplusStartupInput gdiplusStartupInput;
+            if (GdiplusStartup(&_cgame_gdiplusToken, &gdiplusStartupInput, NULL) == Gdiplus::Ok) {
+                _cgame_gdiplus_inited = true;
+            }
+        }
+    }
+    
+    // terminal color
+    static void _cgame_console_set_color(int fg, int bg) {
+        HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+        SetConsoleTextAttribute(hConsole, (WORD)((bg << 4) | (fg & 0x0F)));
+    }
+
+    static void _cgame_console_reset_color(void) {
+        HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+        SetConsoleTextAttribute(hConsole, (WORD)(CGAME_CONSOLE_COLOR_WHITE | (CGAME_CONSOLE_COLOR_BLACK << 4)));
+    }
+
+
+    // message box wrapper
+    static int _cgame_message_box(const wchar_t* title, const wchar_t* text, UINT type) {
+        return MessageBoxW(NULL, text, title, type);
+    }
+
+
+    static void _cgame_quit(void) {
+        _cgame_running = false;
+        if (_cgame_screen.hwnd) {
+            if (_cgame_screen.use_opengl) {
+                _cgame_cleanup_opengl(_cgame_screen.hdc, _cgame_screen.hglrc);
+            } else if (_cgame_screen.use_vulkan) {
+                _cgame_cleanup_vulkan(_cgame_screen.vk_lib);
+            } else if (_cgame_screen.use_d3d12) {
+                _cgame_cleanup_d3d12(_cgame_screen.d3d12_lib);
+            } else {
+                if (_cgame_screen.hdc) ReleaseDC(_cgame_screen.hwnd, _cgame_screen.hdc);
+            }
+            if (_cgame_pump_thread) _cgame_pump_thread_stop(); // the window belongs to the pump thread
+            else DestroyWindow(_cgame_screen.hwnd);
+            _cgame_screen.hwnd = NULL;
+        }
+        _cgame_inbox_enabled = false;
+        _cgame_overdraw_free();
+        _cgame_free_backbuffer();
+        UnregisterClassW(L"CGameWindowClass", _cgame_hInstance);
+
+        _cgame_cache_free_all();
+        _cgame_font_cache_free_all(&_cgame_screen_rt);
+        _cgame_jobs_stop();
+        _cgame_arena_free();
+        if (_cgame_recording) _cgame_record_stop_impl();
+        _cgame_replay_stop_impl();
+        if (_cgame_pace_timer) {
+            CloseHandle(_cgame_pace_timer);
+            _cgame_pace_timer = NULL;
+            _cgame_pace_timer_tried = false;
+        }
+
+        // Shutdown GDI+ if inited
+        if (_cgame_gdiplus_inited) {
+            GdiplusShutdown(_cgame_gdiplusToken);
+            _cgame_gdiplus_inited = false;
+            _cgame_gdiplusToken = 0;
+        }
+    }
+
+    // =========================
+    // Display functions
+    // =========================
+    // Register the class and create, decorate and show the window; messages go to the calling thread
+    static HWND _cgame_create_window(int w, int h, int flags) {
+        // --- Register window class ---
+        WNDCLASSW wc = {0};
+        wc.style         = CS_HREDRAW | CS_VREDRAW;
+        wc.lpfnWndProc   = _cgame_WndProc;
+        wc.hInstance     = _cgame_hInstance;
+        wc.hCursor       = LoadCursor(NULL, IDC_ARROW);
+        wc.lpszClassName = L"CGameWindowClass";
+        RegisterClassW(&wc);
+
+        // --- Window style ---
+        DWORD style = WS_OVERLAPPEDWINDOW;
+        if (!(flags & CGAME_RESIZABLE)) {
+            style &= ~WS_THICKFRAME;
+            style &= ~WS_MAXIMIZEBOX;
+        }
+
+        // --- Adjust rect for client size ---
+        RECT rect = {0, 0, w, h};
+        AdjustWindowRect(&rect, style, FALSE);
+        int adjWidth  = rect.right - rect.left;
+        int adjHeight = rect.bottom - rect.top;
+
+        // --- Create window ---
+        HWND hwnd = CreateWindowExW(
+            0,
+            wc.lpszClassName,
+            (_cgame_window_title[0] != L'\0') ? _cgame_window_title : L"CGame Window",
+            style,
+            CW_USEDEFAULT, CW_USEDEFAULT, adjWidth, adjHeight,
+            NULL, NULL, _cgame_hInstance, NULL
+        );
+
+        if (!hwnd) return NULL;
+
+        // --- Apply stored title (if set after creation, it still updates) ---
+        if (_cgame_window_title[0]) {
+            SetWindowTextW(hwnd, _cgame_window_title);
+        }
+
+        // --- Apply stored icon (if any) ---
+        if (_cgame_window_icon) {
+            SendMessage(hwnd, WM_SETICON, ICON_BIG,   (LPARAM)_cgame_window_icon);
+            SendMessage(hwnd, WM_SETICON, ICON_SMALL, (LPARAM)_cgame_window_icon);
+        }
+
+        ShowWindow(hwnd, SW_SHOW);
+        UpdateWindow(hwnd);
+        return hwnd;
+    }
 
-        wchar_t* wpath = (wchar_t*)malloc(len * sizeof(wchar_t));
-        if (!wpath) return img;
+    // =========================
+    // Event pump thread (CGAME_THREADED_EVENTS)
+    //  - The window is created on its own thread, which then just runs
+    //    GetMessage: drags, resizes and modal loops no longer stall
+    //    rendering, and input is timestamped when it arrives rather than
+    //    when the render loop gets round to pumping.
+    //  - The window procedure's events go through the inbox; everything
+    //    else (drawing, flip, input state) stays on the render thread.
+    // =========================
+    static HANDLE _cgame_pump_ready = NULL;
+    static HWND   _cgame_pump_hwnd = NULL;
+    static int    _cgame_pump_w, _cgame_pump_h, _cgame_pump_flags;
 
-        MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, len);
+    static DWORD WINAPI _cgame_pump_thread_proc(LPVOID param) {
+        (void)param;
+        _cgame_pump_hwnd = _cgame_create_window(_cgame_pump_w, _cgame_pump_h, _cgame_pump_flags);
+        SetEvent(_cgame_pump_ready);
+        if (!_cgame_pump_hwnd) return 1;
 
-        // Load the bitmap
-        Gdiplus::Bitmap* bmp = Gdiplus::Bitmap::FromFile(wpath, FALSE);
-        free(wpath);
+        MSG msg;
+        while (GetMessageW(&msg, NULL, 0, 0) > 0) {
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+        if (!_cgame_pump_quit_sent) { // the window went away without WM_CLOSE
+            CGameEvent ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.type    = CGAME_QUIT;
+            ev.time_us = _cgame_now_us();
+            _cgame_inbox_push(&ev, true);
+        }
+        return 0;
+    }
 
-        if (!bmp || bmp->GetLastStatus() != Gdiplus::Ok) {
-            if (bmp) delete bmp;
-            return img;
+    static HWND _cgame_pump_thread_start(int w, int h, int flags) {
+        _cgame_inbox_reset();
+        _cgame_render_thread = GetCurrentThreadId();
+        _cgame_inbox_enabled = true;
+
+        _cgame_pump_w = w; _cgame_pump_h = h; _cgame_pump_flags = flags;
+        _cgame_pump_hwnd  = NULL;
+        _cgame_pump_quit_sent = false;
+        _cgame_pump_ready = CreateEventW(NULL, TRUE, FALSE, NULL);
+        _cgame_pump_thread = _cgame_pump_ready ? CreateThread(NULL, 0, _cgame_pump_thread_proc, NULL, 0, NULL) : NULL;
+        if (_cgame_pump_thread) WaitForSingleObject(_cgame_pump_ready, INFINITE);
+        if (_cgame_pump_ready) CloseHandle(_cgame_pump_ready);
+        _cgame_pump_ready = NULL;
+
+        if (!_cgame_pump_hwnd) {
+            if (_cgame_pump_thread) {
+                WaitForSingleObject(_cgame_pump_thread, INFINITE);
+                CloseHandle(_cgame_pump_thread);
+                _cgame_pump_thread = NULL;
+            }
+            _cgame_inbox_enabled = false;
         }
+        return _cgame_pump_hwnd;
+    }
 
-        img.width  = bmp->GetWidth();
-        img.height = bmp->GetHeight();
-        img.channels = 4;
-        img.gdi_bitmap = bmp;
+    // Close the window from its own thread and wait for the pump to finish. No timeout: the
+    // pump never waits on the render thread, and releasing state under a live pump would race it.
+    static void _cgame_pump_thread_stop(void) {
+        if (!_cgame_pump_thread) return;
+        if (_cgame_pump_hwnd && IsWindow(_cgame_pump_hwnd)) PostMessageW(_cgame_pump_hwnd, WM_CLOSE, 0, 0);
+        WaitForSingleObject(_cgame_pump_thread, INFINITE);
+        CloseHandle(_cgame_pump_thread);
+        _cgame_pump_thread = NULL;
+        _cgame_pump_hwnd = NULL;
+        _cgame_inbox_enabled = false;
+    }
 
-        return img;
+    static CGameScreen _cgame_set_mode_impl(int w, int h, int flags) {
+        // --- Check conflicting GPU API flags ---
+        int gpu_api_count = (!!(flags & CGAME_OPENGL)) +
+                            (!!(flags & CGAME_VULKAN)) +
+                            (!!(flags & CGAME_D3D12));
+        if (gpu_api_count > 1) {
+            MessageBoxW(NULL,
+                L"Cannot combine multiple GPU APIs.\nChoose only one: OpenGL, Vulkan, or Direct3D 12.",
+                L"CGame Error",
+                MB_OK | MB_ICONERROR);
+            return _cgame_screen;
+        }
+
+        // --- Headless: backbuffer only, no window, no GPU API ---
+        if (flags & CGAME_HEADLESS) {
+            _cgame_free_backbuffer();
+            _cgame_screen.hwnd       = NULL;
+            _cgame_screen.hdc        = NULL;
+            _cgame_screen.headless   = true;
+            _cgame_screen.use_opengl = _cgame_screen.use_vulkan = _cgame_screen.use_d3d12 = false;
+            _cgame_screen.width      = w;
+            _cgame_screen.height     = h;
+            _cgame_make_backbuffer(w, h);
+            if (flags & CGAME_THREADED_EVENTS) {
+                // no OS messages to pump, but inject() from any thread is queued the same way
+                _cgame_inbox_reset();
+                _cgame_render_thread = GetCurrentThreadId();
+                _cgame_inbox_enabled = true;
+            }
+            return _cgame_screen;
+        }
+        _cgame_screen.headless = false;
+
+        if (flags & CGAME_DPI_AWARE) SetProcessDPIAware();
+
+        // --- Create the window, here or on the event pump thread ---
+        HWND hwnd;
+        bool threaded = (flags & CGAME_THREADED_EVENTS) && gpu_api_count == 0;
+        if (threaded) {
+            hwnd = _cgame_pump_thread_start(w, h, flags);
+        } else {
+            hwnd = _cgame_create_window(w, h, flags);
+        }
+        if (!hwnd) {
+            MessageBoxW(NULL, L"Failed to create window.", L"CGame Error", MB_OK | MB_ICONERROR);
+            return _cgame_screen;
+        }
+        _cgame_screen.hwnd = hwnd;
+
+        // --- Fill screen struct ---
+        _cgame_screen.use_opengl = (flags & CGAME_OPENGL) != 0;
+        _cgame_screen.use_vulkan = (flags & CGAME_VULKAN) != 0;
+        _cgame_screen.use_d3d12  = (flags & CGAME_D3D12) != 0;
+
+        _cgame_screen.vk_lib      = NULL;
+        _cgame_screen.vk_instance = NULL;
+        _cgame_screen.vk_device   = NULL;
+        _cgame_screen.vk_surface  = NULL;
+        _cgame_screen.vk_swapchain= NULL;
+
+        _cgame_screen.d3d12_lib   = NULL;
+        _cgame_screen.d3d12_device    = NULL;
+        _cgame_screen.d3d12_cmdqueue  = NULL;
+        _cgame_screen.d3d12_swapchain = NULL;
+
+        // --- Get actual client area size ---
+        RECT clientRect;
+        GetClientRect(hwnd, &clientRect);
+        _cgame_screen.width  = clientRect.right - clientRect.left;
+        _cgame_screen.height = clientRect.bottom - clientRect.top;
+
+        // --- Choose API ---
+        if (_cgame_screen.use_opengl) {
+            if (!_cgame_init_opengl(hwnd, &_cgame_screen.hdc, &_cgame_screen.hglrc)) {
+                DestroyWindow(hwnd);
+                _cgame_screen.hwnd = NULL;
+            }
+        } else if (_cgame_screen.use_vulkan) {
+            if (!_cgame_init_vulkan(hwnd, &_cgame_screen.vk_lib)) {
+                DestroyWindow(hwnd);
+                _cgame_screen.hwnd = NULL;
+            } else {
+                _cgame_screen.hdc = NULL; // Vulkan doesn’t use GDI
+            }
+        } else if (_cgame_screen.use_d3d12) {
+            if (!_cgame_init_d3d12(hwnd, &_cgame_screen.d3d12_lib)) {
+                DestroyWindow(hwnd);
+                _cgame_screen.hwnd = NULL;
+            } else {
+                _cgame_screen.hdc = NULL; // D3D12 doesn’t use GDI
+            }
+        } else {
+            // CPU/GDI backbuffer
+            _cgame_screen.hdc = GetDC(hwnd);
+            _cgame_make_backbuffer(_cgame_screen.width, _cgame_screen.height);
+        }
+
+        return _cgame_screen;
     }
 
-    // Free image
-    static void _cgame_image_unload_impl(CGameImage* img) {
-        if (!img) return;
-        _cgame_image_free_impl(img);
+
+
+    static void _cgame_display_set_bgcolor(int r, int g, int b) {
+        _cgame_rt->bgcolor = RGB(r,g,b);
+        if (_cgame_rt->memdc) {
+            _cgame_fill_dc(_cgame_rt->memdc, _cgame_rt->memw, _cgame_rt->memh, _cgame_rt->bgcolor);
+        }
+        /* For OpenGL/Vulkan (no backbuffer) the bg color is only stored,
+           but clearing should be done by the user's rendering code (glClear / vkCmdClearAttachments). */
     }
 
-    // Create nearest-neighbour resized copy
-    static CGameImage _cgame_image_resize_nearest(const CGameImage* src, int new_w, int new_h) {
-        CGameImage out = {0, 0, 0, NULL, NULL};
-        if (!src || !src->gdi_bitmap) return out;
+    static void _cgame_display_clear_impl(void) {
+        CGAME_ZONE("display.clear");
+        if (_cgame_rt->memdc) {
+            _cgame_fill_dc(_cgame_rt->memdc, _cgame_rt->memw, _cgame_rt->memh, _cgame_rt->bgcolor);
+            _cgame_stat_prim(CGAME_PRIM_CLEAR, 0, 0, _cgame_rt->memw, _cgame_rt->memh, -1);
+            _cgame_overdraw_rect(CGAME_PRIM_CLEAR, 0, 0, _cgame_rt->memw, _cgame_rt->memh);
+        }
+        /* For OpenGL/Vulkan the user should call their own clear/present */
+    }
 
-        Gdiplus::Bitmap* target = new Gdiplus::Bitmap(new_w, new_h, PixelFormat32bppPARGB);
-        Gdiplus::Graphics g(target);
-        g.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor);
-        g.DrawImage(src->gdi_bitmap, Gdiplus::Rect(0, 0, new_w, new_h));
+    static void _cgame_display_flip_impl(void) {
+        _cgame_prof_frame();
+        CGAME_ZONE("display.flip");
+        _cgame_frame_index++;
+        _cgame_stats_frame();
+        _cgame_arena_reset_impl();                   // this thread's arena; workers fold on the epoch
+        InterlockedIncrement(&_cgame_arena_epoch);
+        CGameContext* bound = _cgame_rt;
+        _cgame_rt = &_cgame_screen_rt;   // the overlays belong on the screen, whatever this thread has bound
+        if (_cgame_overdraw_on) _cgame_overdraw_present();
+        if (_cgame_hud_on) _cgame_hud_draw();
+        _cgame_rt = bound;
+        if (!_cgame_screen.hwnd) return;
 
-        out.width = new_w;
-        out.height = new_h;
-        out.channels = 4;
-        out.gdi_bitmap = target;
-        return out;
+        if (_cgame_screen.use_opengl) {
+            SwapBuffers(_cgame_screen.hdc);
+        } else if (_cgame_screen.use_vulkan) {
+            /* For Vulkan mode, the user must call vkQueuePresentKHR / present their swapchain.
+               This library only performs runtime detection and provides placeholders. */
+        } else {
+            HDC wnddc = GetDC(_cgame_screen.hwnd);
+            if (wnddc && _cgame_screen_rt.memdc) {
+                BitBlt(wnddc, 0, 0, _cgame_screen.width, _cgame_screen.height, _cgame_screen_rt.memdc, 0, 0, SRCCOPY);
+            }
+            if (wnddc) ReleaseDC(_cgame_screen.hwnd, wnddc);
+        }
     }
 
-    // Flip horizontal (in-place)
-    static CGameImage _cgame_image_flip_horizontal_impl(const CGameImage* src)
-    {
-        CGameImage out = {0, 0, 0, NULL, NULL};
-        if (!src || !src->gdi_bitmap) return out;
+    // Size of the window, or of the offscreen context bound to this thread
+    static int _cgame_display_get_width(void) { return _cgame_rt == &_cgame_screen_rt ? _cgame_screen.width : _cgame_rt->memw; }
+    static int _cgame_display_get_height(void) { return _cgame_rt == &_cgame_screen_rt ? _cgame_screen.height : _cgame_rt->memh; }
+
+    // Backbuffer pixels (BGRX, top-down, stride = width * 4) once pending GDI work has landed;
+    // NULL in GPU modes. Valid until the next set_mode or resize.
+    static const unsigned char* _cgame_display_get_pixels(int* w, int* h) {
+        if (w) *w = _cgame_rt->membits ? _cgame_rt->memw : 0;
+        if (h) *h = _cgame_rt->membits ? _cgame_rt->memh : 0;
+        if (!_cgame_rt->membits) return NULL;
+        GdiFlush();
+        return _cgame_rt->membits;
+    }
 
-        int w = src->width;
-        int h = src->height;
+    // =========================
+    // Offscreen contexts (cgame.context)
+    //  - A context is a render target of its own: DIB section, DC,
+    //    background colour, glyph atlases and text layouts. Nothing in it
+    //    is shared, so contexts bound on different threads render at the
+    //    same time without locks.
+    //  - Every draw, text and display.clear/get_pixels call goes to the
+    //    calling thread's bound context; NULL rebinds the window (or
+    //    headless) backbuffer. A context is bound on one thread at a time,
+    //    and a thread that exits with one bound releases it.
+    //  - Offscreen drawing skips the frame counters, HUD and overdraw
+    //    heatmap; the profiler records zones per thread as usual.
+    //  - Still shared and not safe to use from two threads at once:
+    //    one CGameImage or CGameTTF, cgame.cache and text.load_font.
+    // =========================
+    static CGameContext* _cgame_context_create_impl(int w, int h) {
+        if (w <= 0 || h <= 0) return NULL;
+        CGameContext* ctx = (CGameContext*)_cgame_calloc(1, sizeof(CGameContext));
+        if (!ctx) return NULL;
+        ctx->bgcolor = RGB(0,0,0);
+        if (!_cgame_rt_alloc(ctx, NULL, w, h)) {
+            free(ctx);
+            return NULL;
+        }
+        return ctx;
+    }
 
-        Gdiplus::Bitmap* target = new Gdiplus::Bitmap(w, h, PixelFormat32bppPARGB);
-        Gdiplus::Graphics g(target);
-        g.SetCompositingMode(Gdiplus::CompositingModeSourceOver);
-        g.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor);
+    // Binds ctx on the calling thread (NULL: back to the screen); false when another thread has it bound
+    static bool _cgame_context_make_current_impl(CGameContext* ctx) {
+        LONG tid = (LONG)GetCurrentThreadId();
+        if (ctx) {
+            LONG prev = InterlockedCompareExchange(&ctx->owner, tid, 0);
+            if (prev != 0 && prev != tid) return false;
+        }
+        if (_cgame_rt != &_cgame_screen_rt && _cgame_rt != ctx) InterlockedExchange(&_cgame_rt->owner, 0);
+        _cgame_rt = ctx ? ctx : &_cgame_screen_rt;
+        _cgame_rt_binding.ctx = ctx;
+        return true;
+    }
 
-        // Flip horizontally using a negative X scale
-        Gdiplus::Matrix m;
-        m.Scale(-1.f, 1.f);
-        m.Translate((Gdiplus::REAL)-w, 0.f);
-        g.SetTransform(&m);
+    // Bound context of the calling thread, NULL when it draws to the screen
+    static CGameContext* _cgame_context_current_impl(void) {
+        return _cgame_rt == &_cgame_screen_rt ? NULL : _cgame_rt;
+    }
 
-        g.DrawImage(src->gdi_bitmap, 0, 0, w, h);
-        g.ResetTransform();
+    // Unbind it first when it is current on another thread
+    static void _cgame_context_destroy_impl(CGameContext* ctx) {
+        if (!ctx) return;
+        if (_cgame_rt == ctx) _cgame_rt = &_cgame_screen_rt;
+        if (_cgame_rt_binding.ctx == ctx) _cgame_rt_binding.ctx = NULL;
+        _cgame_font_cache_free_all(ctx);
+        _cgame_rt_release(ctx);
+        free(ctx);
+    }
 
-        out.width = w;
-        out.height = h;
-        out.channels = 4;
-        out.gdi_bitmap = target;
-        return out;
+    // =========================
+    // Drawing
+    // =========================
+    static void _cgame_draw_fillrect_impl(int x, int y, int w, int h, int r, int g, int b) {
+        CGAME_ZONE("draw.fill_rect");
+        if (!_cgame_rt->memdc) return;
+        HBRUSH brush = CreateSolidBrush(RGB(r,g,b));
+        RECT rc = { x, y, x + w, y + h };
+        FillRect(_cgame_rt->memdc, &rc, brush);
+        DeleteObject(brush);
+        _cgame_stat_prim(CGAME_PRIM_FILL_RECT, x, y, w, h, -1);
+        _cgame_overdraw_rect(CGAME_PRIM_FILL_RECT, x, y, w, h);
     }
+    static void _cgame_draw_rect_impl(int x, int y, int w, int h, int border_width, int r, int g, int b) {
+        CGAME_ZONE("draw.rect");
+        if (!_cgame_rt->memdc) return;
 
-    static CGameImage _cgame_image_flip_vertical_impl(const CGameImage* src)
-    {
-        CGameImage out = {0, 0, 0, NULL, NULL};
-        if (!src || !src->gdi_bitmap) return out;
+        // Create a pen with custom thickness
+        HPEN pen = CreatePen(PS_SOLID, border_width, RGB(r, g, b));
+        HGDIOBJ oldPen = SelectObject(_cgame_rt->memdc, pen);
+        HGDIOBJ oldBrush = SelectObject(_cgame_rt->memdc, GetStockObject(NULL_BRUSH));
 
-        int w = src->width;
-        int h = src->height;
+        // Draw rectangle
+        Rectangle(_cgame_rt->memdc, x, y, x + w, y + h);
+
+        // Restore old objects
+        SelectObject(_cgame_rt->memdc, oldPen);
+        SelectObject(_cgame_rt->memdc, oldBrush);
+        DeleteObject(pen);
+        _cgame_stat_prim(CGAME_PRIM_RECT, x, y, w, h, _cgame_stat_outline(2.0 * (w + h), border_width, w, h));
+        if (_cgame_overdraw_begin()) {
+            _cgame_draw_rect_impl(x, y, w, h, border_width, 255, 255, 255);
+            _cgame_overdraw_end(CGAME_PRIM_RECT, x - border_width, y - border_width, w + 2 * border_width, h + 2 * border_width);
+        }
+    }
 
-        Gdiplus::Bitmap* target = new Gdiplus::Bitmap(w, h, PixelFormat32bppPARGB);
-        Gdiplus::Graphics g(target);
-        g.SetCompositingMode(Gdiplus::CompositingModeSourceOver);
-        g.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor);
 
+    // =========================
+    // Polygon drawing
+    // =========================
+    static void _cgame_draw_polygon_impl(const int* xs, const int* ys, int count,
+                                        int border_width, int r, int g, int b) {
+        CGAME_ZONE("draw.polygon");
+        if (!_cgame_rt->memdc || !xs || !ys || count < 2) return;
 
-        // Flip vertically using a negative Y scale
-        Gdiplus::Matrix m;
-        m.Scale(1.f, -1.f);
-        m.Translate(0.f, (Gdiplus::REAL)-h);
-        g.SetTransform(&m);
+        Gdiplus::Graphics gdi(_cgame_rt->memdc);
+        gdi.SetSmoothingMode(Gdiplus::SmoothingModeHighQuality); // optional, for smooth edges
 
-        g.DrawImage(src->gdi_bitmap, 0, 0, w, h);
-        g.ResetTransform();
+        Pen pen(Gdiplus::Color(255, r, g, b), (REAL)border_width);
 
-        out.width = w;
-        out.height = h;
-        out.channels = 4;
-        out.gdi_bitmap = target;
-        return out;
+        CGameArenaMark mark = _cgame_arena_mark();
+        Point* pts = (Point*)_cgame_arena_alloc(sizeof(Point) * count);
+        if (pts) {
+            for (int i = 0; i < count; i++) {
+                pts[i] = Point(xs[i], ys[i]);
+            }
+            gdi.DrawPolygon(&pen, pts, count);
+        }
+        _cgame_arena_release(&mark);
+        if (_cgame_stats_on) {
+            int bx, by, bw, bh;
+            double perimeter = 0;
+            for (int i = 0; i < count; i++) {
+                int j = (i + 1) % count;
+                perimeter += sqrt((double)(xs[j] - xs[i]) * (xs[j] - xs[i]) + (double)(ys[j] - ys[i]) * (ys[j] - ys[i]));
+            }
+            _cgame_stat_bounds(xs, ys, count, &bx, &by, &bw, &bh);
+            _cgame_stat_prim(CGAME_PRIM_POLYGON, bx, by, bw, bh, _cgame_stat_outline(perimeter, border_width, bw, bh));
+        }
+        if (_cgame_overdraw_begin()) {
+            int bx, by, bw, bh, m = border_width + 2; // half the pen plus antialiasing, with room for miters
+            _cgame_draw_polygon_impl(xs, ys, count, border_width, 255, 255, 255);
+            _cgame_stat_bounds(xs, ys, count, &bx, &by, &bw, &bh);
+            _cgame_overdraw_end(CGAME_PRIM_POLYGON, bx - m, by - m, bw + 2 * m, bh + 2 * m);
+        }
+    }
+
+    static void _cgame_draw_fill_polygon_impl(const int* xs, const int* ys, int count,
+                                              int r, int g, int b) {
+        CGAME_ZONE("draw.fill_polygon");
+        if (!_cgame_rt->memdc || !xs || !ys || count < 3) return;
+        Gdiplus::Graphics gdi(_cgame_rt->memdc);
+        Gdiplus::SolidBrush brush(Gdiplus::Color(255, r, g, b));
+
+        CGameArenaMark mark = _cgame_arena_mark();
+        Point* pts = (Point*)_cgame_arena_alloc(sizeof(Point) * count);
+        if (pts) {
+            for (int i = 0; i < count; i++) pts[i] = Point(xs[i], ys[i]);
+            gdi.FillPolygon(&brush, pts, count);
+        }
+        _cgame_arena_release(&mark);
+        if (_cgame_stats_on) {
+            int bx, by, bw, bh;
+            double twice = 0; // shoelace
+            for (int i = 0; i < count; i++) {
+                int j = (i + 1) % count;
+                twice += (double)xs[i] * ys[j] - (double)xs[j] * ys[i];
+            }
+            _cgame_stat_bounds(xs, ys, count, &bx, &by, &bw, &bh);
+            _cgame_stat_prim(CGAME_PRIM_FILL_POLYGON, bx, by, bw, bh, fabs(twice) / 2);
+        }
+        if (_cgame_overdraw_begin()) {
+            int bx, by, bw, bh;
+            _cgame_draw_fill_polygon_impl(xs, ys, count, 255, 255, 255);
+            _cgame_stat_bounds(xs, ys, count, &bx, &by, &bw, &bh);
+            _cgame_overdraw_end(CGAME_PRIM_FILL_POLYGON, bx - 1, by - 1, bw + 2, bh + 2);
+        }
+    }
+
+    // =========================
+    // Rounded rectangle drawing
+    // =========================
+    static void _cgame_build_rounded_rect_path(GraphicsPath* path, int x, int y, int w, int h, int radius) {
+        int diameter = radius * 2;
+        if (diameter > w) diameter = w;
+        if (diameter > h) diameter = h;
+
+        path->AddArc(x, y, diameter, diameter, 180, 90);
+        path->AddArc(x + w - diameter, y, diameter, diameter, 270, 90);
+        path->AddArc(x + w - diameter, y + h - diameter, diameter, diameter, 0, 90);
+        path->AddArc(x, y + h - diameter, diameter, diameter, 90, 90);
+        path->CloseFigure();
+    }
+
+    static void _cgame_draw_rounded_rect_impl(int x, int y, int w, int h, int radius,
+                                              int border_width, int r, int g, int b) {
+        CGAME_ZONE("draw.rounded_rect");
+        if (!_cgame_rt->memdc) return;
+        Gdiplus::Graphics gdi(_cgame_rt->memdc);
+        Pen pen(Gdiplus::Color(255, r, g, b), (REAL)border_width);
+        GraphicsPath path;
+        _cgame_build_rounded_rect_path(&path, x, y, w, h, radius);
+        gdi.DrawPath(&pen, &path);
+        double c = _cgame_stat_corner(w, h, radius);
+        _cgame_stat_prim(CGAME_PRIM_ROUNDED_RECT, x, y, w, h,
+                         _cgame_stat_outline(2.0 * (w + h) - (8 - 2 * M_PI) * c, border_width, w, h));
+        if (_cgame_overdraw_begin()) {
+            int m = border_width + 2;
+            _cgame_draw_rounded_rect_impl(x, y, w, h, radius, border_width, 255, 255, 255);
+            _cgame_overdraw_end(CGAME_PRIM_ROUNDED_RECT, x - m, y - m, w + 2 * m, h + 2 * m);
+        }
+    }
+
+    static void _cgame_draw_rounded_fill_rect_impl(int x, int y, int w, int h, int radius,
+                                                   int r, int g, int b) {
+        CGAME_ZONE("draw.rounded_fill_rect");
+        if (!_cgame_rt->memdc) return;
+        Gdiplus::Graphics gdi(_cgame_rt->memdc);
+        Gdiplus::SolidBrush brush(Gdiplus::Color(255, r, g, b));
+        GraphicsPath path;
+        _cgame_build_rounded_rect_path(&path, x, y, w, h, radius);
+        gdi.FillPath(&brush, &path);
+        double c = _cgame_stat_corner(w, h, radius);
+        _cgame_stat_prim(CGAME_PRIM_ROUNDED_FILL_RECT, x, y, w, h, (double)w * h - (4 - M_PI) * c * c);
+        if (_cgame_overdraw_begin()) {
+            _cgame_draw_rounded_fill_rect_impl(x, y, w, h, radius, 255, 255, 255);
+            _cgame_overdraw_end(CGAME_PRIM_ROUNDED_FILL_RECT, x - 1, y - 1, w + 2, h + 2);
+        }
+    }
+
+    // =========================
+    // Circle drawing (outline)
+    // =========================
+    static void _cgame_draw_circle_impl(int x, int y, int radius, int border_width, int r, int g, int b) {
+        CGAME_ZONE("draw.circle");
+        if (!_cgame_rt->memdc) return;
+
+        Gdiplus::Graphics gdi(_cgame_rt->memdc);
+        Pen pen(Gdiplus::Color(255, r, g, b), (REAL)border_width);
+
+        // GDI+ draws ellipse from bounding box
+        int diameter = radius * 2;
+        gdi.DrawEllipse(&pen, x - radius, y - radius, diameter, diameter);
+        _cgame_stat_prim(CGAME_PRIM_CIRCLE, x - radius, y - radius, diameter, diameter,
+                         _cgame_stat_outline(2 * M_PI * radius, border_width, diameter, diameter));
+        if (_cgame_overdraw_begin()) {
+            int m = border_width + 2;
+            _cgame_draw_circle_impl(x, y, radius, border_width, 255, 255, 255);
+            _cgame_overdraw_end(CGAME_PRIM_CIRCLE, x - radius - m, y - radius - m, diameter + 2 * m, diameter + 2 * m);
+        }
+    }
+
+    // =========================
+    // Filled circle drawing
+    // =========================
+    static void _cgame_draw_fill_circle_impl(int x, int y, int radius, int r, int g, int b) {
+        CGAME_ZONE("draw.fill_circle");
+        if (!_cgame_rt->memdc) return;
+
+        Gdiplus::Graphics gdi(_cgame_rt->memdc);
+        Gdiplus::SolidBrush brush(Gdiplus::Color(255, r, g, b));
+
+        int diameter = radius * 2;
+        gdi.FillEllipse(&brush, x - radius, y - radius, diameter, diameter);
+        _cgame_stat_prim(CGAME_PRIM_FILL_CIRCLE, x - radius, y - radius, diameter, diameter, M_PI * radius * radius);
+        if (_cgame_overdraw_begin()) {
+            _cgame_draw_fill_circle_impl(x, y, radius, 255, 255, 255);
+            _cgame_overdraw_end(CGAME_PRIM_FILL_CIRCLE, x - radius - 1, y - radius - 1, diameter + 2, diameter + 2);
+        }
     }
 
 
-    // Draw image at (x,y). If image has HBITMAP, use AlphaBlend with compatible DC.
-    static void _cgame_image_draw_impl(const CGameImage* img, int x, int y) {
-        if (!img || !img->gdi_bitmap) return;
 
-        HDC hdc = _cgame_memdc;
-        Gdiplus::Graphics g(hdc);
-        g.SetCompositingMode(Gdiplus::CompositingModeSourceOver);
-        g.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor);
+    // =========================
+    // Input recording and replay
+    //  - record.start captures every submitted event (type, key, button,
+    //    position, wheel, frame index, time) until record.stop writes it.
+    //  - replay.start feeds a recording back through the same submission
+    //    path, frame by frame, in place of live keyboard/mouse input, so
+    //    event.*, key.* and mouse.* see the identical stream every run.
+    //    Works with CGAME_HEADLESS for unattended benchmark runs.
+    // =========================
+    #define CGAME_INPUT_MAGIC    0x52494743u  // "CGIR"
+    #define CGAME_INPUT_VERSION  2   // 2: wheel in 1/120 notches, horizontal wheel, raw motion
+
+    typedef struct {
+        unsigned int magic;
+        unsigned int version;
+        unsigned int count;
+        unsigned int record_size;
+    } CGameInputFileHeader;
+
+    static wchar_t* _cgame_rec_path = NULL;
+
+    static bool _cgame_record_start_impl(const char* path) {
+        if (!path) return false;
+        wchar_t* wpath = _cgame_utf8_to_wide_alloc(path);
+        if (!wpath) return false;
+        free(_cgame_rec_path);
+        _cgame_rec_path   = wpath;
+        _cgame_rec_count  = 0;
+        _cgame_rec_frame0 = _cgame_frame_index;
+        _cgame_rec_time0  = _cgame_now_us();
+        _cgame_recording  = true;
+        return true;
+    }
+
+    // Stop and write the file; false if nothing was recording or the write failed
+    static bool _cgame_record_stop_impl(void) {
+        if (!_cgame_recording) return false;
+        _cgame_recording = false;
+
+        bool ok = false;
+        HANDLE file = CreateFileW(_cgame_rec_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file != INVALID_HANDLE_VALUE) {
+            CGameInputFileHeader hdr = { CGAME_INPUT_MAGIC, CGAME_INPUT_VERSION,
+                                         (unsigned int)_cgame_rec_count, (unsigned int)sizeof(CGameInputRecord) };
+            DWORD body = (DWORD)(sizeof(CGameInputRecord) * (size_t)_cgame_rec_count), written = 0;
+            ok = WriteFile(file, &hdr, sizeof(hdr), &written, NULL) && written == sizeof(hdr);
+            if (ok && body) ok = WriteFile(file, _cgame_rec_items, body, &written, NULL) && written == body;
+            CloseHandle(file);
+        }
 
-        g.SetSmoothingMode(Gdiplus::SmoothingModeHighQuality);
+        free(_cgame_rec_items);
+        free(_cgame_rec_path);
+        _cgame_rec_items = NULL;
+        _cgame_rec_path  = NULL;
+        _cgame_rec_count = _cgame_rec_cap = 0;
+        return ok;
+    }
 
-        g.DrawImage(img->gdi_bitmap, (Gdiplus::REAL)x, (Gdiplus::REAL)y, 
-                    (Gdiplus::REAL)img->width, (Gdiplus::REAL)img->height);
+    static void _cgame_replay_stop_impl(void) {
+        free(_cgame_replay_items);
+        _cgame_replay_items = NULL;
+        _cgame_replay_count = _cgame_replay_pos = 0;
     }
 
+    static bool _cgame_replay_start_impl(const char* path) {
+        if (!path) return false;
+        wchar_t* wpath = _cgame_utf8_to_wide_alloc(path);
+        if (!wpath) return false;
+        HANDLE file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        free(wpath);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        CGameInputFileHeader hdr;
+        DWORD got = 0;
+        CGameInputRecord* items = NULL;
+        bool ok = ReadFile(file, &hdr, sizeof(hdr), &got, NULL) && got == sizeof(hdr) &&
+                  hdr.magic == CGAME_INPUT_MAGIC && hdr.version == CGAME_INPUT_VERSION &&
+                  hdr.record_size == sizeof(CGameInputRecord) && hdr.count < (1u << 24);
+        if (ok && hdr.count) {
+            DWORD body = (DWORD)(sizeof(CGameInputRecord) * (size_t)hdr.count);
+            items = (CGameInputRecord*)_cgame_malloc(body);
+            ok = items && ReadFile(file, items, body, &got, NULL) && got == body;
+        }
+        CloseHandle(file);
+        if (!ok) { free(items); return false; }
+
+        _cgame_replay_stop_impl();
+        _cgame_replay_items  = items ? items : (CGameInputRecord*)_cgame_malloc(sizeof(CGameInputRecord));
+        _cgame_replay_count  = (int)hdr.count;
+        _cgame_replay_pos    = 0;
+        _cgame_replay_frame0 = _cgame_frame_index;
+        _cgame_replay_time0  = _cgame_now_us();
+        return _cgame_replay_items != NULL;
+    }
 
-    static void _cgame_image_draw_rotated_impl(const CGameImage* img, int x, int y, float angle_deg)
-    {
-        if (!img || !img->gdi_bitmap || !_cgame_memdc) return;
+    // Submit every record due by the current frame; the replay ends after the last one
+    static void _cgame_replay_feed(void) {
+        unsigned long long frame = _cgame_frame_index - _cgame_replay_frame0;
+        while (_cgame_replay_pos < _cgame_replay_count && _cgame_replay_items[_cgame_replay_pos].frame <= frame) {
+            const CGameInputRecord* r = &_cgame_replay_items[_cgame_replay_pos++];
+            CGameEvent ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.type    = r->type;
+            ev.key     = r->key;
+            ev.button  = r->button;
+            ev.wheel   = r->wheel;
+            ev.wheel_x = r->wheel_x;
+            ev.time_us = _cgame_replay_time0 + r->time_us;
+            if (r->type == CGAME_VIDEORESIZE)   { ev.width = r->x; ev.height = r->y; }
+            else if (r->type == CGAME_MOUSERAW) { ev.dx = r->x;    ev.dy = r->y; }
+            else                                { ev.x = r->x;     ev.y = r->y; }  // buttons and wheels move the cursor in submit
+            _cgame_event_submit(&ev, false);
+        }
+        if (_cgame_replay_pos >= _cgame_replay_count) _cgame_replay_stop_impl();
+    }
 
-        const int src_w = img->width;
-        const int src_h = img->height;
+    static bool _cgame_replay_active_impl(void) { return _cgame_replay_items != NULL; }
 
-        // --- Compute expanded bounding box ---
-        double radians = angle_deg * 3.14159265358979323846 / 180.0;
-        double cosA = fabs(cos(radians));
-        double sinA = fabs(sin(radians));
+    // =========================
+    // Events
+    // =========================
+    // Dispatch every pending window message; each one lands in the event ring
+    static void _cgame_event_pump(void) {
+        CGAME_ZONE("event.pump");
+        MSG msg;
+        while (PeekMessageW(&msg, NULL, 0, 0, PM_REMOVE)) {
+            if (msg.message == WM_QUIT) {
+                if (_cgame_running) _cgame_event_os(CGAME_QUIT, 0); // WM_CLOSE already queued one
+                continue;
+            }
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+        if (_cgame_inbox_enabled) {
+            CGameEvent ev;
+            bool live;
+            while (_cgame_inbox_pop(&ev, &live)) _cgame_event_submit(&ev, live);
+        }
+        if (_cgame_replay_items) _cgame_replay_feed();
+        if (_cgame_input_frame != _cgame_frame_index) {
+            _cgame_input_frame = _cgame_frame_index;
+            _cgame_input_snapshot();
+        }
+    }
 
-        int new_w = int(src_w * cosA + src_h * sinA + 0.5);
-        int new_h = int(src_w * sinA + src_h * cosA + 0.5);
+    // Pump when the queue is empty, and always on the first call of a new frame
+    static void _cgame_event_update(void) {
+        if (_cgame_event_head == _cgame_event_tail || _cgame_input_frame != _cgame_frame_index)
+            _cgame_event_pump();
+    }
 
-        // --- Create an offscreen ARGB bitmap big enough for the rotated image ---
-        Gdiplus::Bitmap target(new_w, new_h, PixelFormat32bppPARGB);
-        Gdiplus::Graphics g(&target);
-        g.SetCompositingMode(Gdiplus::CompositingModeSourceOver);
-        g.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
-        g.SetSmoothingMode(Gdiplus::SmoothingModeHighQuality);
-        g.Clear(Gdiplus::Color(0, 0, 0, 0));
+    static bool _cgame_event_pop(CGameEvent* out) {
+        if (_cgame_event_head == _cgame_event_tail) return false;
+        const CGameEvent* ev = &_cgame_events[_cgame_event_head++ & (CGAME_EVENT_QUEUE_SIZE - 1)];
+        if (ev->type == CGAME_KEYDOWN || ev->type == CGAME_KEYUP) _cgame_last_key = (WPARAM)ev->key;
+        if (out) *out = *ev;
+        return true;
+    }
 
-        // --- Rotate around center of the new canvas ---
-        g.TranslateTransform((Gdiplus::REAL)new_w / 2.0f, (Gdiplus::REAL)new_h / 2.0f);
-        g.RotateTransform((Gdiplus::REAL)angle_deg);
-        g.TranslateTransform(-(Gdiplus::REAL)src_w / 2.0f, -(Gdiplus::REAL)src_h / 2.0f);
-        g.DrawImage(img->gdi_bitmap, 0, 0, src_w, src_h);
-        g.ResetTransform();
+    // Next event type, 0 when the queue is empty (payload: key.get_last, or use event.poll)
+    static int _cgame_event_get(void) {
+        CGAME_ZONE("event.get");
+        CGameEvent ev;
+        _cgame_event_update();
+        return _cgame_event_pop(&ev) ? ev.type : 0;
+    }
 
-        // --- Now blend this rotated result directly to the main memory DC ---
-        Gdiplus::Graphics gscreen(_cgame_memdc);
-        gscreen.SetCompositingMode(Gdiplus::CompositingModeSourceOver);
-        gscreen.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
-        gscreen.DrawImage(&target, x - new_w / 2, y - new_h / 2, new_w, new_h);
+    // Next full event record; false when the queue is empty
+    static bool _cgame_event_poll(CGameEvent* ev) {
+        CGAME_ZONE("event.poll");
+        _cgame_event_update();
+        return _cgame_event_pop(ev);
     }
 
-    static CGameImage _cgame_image_rotate_impl(const CGameImage* src, float angle) {
-        CGameImage out = {0, 0, 0, NULL, NULL};
-        if (!src || !src->gdi_bitmap) return out;
+    // Copy up to max queued events into out in arrival order; returns how many
+    static int _cgame_event_drain(CGameEvent* out, int max) {
+        CGAME_ZONE("event.drain");
+        _cgame_event_pump();
+        int n = 0;
+        while (n < max && _cgame_event_pop(out ? &out[n] : NULL)) n++;
+        return n;
+    }
 
-        double radians = angle * M_PI / 180.0;
-        double cosA = fabs(cos(radians));
-        double sinA = fabs(sin(radians));
-        int new_w = int(src->width * cosA + src->height * sinA + 0.5);
-        int new_h = int(src->width * sinA + src->height * cosA + 0.5);
+    // Synthetic event, handled exactly like one from the OS: key/mouse state, cursor,
+    // wheel, quit and resize (the backbuffer; a window keeps its size) all update,
+    // then it is recorded and queued. time_us == 0 stamps the current time. Buttons and
+    // wheels happen at x/y, moving the cursor there first as the OS path does.
+    static void _cgame_event_inject_impl(const CGameEvent* ev) {
+        if (!ev || ev->type <= 0) return;
+        CGameEvent e = *ev;
+        if (e.type == CGAME_VIDEORESIZE && (e.width <= 0 || e.height <= 0)) return;
+        if (!e.time_us) e.time_us = _cgame_now_us();
+        _cgame_event_submit(&e, false);
+    }
 
-        Gdiplus::Bitmap target(new_w, new_h, PixelFormat32bppPARGB);
-        Gdiplus::Graphics g(&target);
-        g.SetCompositingMode(Gdiplus::CompositingModeSourceOver);
-        g.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
-        g.SetSmoothingMode(Gdiplus::SmoothingModeHighQuality);
-        g.Clear(Gdiplus::Color(0, 0, 0, 0));
+    // Events lost to a full queue since the last call
+    static int _cgame_event_dropped_impl(void) {
+        int n = (int)_cgame_event_dropped + (int)InterlockedExchange(&_cgame_inbox_dropped, 0);
+        _cgame_event_dropped = 0;
+        return n;
+    }
 
-        g.TranslateTransform((Gdiplus::REAL)new_w / 2.0f, (Gdiplus::REAL)new_h / 2.0f);
-        g.RotateTransform((Gdiplus::REAL)angle);
-        g.TranslateTransform(-(Gdiplus::REAL)src->width / 2.0f, -(Gdiplus::REAL)src->height / 2.0f);
-        g.DrawImage(src->gdi_bitmap, 0, 0, src->width, src->height);
-        g.ResetTransform();
+    // =========================
+    // Text rendering
+    //  - Glyphs are rasterized once per (font, pixel size) with
+    //    GetGlyphOutlineW into an 8-bit coverage atlas, then text is
+    //    drawn as tinted glyph blits straight into the backbuffer.
+    //  - Kerning pairs come from the font and are applied per pair.
+    // =========================
+    #define CGAME_TEXT_MAX_FONTS    16
+    #define CGAME_TEXT_DEFAULT_FONT L"Arial"
+    #define CGAME_TEXT_DEFAULT_PX   21     // 16pt at 96 DPI, what Font(L"Arial", 16) used to draw
 
-        _cgame_image_from_gdiplus_bitmap(&target, &out);
-        return out;
+    typedef struct {
+        wchar_t*           family;      // full name as requested, heap copy
+        int                px;
+        unsigned long long id;          // unique within its set, keys cached layouts
+        bool               substituted; // GDI had no such face and picked another
+        int                ascent, descent, line_height;
+        HDC                dc;          // owns hfont, used to rasterize misses
+        HFONT              hfont;
+        HGDIOBJ            old_font;
+        CGameAtlas         atlas;
+        CGameGlyph         latin[256];  // U+0000..U+00FF, direct lookup
+        unsigned int*      ext_keys;    // open addressing for the rest of the BMP
+        CGameGlyph*        ext_glyphs;
+        int                ext_cap, ext_count;
+        unsigned int*      kern_keys;   // (first << 16 | second), sorted
+        short*             kern_amounts;
+        int                kern_count;
+        unsigned long long last_used;
+    } CGameFontCache;
+
+    // One set per render target, so contexts on different threads never share a cache
+    typedef struct CGameFontCaches {
+        CGameFontCache*    caches[CGAME_TEXT_MAX_FONTS];
+        int                count;
+        unsigned long long clock;
+        unsigned long long next_id;
+    } CGameFontCaches;
+
+    static CGameFontCaches* _cgame_font_caches(void) {
+        if (!_cgame_rt->fonts) _cgame_rt->fonts = (CGameFontCaches*)_cgame_calloc(1, sizeof(CGameFontCaches));
+        return _cgame_rt->fonts;
     }
 
+    static void _cgame_font_cache_free(CGameFontCache* fc) {
+        if (!fc) return;
+        if (fc->dc) {
+            SelectObject(fc->dc, fc->old_font);
+            DeleteDC(fc->dc);
+        }
+        if (fc->hfont) DeleteObject(fc->hfont);
+        free(fc->atlas.pixels);
+        free(fc->ext_keys);
+        free(fc->ext_glyphs);
+        free(fc->kern_keys);
+        free(fc->kern_amounts);
+        free(fc->family);
+        free(fc);
+    }
 
+    static void _cgame_layout_free_all(CGameContext* rt);
 
-    // Draw scaled (new_w,new_h)
-    static void _cgame_image_draw_scaled_impl(const CGameImage* src, int x, int y, int new_w, int new_h) {
-        if (!src || !src->pixels) return;
-        // create nearest-resized temp and draw
-        CGameImage tmp = _cgame_image_resize_nearest(src, new_w, new_h);
-        _cgame_image_draw_impl(&tmp, x, y);
-        _cgame_image_unload_impl(&tmp);
+    static void _cgame_font_cache_free_all(CGameContext* rt) {
+        if (rt->fonts) {
+            for (int i = 0; i < rt->fonts->count; ++i) _cgame_font_cache_free(rt->fonts->caches[i]);
+            free(rt->fonts);
+            rt->fonts = NULL;
+        }
+        _cgame_layout_free_all(rt);
     }
 
-    // Getters
-    static int _cgame_image_get_width_impl(const CGameImage* img) { return img ? img->width : 0; }
-    static int _cgame_image_get_height_impl(const CGameImage* img) { return img ? img->height : 0; }
-    static int _cgame_image_get_channels_impl(const CGameImage* img) { return img ? img->channels : 0; }
+    static void _cgame_font_load_kerning(CGameFontCache* fc) {
+        DWORD n = GetKerningPairsW(fc->dc, 0, NULL);
+        if (n == 0 || n == GDI_ERROR) return;
+        KERNINGPAIR* pairs = (KERNINGPAIR*)_cgame_malloc(sizeof(KERNINGPAIR) * n);
+        if (!pairs) return;
+        n = GetKerningPairsW(fc->dc, n, pairs);
+
+        fc->kern_keys    = (unsigned int*)_cgame_malloc(sizeof(unsigned int) * n);
+        fc->kern_amounts = (short*)_cgame_malloc(sizeof(short) * n);
+        if (!fc->kern_keys || !fc->kern_amounts) { free(pairs); return; }
+
+        // insertion sort by key: fonts carry at most a few thousand pairs and this runs once
+        int count = 0;
+        for (DWORD i = 0; i < n; ++i) {
+            if (pairs[i].iKernAmount == 0) continue;
+            unsigned int key = ((unsigned int)pairs[i].wFirst << 16) | pairs[i].wSecond;
+            int j = count++;
+            while (j > 0 && fc->kern_keys[j - 1] > key) {
+                fc->kern_keys[j]    = fc->kern_keys[j - 1];
+                fc->kern_amounts[j] = fc->kern_amounts[j - 1];
+                --j;
+            }
+            fc->kern_keys[j]    = key;
+            fc->kern_amounts[j] = (short)pairs[i].iKernAmount;
+        }
+        fc->kern_count = count;
+        free(pairs);
+    }
 
-    static HICON _cgame_create_icon_from_image(const CGameImage* img) {
-        if (!img || !img->pixels) return NULL;
+    static int _cgame_font_kern(const CGameFontCache* fc, unsigned int a, unsigned int b) {
+        if (fc->kern_count == 0 || a > 0xFFFF || b > 0xFFFF) return 0;
+        unsigned int key = (a << 16) | b;
+        int lo = 0, hi = fc->kern_count - 1;
+        while (lo <= hi) {
+            int mid = (lo + hi) >> 1;
+            if (fc->kern_keys[mid] == key) return fc->kern_amounts[mid];
+            if (fc->kern_keys[mid] < key) lo = mid + 1; else hi = mid - 1;
+        }
+        return 0;
+    }
 
-        // Prepare BITMAPV5HEADER for 32-bit ARGB
-        BITMAPV5HEADER bi;
-        ZeroMemory(&bi, sizeof(bi));
-        bi.bV5Size        = sizeof(BITMAPV5HEADER);
-        bi.bV5Width       =  img->width;
-        bi.bV5Height      = -img->height; // top-down
-        bi.bV5Planes      = 1;
-        bi.bV5BitCount    = 32;
-        bi.bV5Compression = BI_BITFIELDS;
-        bi.bV5RedMask     =  0x00FF0000;
-        bi.bV5GreenMask   =  0x0000FF00;
-        bi.bV5BlueMask    =  0x000000FF;
-        bi.bV5AlphaMask   =  0xFF000000;
+    // Find (or create) the cache for a family at a pixel size; least recently used one is dropped when full.
+    // exact: NULL when GDI substituted another face, for callers that can fall back to GDI+
+    static CGameFontCache* _cgame_font_cache_get(const wchar_t* family, int px, bool exact) {
+        CGameFontCaches* set = _cgame_font_caches();
+        if (!set || !family || px <= 0) return NULL;
+        for (int i = 0; i < set->count; ++i) {
+            CGameFontCache* fc = set->caches[i];
+            if (fc->px == px && wcscmp(fc->family, family) == 0) {
+                fc->last_used = ++set->clock;
+                return (exact && fc->substituted) ? NULL : fc;
+            }
+        }
 
-        HDC hdc = GetDC(NULL);
-        void* bits = NULL;
-        HBITMAP colorBmp = CreateDIBSection(hdc, (BITMAPINFO*)&bi, DIB_RGB_COLORS, &bits, NULL, 0);
-        ReleaseDC(NULL, hdc);
-        if (!colorBmp || !bits) {
-            if (colorBmp) DeleteObject(colorBmp);
+        CGameFontCache* fc = (CGameFontCache*)_cgame_calloc(1, sizeof(CGameFontCache));
+        if (!fc) return NULL;
+        size_t len = wcslen(family);
+        fc->family = (wchar_t*)_cgame_malloc((len + 1) * sizeof(wchar_t));
+        if (fc->family) memcpy(fc->family, family, (len + 1) * sizeof(wchar_t));
+        fc->px = px;
+        fc->id = ++set->next_id;
+
+        fc->dc = CreateCompatibleDC(NULL);
+        fc->hfont = CreateFontW(-px, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+                                OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY,
+                                DEFAULT_PITCH | FF_DONTCARE, family);
+        if (!fc->family || !fc->dc || !fc->hfont || !_cgame_atlas_init(&fc->atlas)) {
+            _cgame_font_cache_free(fc);
             return NULL;
         }
+        fc->old_font = SelectObject(fc->dc, fc->hfont);
+
+        // CreateFontW never fails on an unknown family; the selected face tells (names over
+        // LF_FACESIZE - 1 characters can't be selected at all, so they count as substituted)
+        wchar_t face[LF_FACESIZE];
+        fc->substituted = GetTextFaceW(fc->dc, LF_FACESIZE, face) <= 0 || _wcsicmp(face, family) != 0;
+
+        TEXTMETRICW tm;
+        GetTextMetricsW(fc->dc, &tm);
+        fc->ascent      = tm.tmAscent;
+        fc->descent     = tm.tmDescent;
+        fc->line_height = tm.tmHeight + tm.tmExternalLeading;
+        _cgame_font_load_kerning(fc);
+
+        if (set->count == CGAME_TEXT_MAX_FONTS) {
+            int lru = 0;
+            for (int i = 1; i < set->count; ++i)
+                if (set->caches[i]->last_used < set->caches[lru]->last_used) lru = i;
+            _cgame_font_cache_free(set->caches[lru]);
+            set->caches[lru] = set->caches[--set->count];
+        }
+        fc->last_used = ++set->clock;
+        set->caches[set->count++] = fc;
+        return (exact && fc->substituted) ? NULL : fc;
+    }
 
-        // Copy pixels (straight RGBA → BGRA with alpha)
-        int w = img->width, h = img->height, c = img->channels;
-        for (int y = 0; y < h; ++y) {
-            for (int x = 0; x < w; ++x) {
-                unsigned char* dst = (unsigned char*)bits + (y * w + x) * 4;
-                const unsigned char* src = img->pixels + ((y * w + x) * c);
+    static void _cgame_font_rasterize(CGameFontCache* fc, unsigned int cp, CGameGlyph* g) {
+        static const MAT2 identity = { {0, 1}, {0, 0}, {0, 0}, {0, 1} };
+        GLYPHMETRICS gm;
+        memset(g, 0, sizeof(*g));
+        g->loaded = true;
 
-                dst[0] = src[2]; // B
-                dst[1] = src[1]; // G
-                dst[2] = src[0]; // R
-                dst[3] = (c >= 4) ? src[3] : 255; // A
+        DWORD size = GetGlyphOutlineW(fc->dc, cp, GGO_GRAY8_BITMAP, &gm, 0, NULL, &identity);
+        if (size == GDI_ERROR) {
+            if (GetGlyphOutlineW(fc->dc, cp, GGO_METRICS, &gm, 0, NULL, &identity) != GDI_ERROR)
+                g->advance = gm.gmCellIncX;
+            return;
+        }
+        g->advance = gm.gmCellIncX;
+        if (size == 0) return; // whitespace: metrics only
+
+        unsigned char* buf = (unsigned char*)_cgame_malloc(size);
+        if (!buf) return;
+        GetGlyphOutlineW(fc->dc, cp, GGO_GRAY8_BITMAP, &gm, size, buf, &identity);
+
+        int w = (int)gm.gmBlackBoxX, h = (int)gm.gmBlackBoxY;
+        int pitch = (w + 3) & ~3; // rows are DWORD aligned
+        int ax, ay;
+        if (_cgame_atlas_alloc(&fc->atlas, w, h, &ax, &ay)) {
+            for (int y = 0; y < h; ++y) {
+                const unsigned char* src = buf + (size_t)y * pitch;
+                unsigned char* dst = fc->atlas.pixels + (size_t)(ay + y) * CGAME_TEXT_ATLAS_WIDTH + ax;
+                for (int x = 0; x < w; ++x) dst[x] = (unsigned char)((src[x] * 255 + 32) / 64); // 0..64 → 0..255
             }
+            g->x = (unsigned short)ax;
+            g->y = (unsigned short)ay;
+            g->w = (unsigned short)w;
+            g->h = (unsigned short)h;
+            g->bx = (short)gm.gmptGlyphOrigin.x;
+            g->by = (short)gm.gmptGlyphOrigin.y;
         }
+        free(buf);
+    }
 
-        // Create monochrome mask (unused but required)
-        HBITMAP maskBmp = CreateBitmap(w, h, 1, 1, NULL);
+    static const CGameGlyph* _cgame_font_glyph(CGameFontCache* fc, unsigned int cp) {
+        if (cp > 0xFFFF) cp = '?'; // GetGlyphOutlineW takes a single UTF-16 unit
+        if (cp < 256) {
+            CGameGlyph* g = &fc->latin[cp];
+            if (!g->loaded) _cgame_font_rasterize(fc, cp, g);
+            return g;
+        }
 
-        ICONINFO ii;
-        ZeroMemory(&ii, sizeof(ii));
-        ii.fIcon    = TRUE;
-        ii.xHotspot = 0;
-        ii.yHotspot = 0;
-        ii.hbmMask  = maskBmp;
-        ii.hbmColor = colorBmp;
+        if ((fc->ext_count + 1) * 2 > fc->ext_cap) {
+            int cap = fc->ext_cap ? fc->ext_cap * 2 : 256;
+            unsigned int* keys = (unsigned int*)_cgame_calloc((size_t)cap, sizeof(unsigned int));
+            CGameGlyph* glyphs = (CGameGlyph*)_cgame_calloc((size_t)cap, sizeof(CGameGlyph));
+            if (!keys || !glyphs) { free(keys); free(glyphs); return _cgame_font_glyph(fc, '?'); }
+            for (int i = 0; i < fc->ext_cap; ++i) {
+                if (!fc->ext_keys[i]) continue;
+                unsigned int j = (fc->ext_keys[i] * 2654435761u) & (cap - 1);
+                while (keys[j]) j = (j + 1) & (cap - 1);
+                keys[j] = fc->ext_keys[i];
+                glyphs[j] = fc->ext_glyphs[i];
+            }
+            free(fc->ext_keys);
+            free(fc->ext_glyphs);
+            fc->ext_keys = keys;
+            fc->ext_glyphs = glyphs;
+            fc->ext_cap = cap;
+        }
 
-        HICON hIcon = CreateIconIndirect(&ii);
+        unsigned int j = (cp * 2654435761u) & (fc->ext_cap - 1);
+        while (fc->ext_keys[j] && fc->ext_keys[j] != cp) j = (j + 1) & (fc->ext_cap - 1);
+        if (!fc->ext_keys[j]) {
+            fc->ext_keys[j] = cp;
+            fc->ext_count++;
+            _cgame_font_rasterize(fc, cp, &fc->ext_glyphs[j]);
+        }
+        return &fc->ext_glyphs[j];
+    }
 
-        DeleteObject(colorBmp);
-        DeleteObject(maskBmp);
+    // The current target's backbuffer as a core surface
+    static inline CGameSurface _cgame_rt_surface(void) {
+        CGameSurface sf = { _cgame_rt->membits, _cgame_rt->memw, _cgame_rt->memh, _cgame_rt->memw * 4 };
+        return sf;
+    }
 
-        return hIcon;
+    static void _cgame_blit_coverage(const unsigned char* cov, int cov_stride, int w, int h,
+                                     int dx, int dy, int r, int g, int b) {
+        CGameSurface sf = _cgame_rt_surface();
+        _cgame_surface_blit_coverage(&sf, cov, cov_stride, w, h, dx, dy, r, g, b);
     }
 
-    static bool _cgame_display_set_icon_from_image(const CGameImage* img) {
-        if (!img) return false;
-        HICON hIcon = _cgame_create_icon_from_image(img);
-        if (!hIcon) return false;
+    // =========================
+    // Text layout
+    //  - A layout is the positioned glyph run for (string, font, size,
+    //    wrap width): pen x, line top y and the line count/extent.
+    //  - Strings of CGAME_TEXT_LAYOUT_MIN_LEN bytes or more are cached
+    //    (LRU, CGAME_TEXT_LAYOUT_MAX entries); shorter ones are laid out
+    //    into a reused scratch buffer, so per-frame counters don't churn
+    //    the cache. No length limit either way.
+    // =========================
+    #define CGAME_TEXT_LAYOUT_MAX      256
+    #define CGAME_TEXT_LAYOUT_BUCKETS  1024
+    #define CGAME_TEXT_LAYOUT_MIN_LEN  32
 
-        _cgame_window_icon = hIcon;
-        if (_cgame_screen.hwnd) {
-            SendMessage(_cgame_screen.hwnd, WM_SETICON, ICON_BIG,   (LPARAM)hIcon);
-            SendMessage(_cgame_screen.hwnd, WM_SETICON, ICON_SMALL, (LPARAM)hIcon);
+    typedef struct {
+        unsigned int cp;
+        int          x, y;           // pen position, top of the line
+    } CGameLayoutGlyph;
+
+    typedef struct {
+        char*              text;
+        size_t             len;
+        unsigned long long hash;
+        unsigned long long font;     // CGameFontCache::id
+        int                wrap;
+        CGameLayoutGlyph*  glyphs;
+        int                count, cap;
+        int                lines;
+        int                width, height;
+        unsigned long long last_used;
+        int                next;     // bucket chain, index + 1 (0 = end)
+    } CGameTextLayout;
+
+    // Per render target, like the font caches
+    typedef struct CGameTextLayouts {
+        CGameTextLayout    items[CGAME_TEXT_LAYOUT_MAX];
+        int                count;
+        int                buckets[CGAME_TEXT_LAYOUT_BUCKETS]; // index + 1
+        unsigned long long clock;
+        CGameTextLayout    scratch;
+    } CGameTextLayouts;
+
+    static CGameTextLayouts* _cgame_text_layouts(void) {
+        if (!_cgame_rt->layouts) _cgame_rt->layouts = (CGameTextLayouts*)_cgame_calloc(1, sizeof(CGameTextLayouts));
+        return _cgame_rt->layouts;
+    }
+
+    static bool _cgame_layout_push(CGameTextLayout* lay, unsigned int cp, int x, int y) {
+        if (lay->count == lay->cap) {
+            int cap = lay->cap ? lay->cap * 2 : 64;
+            CGameLayoutGlyph* g = (CGameLayoutGlyph*)_cgame_realloc(lay->glyphs, sizeof(CGameLayoutGlyph) * cap);
+            if (!g) return false;
+            lay->glyphs = g;
+            lay->cap = cap;
         }
+        CGameLayoutGlyph* g = &lay->glyphs[lay->count++];
+        g->cp = cp;
+        g->x = x;
+        g->y = y;
         return true;
     }
 
+    // Greedy word wrap: break after the last space that fits, or mid-word if a word alone is too wide
+    static void _cgame_layout_build(CGameFontCache* fc, const char* text, int wrap, CGameTextLayout* lay) {
+        lay->count = 0;
+        lay->lines = 1;
+        lay->width = 0;
+
+        int pen_x = 0, line_y = 0;
+        int line_start = 0;   // first glyph of the current line
+        int break_at = -1;    // first glyph after the last space on this line
+        unsigned int prev = 0;
+
+        const char* s = text;
+        while (*s) {
+            unsigned int cp = _cgame_utf8_next(&s);
+            if (cp == '\r') continue;
+            if (cp == '\n') {
+                pen_x = 0;
+                line_y += fc->line_height;
+                lay->lines++;
+                line_start = lay->count;
+                break_at = -1;
+                prev = 0;
+                continue;
+            }
 
-
-    // =========================
-    // Core functions
-    // =========================
-    static void _cgame_init(void) {
-        _cgame_hInstance = GetModuleHandleW(NULL);
-        _cgame_running = true;
-        _cgame_event = 0;
-
-        // Start GDI+ (if not already)
-        if (!_cgame_gdiplus_inited) {
-            Gdiplus::GdiplusStartupInput gdiplusStartupInput;
-            if (GdiplusStartup(&_cgame_gdiplusToken, &gdiplusStartupInput, NULL) == Gdiplus::Ok) {
-                _cgame_gdiplus_inited = true;
+            const CGameGlyph* gl = _cgame_font_glyph(fc, cp);
+            if (prev) pen_x += _cgame_font_kern(fc, prev, cp);
+
+            if (wrap > 0 && cp != ' ' && lay->count > line_start && pen_x + gl->bx + gl->w > wrap) {
+                int from = (break_at > line_start && break_at < lay->count) ? break_at : lay->count;
+                int shift = (from < lay->count) ? lay->glyphs[from].x : pen_x;
+                line_y += fc->line_height;
+                lay->lines++;
+                for (int i = from; i < lay->count; ++i) {
+                    lay->glyphs[i].x -= shift;
+                    lay->glyphs[i].y = line_y;
+                }
+                pen_x -= shift;
+                line_start = from;
+                break_at = -1;
             }
+
+            if (!_cgame_layout_push(lay, cp, pen_x, line_y)) break;
+            pen_x += gl->advance;
+            if (cp == ' ') break_at = lay->count;
+            prev = cp;
         }
-    }
-    
-    // terminal color
-    static void _cgame_console_set_color(int fg, int bg) {
-        HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-        SetConsoleTextAttribute(hConsole, (WORD)((bg << 4) | (fg & 0x0F)));
-    }
 
-    static void _cgame_console_reset_color(void) {
-        HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-        SetConsoleTextAttribute(hConsole, (WORD)(CGAME_CONSOLE_COLOR_WHITE | (CGAME_CONSOLE_COLOR_BLACK << 4)));
+        // Extent: ink advance of each line, trailing spaces excluded
+        for (int i = 0; i < lay->count; ++i) {
+            const CGameLayoutGlyph* g = &lay->glyphs[i];
+            if (g->cp == ' ') continue;
+            int right = g->x + _cgame_font_glyph(fc, g->cp)->advance;
+            if (right > lay->width) lay->width = right;
+        }
+        lay->height = lay->lines * fc->line_height;
     }
 
-
-    // message box wrapper
-    static int _cgame_message_box(const wchar_t* title, const wchar_t* text, UINT type) {
-        return MessageBoxW(NULL, text, title, type);
+    static void _cgame_layout_unlink(CGameTextLayouts* set, int index) {
+        CGameTextLayout* lay = &set->items[index];
+        int* link = &set->buckets[lay->hash & (CGAME_TEXT_LAYOUT_BUCKETS - 1)];
+        while (*link && *link != index + 1) link = &set->items[*link - 1].next;
+        if (*link) *link = lay->next;
     }
 
+    // NULL only when the layout set itself can't be allocated
+    static const CGameTextLayout* _cgame_layout_get(CGameFontCache* fc, const char* text, int wrap) {
+        CGameTextLayouts* set = _cgame_text_layouts();
+        if (!set) return NULL;
+        size_t len = strlen(text);
+        if (len < CGAME_TEXT_LAYOUT_MIN_LEN) {
+            _cgame_layout_build(fc, text, wrap, &set->scratch);
+            return &set->scratch;
+        }
 
-    static void _cgame_quit(void) {
-        _cgame_running = false;
-        if (_cgame_screen.hwnd) {
-            if (_cgame_screen.use_opengl) {
-                _cgame_cleanup_opengl(_cgame_screen.hdc, _cgame_screen.hglrc);
-            } else if (_cgame_screen.use_vulkan) {
-                _cgame_cleanup_vulkan(_cgame_screen.vk_lib);
-            } else if (_cgame_screen.use_d3d12) {
-                _cgame_cleanup_d3d12(_cgame_screen.d3d12_lib);
-            } else {
-                if (_cgame_screen.hdc) ReleaseDC(_cgame_screen.hwnd, _cgame_screen.hdc);
+        unsigned long long h = _cgame_fnv1a64(text, len, CGAME_FNV64_BASIS);
+        h = _cgame_fnv1a64(&fc->id, sizeof(fc->id), h);
+        h = _cgame_fnv1a64(&wrap, sizeof(wrap), h);
+
+        int* bucket = &set->buckets[h & (CGAME_TEXT_LAYOUT_BUCKETS - 1)];
+        for (int i = *bucket; i; i = set->items[i - 1].next) {
+            CGameTextLayout* lay = &set->items[i - 1];
+            if (lay->hash == h && lay->len == len && lay->font == fc->id && lay->wrap == wrap &&
+                memcmp(lay->text, text, len) == 0) {
+                lay->last_used = ++set->clock;
+                return lay;
             }
-            DestroyWindow(_cgame_screen.hwnd);
         }
-        _cgame_free_backbuffer();
-        UnregisterClassW(L"CGameWindowClass", _cgame_hInstance);
 
-        // Shutdown GDI+ if inited
-        if (_cgame_gdiplus_inited) {
-            GdiplusShutdown(_cgame_gdiplusToken);
-            _cgame_gdiplus_inited = false;
-            _cgame_gdiplusToken = 0;
+        // Miss: take a free slot or recycle the least recently used one
+        int index;
+        if (set->count < CGAME_TEXT_LAYOUT_MAX) {
+            index = set->count++;
+        } else {
+            index = 0;
+            for (int i = 1; i < CGAME_TEXT_LAYOUT_MAX; ++i)
+                if (set->items[i].last_used < set->items[index].last_used) index = i;
+            _cgame_layout_unlink(set, index);
+            free(set->items[index].text);
+            set->items[index].text = NULL;
         }
-    }
 
-    // =========================
-    // Display functions
-    // =========================
-    static CGameScreen _cgame_set_mode_impl(int w, int h, int flags) {
-        // --- Check conflicting GPU API flags ---
-        int gpu_api_count = (!!(flags & CGAME_OPENGL)) +
-                            (!!(flags & CGAME_VULKAN)) +
-                            (!!(flags & CGAME_D3D12));
-        if (gpu_api_count > 1) {
-            MessageBoxW(NULL,
-                L"Cannot combine multiple GPU APIs.\nChoose only one: OpenGL, Vulkan, or Direct3D 12.",
-                L"CGame Error",
-                MB_OK | MB_ICONERROR);
-            return _cgame_screen;
+        CGameTextLayout* lay = &set->items[index];
+        lay->text = (char*)_cgame_malloc(len + 1);
+        if (!lay->text) {
+            // out of memory: keep the slot empty and serve from scratch
+            lay->hash = 0;
+            lay->len = (size_t)-1;
+            lay->next = 0;
+            _cgame_layout_build(fc, text, wrap, &set->scratch);
+            return &set->scratch;
         }
+        memcpy(lay->text, text, len + 1);
+        lay->len  = len;
+        lay->hash = h;
+        lay->font = fc->id;
+        lay->wrap = wrap;
+        lay->last_used = ++set->clock;
+        _cgame_layout_build(fc, text, wrap, lay);
+
+        lay->next = *bucket;
+        *bucket = index + 1;
+        return lay;
+    }
 
-        if (flags & CGAME_DPI_AWARE) SetProcessDPIAware();
-
-        // --- Register window class ---
-        WNDCLASSW wc = {0};
-        wc.style         = CS_HREDRAW | CS_VREDRAW;
-        wc.lpfnWndProc   = _cgame_WndProc;
-        wc.hInstance     = _cgame_hInstance;
-        wc.hCursor       = LoadCursor(NULL, IDC_ARROW);
-        wc.lpszClassName = L"CGameWindowClass";
-        RegisterClassW(&wc);
+    static void _cgame_layout_free_all(CGameContext* rt) {
+        CGameTextLayouts* set = rt->layouts;
+        if (!set) return;
+        for (int i = 0; i < set->count; ++i) {
+            free(set->items[i].text);
+            free(set->items[i].glyphs);
+        }
+        free(set->scratch.glyphs);
+        free(set);
+        rt->layouts = NULL;
+    }
 
-        // --- Window style ---
-        DWORD style = WS_OVERLAPPEDWINDOW;
-        if (!(flags & CGAME_RESIZABLE)) {
-            style &= ~WS_THICKFRAME;
-            style &= ~WS_MAXIMIZEBOX;
+    // Blit UTF-8 text; (x, y) is the top of the first line, '\n' starts a new one, wrap <= 0 disables wrapping
+    static void _cgame_font_draw(CGameFontCache* fc, const char* text, int x, int y, int wrap, int r, int g, int b) {
+        const CGameTextLayout* lay = _cgame_layout_get(fc, text, wrap);
+        if (!lay) return;
+        GdiFlush(); // pending GDI work must land before touching the DIB directly
+        long long area = 0;
+        for (int i = 0; i < lay->count; ++i) {
+            const CGameLayoutGlyph* lg = &lay->glyphs[i];
+            const CGameGlyph* gl = _cgame_font_glyph(fc, lg->cp);
+            if (!gl->w || !gl->h) continue;
+            _cgame_blit_coverage(fc->atlas.pixels + (size_t)gl->y * CGAME_TEXT_ATLAS_WIDTH + gl->x,
+                                 CGAME_TEXT_ATLAS_WIDTH, gl->w, gl->h,
+                                 x + lg->x + gl->bx, y + lg->y + fc->ascent - gl->by, r, g, b);
+            area += gl->w * gl->h;
+        }
+        _cgame_stat_prim(CGAME_PRIM_TEXT, x, y, lay->width, lay->height, (double)area);
+        if (_cgame_overdraw_begin()) {
+            int m = fc->ascent; // italic overhang and bearings
+            _cgame_font_draw(fc, text, x, y, wrap, 255, 255, 255);
+            _cgame_overdraw_end(CGAME_PRIM_TEXT, x - m, y - m, lay->width + 2 * m, lay->height + 2 * m);
         }
+    }
 
-        // --- Adjust rect for client size ---
-        RECT rect = {0, 0, w, h};
-        AdjustWindowRect(&rect, style, FALSE);
-        int adjWidth  = rect.right - rect.left;
-        int adjHeight = rect.bottom - rect.top;
+    // NULL family → default font, size <= 0 → default size
+    static CGameFontCache* _cgame_font_cache_for(const wchar_t* fontName, float size) {
+        return _cgame_font_cache_get(fontName ? fontName : CGAME_TEXT_DEFAULT_FONT,
+                                     size > 0 ? (int)(size + 0.5f) : CGAME_TEXT_DEFAULT_PX, false);
+    }
 
-        // --- Create window ---
-        HWND hwnd = CreateWindowExW(
-            0,
-            wc.lpszClassName,
-            (_cgame_window_title[0] != L'\0') ? _cgame_window_title : L"CGame Window",
-            style,
-            CW_USEDEFAULT, CW_USEDEFAULT, adjWidth, adjHeight,
-            NULL, NULL, _cgame_hInstance, NULL
-        );
+    static void _cgame_text_draw_impl(const char* text, int x, int y, int r, int g, int b) {
+        CGAME_ZONE("text.draw");
+        if (!_cgame_rt->memdc || !text) return;
 
+        CGameFontCache* fc = _cgame_rt->membits ? _cgame_font_cache_get(CGAME_TEXT_DEFAULT_FONT, CGAME_TEXT_DEFAULT_PX, true) : NULL;
+        if (fc) {
+            _cgame_font_draw(fc, text, x, y, 0, r, g, b);
+            return;
+        }
 
-        if (!hwnd) {
-            MessageBoxW(NULL, L"Failed to create window.", L"CGame Error", MB_OK | MB_ICONERROR);
-            return _cgame_screen;
+        // GDI+ fallback
+        Gdiplus::Graphics gdi(_cgame_rt->memdc);
+        Gdiplus::SolidBrush brush(Gdiplus::Color(255, r, g, b));
+        Font font(L"Arial", 16); // default font, size 16
+        CGameArenaMark mark = _cgame_arena_mark();
+        WCHAR* wtext = _cgame_utf8_to_wide_arena(text);
+        if (wtext) gdi.DrawString(wtext, -1, &font, PointF((REAL)x, (REAL)y), &brush);
+        _cgame_arena_release(&mark);
+        if (!wtext) return;
+        _cgame_stat_prim(CGAME_PRIM_TEXT, x, y, 0, 0, 0); // coverage unknown
+        if (_cgame_overdraw_begin()) {
+            _cgame_text_draw_impl(text, x, y, 255, 255, 255);
+            _cgame_overdraw_end(CGAME_PRIM_TEXT, 0, 0, _cgame_rt->memw, _cgame_rt->memh);
         }
+    }
+
+    // Load custom font (TTF file)
+    static bool _cgame_text_load_font_impl(const char* path) {
+        if (!path) return false;
+        CGameArenaMark mark = _cgame_arena_mark();
+        WCHAR* wpath = _cgame_utf8_to_wide_arena(path);
+        bool ok = wpath && _cgame_font_collection.AddFontFile(wpath) == Gdiplus::Ok;
+        // Also register with GDI (process-private) so the glyph atlas can rasterize it
+        if (ok) AddFontResourceExW(wpath, FR_PRIVATE, 0);
+        _cgame_arena_release(&mark);
+        return ok;
+    }
 
-        _cgame_screen.hwnd = hwnd;
+    // Draw text with loaded TTF font
+    static void _cgame_text_draw_complex_impl(const char* text, int x, int y,
+                                              const wchar_t* fontName, float size,
+                                              int r, int g, int b) {
+        CGAME_ZONE("text.draw_complex");
+        if (!_cgame_rt->memdc || !text || !fontName) return;
 
-        // --- Apply stored title (if set after creation, it still updates) ---
-        if (_cgame_window_title[0]) {
-            SetWindowTextW(hwnd, _cgame_window_title);
+        CGameFontCache* fc = _cgame_rt->membits ? _cgame_font_cache_get(fontName, (int)(size + 0.5f), true) : NULL;
+        if (fc) {
+            _cgame_font_draw(fc, text, x, y, 0, r, g, b);
+            return;
         }
 
-        // --- Apply stored icon (if any) ---
-        if (_cgame_window_icon) {
-            SendMessage(hwnd, WM_SETICON, ICON_BIG,   (LPARAM)_cgame_window_icon);
-            SendMessage(hwnd, WM_SETICON, ICON_SMALL, (LPARAM)_cgame_window_icon);
-        }
+        // GDI+ fallback
+        Gdiplus::Graphics gdi(_cgame_rt->memdc);
+        Gdiplus::SolidBrush brush(Gdiplus::Color(255, r, g, b));
+        FontFamily family(fontName, &_cgame_font_collection);
+        Font font(&family, size, Gdiplus::FontStyleRegular, UnitPixel);
 
-        ShowWindow(hwnd, SW_SHOW);
-        UpdateWindow(hwnd);
+        CGameArenaMark mark = _cgame_arena_mark();
+        WCHAR* wtext = _cgame_utf8_to_wide_arena(text);
+        if (wtext) gdi.DrawString(wtext, -1, &font, PointF((REAL)x, (REAL)y), &brush);
+        _cgame_arena_release(&mark);
+        if (!wtext) return;
+        _cgame_stat_prim(CGAME_PRIM_TEXT, x, y, 0, 0, 0); // coverage unknown
+        if (_cgame_overdraw_begin()) {
+            _cgame_text_draw_complex_impl(text, x, y, fontName, size, 255, 255, 255);
+            _cgame_overdraw_end(CGAME_PRIM_TEXT, 0, 0, _cgame_rt->memw, _cgame_rt->memh);
+        }
+    }
 
-        // --- Fill screen struct ---
-        _cgame_screen.use_opengl = (flags & CGAME_OPENGL) != 0;
-        _cgame_screen.use_vulkan = (flags & CGAME_VULKAN) != 0;
-        _cgame_screen.use_d3d12  = (flags & CGAME_D3D12) != 0;
+    // Size of the laid out text without drawing it (wrap_width <= 0: no wrapping)
+    static void _cgame_text_measure_impl(const char* text, const wchar_t* fontName, float size,
+                                         int wrap_width, int* w, int* h) {
+        if (w) *w = 0;
+        if (h) *h = 0;
+        if (!text) return;
+        CGameFontCache* fc = _cgame_font_cache_for(fontName, size);
+        if (!fc) return;
+        const CGameTextLayout* lay = _cgame_layout_get(fc, text, wrap_width);
+        if (!lay) return;
+        if (w) *w = lay->width;
+        if (h) *h = lay->height;
+    }
 
-        _cgame_screen.vk_lib      = NULL;
-        _cgame_screen.vk_instance = NULL;
-        _cgame_screen.vk_device   = NULL;
-        _cgame_screen.vk_surface  = NULL;
-        _cgame_screen.vk_swapchain= NULL;
+    // Word-wrapped text, lines broken to fit wrap_width pixels
+    static void _cgame_text_draw_wrapped_impl(const char* text, int x, int y, int wrap_width,
+                                              const wchar_t* fontName, float size,
+                                              int r, int g, int b) {
+        CGAME_ZONE("text.draw_wrapped");
+        if (!_cgame_rt->membits || !text) return;
+        CGameFontCache* fc = _cgame_font_cache_for(fontName, size);
+        if (fc) _cgame_font_draw(fc, text, x, y, wrap_width, r, g, b);
+    }
 
-        _cgame_screen.d3d12_lib   = NULL;
-        _cgame_screen.d3d12_device    = NULL;
-        _cgame_screen.d3d12_cmdqueue  = NULL;
-        _cgame_screen.d3d12_swapchain = NULL;
+    // =========================
+    // Fast bitmap text
+    //  - Embedded 5x7 ASCII font (descenders to 9 rows) in a 6x10 cell,
+    //    drawn at integer scales. No GDI, no atlas, no layout: each row
+    //    is one byte, expanded straight into the backbuffer.
+    //  - Meant for debug overlays and numeric HUDs; numbers are formatted
+    //    in place without printf.
+    // =========================
+    #define CGAME_FAST_CELL_W  6
+    #define CGAME_FAST_CELL_H  10
+    #define CGAME_FAST_ROWS    9
+
+    // One byte per row, bit 7 = leftmost column; ' ' .. '~'
+    static const unsigned char _cgame_fast_font[95][CGAME_FAST_ROWS] = {
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, //  
+        { 0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x20, 0x00, 0x00 }, // !
+        { 0x50, 0x50, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // "
+        { 0x50, 0x50, 0xF8, 0x50, 0xF8, 0x50, 0x50, 0x00, 0x00 }, // #
+        { 0x20, 0x78, 0xA0, 0x70, 0x28, 0xF0, 0x20, 0x00, 0x00 }, // $
+        { 0xC0, 0xC8, 0x10, 0x20, 0x40, 0x98, 0x18, 0x00, 0x00 }, // %
+        { 0x60, 0x90, 0xA0, 0x40, 0xA8, 0x90, 0x68, 0x00, 0x00 }, // &
+        { 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '
+        { 0x10, 0x20, 0x40, 0x40, 0x40, 0x20, 0x10, 0x00, 0x00 }, // (
+        { 0x40, 0x20, 0x10, 0x10, 0x10, 0x20, 0x40, 0x00, 0x00 }, // )
+        { 0x00, 0x20, 0xA8, 0x70, 0xA8, 0x20, 0x00, 0x00, 0x00 }, // *
+        { 0x00, 0x20, 0x20, 0xF8, 0x20, 0x20, 0x00, 0x00, 0x00 }, // +
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x20, 0x40, 0x00 }, // ,
+        { 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00 }, // -
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00 }, // .
+        { 0x00, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00, 0x00, 0x00 }, // /
+        { 0x70, 0x88, 0x98, 0xA8, 0xC8, 0x88, 0x70, 0x00, 0x00 }, // 0
+        { 0x20, 0x60, 0x20, 0x20, 0x20, 0x20, 0x70, 0x00, 0x00 }, // 1
+        { 0x70, 0x88, 0x08, 0x10, 0x20, 0x40, 0xF8, 0x00, 0x00 }, // 2
+        { 0xF8, 0x10, 0x20, 0x10, 0x08, 0x88, 0x70, 0x00, 0x00 }, // 3
+        { 0x10, 0x30, 0x50, 0x90, 0xF8, 0x10, 0x10, 0x00, 0x00 }, // 4
+        { 0xF8, 0x80, 0xF0, 0x08, 0x08, 0x88, 0x70, 0x00, 0x00 }, // 5
+        { 0x30, 0x40, 0x80, 0xF0, 0x88, 0x88, 0x70, 0x00, 0x00 }, // 6
+        { 0xF8, 0x08, 0x10, 0x20, 0x40, 0x40, 0x40, 0x00, 0x00 }, // 7
+        { 0x70, 0x88, 0x88, 0x70, 0x88, 0x88, 0x70, 0x00, 0x00 }, // 8
+        { 0x70, 0x88, 0x88, 0x78, 0x08, 0x10, 0x60, 0x00, 0x00 }, // 9
+        { 0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00 }, // :
+        { 0x00, 0x60, 0x60, 0x00, 0x60, 0x20, 0x40, 0x00, 0x00 }, // ;
+        { 0x10, 0x20, 0x40, 0x80, 0x40, 0x20, 0x10, 0x00, 0x00 }, // <
+        { 0x00, 0x00, 0xF8, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00 }, // =
+        { 0x40, 0x20, 0x10, 0x08, 0x10, 0x20, 0x40, 0x00, 0x00 }, // >
+        { 0x70, 0x88, 0x08, 0x10, 0x20, 0x00, 0x20, 0x00, 0x00 }, // ?
+        { 0x70, 0x88, 0x08, 0x68, 0xA8, 0xA8, 0x70, 0x00, 0x00 }, // @
+        { 0x70, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x88, 0x00, 0x00 }, // A
+        { 0xF0, 0x88, 0x88, 0xF0, 0x88, 0x88, 0xF0, 0x00, 0x00 }, // B
+        { 0x70, 0x88, 0x80, 0x80, 0x80, 0x88, 0x70, 0x00, 0x00 }, // C
+        { 0xE0, 0x90, 0x88, 0x88, 0x88, 0x90, 0xE0, 0x00, 0x00 }, // D
+        { 0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0xF8, 0x00, 0x00 }, // E
+        { 0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0x80, 0x00, 0x00 }, // F
+        { 0x70, 0x88, 0x80, 0xB8, 0x88, 0x88, 0x78, 0x00, 0x00 }, // G
+        { 0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x88, 0x00, 0x00 }, // H
+        { 0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, 0x00, 0x00 }, // I
+        { 0x38, 0x10, 0x10, 0x10, 0x10, 0x90, 0x60, 0x00, 0x00 }, // J
+        { 0x88, 0x90, 0xA0, 0xC0, 0xA0, 0x90, 0x88, 0x00, 0x00 }, // K
+        { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xF8, 0x00, 0x00 }, // L
+        { 0x88, 0xD8, 0xA8, 0xA8, 0x88, 0x88, 0x88, 0x00, 0x00 }, // M
+        { 0x88, 0x88, 0xC8, 0xA8, 0x98, 0x88, 0x88, 0x00, 0x00 }, // N
+        { 0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, 0x00, 0x00 }, // O
+        { 0xF0, 0x88, 0x88, 0xF0, 0x80, 0x80, 0x80, 0x00, 0x00 }, // P
+        { 0x70, 0x88, 0x88, 0x88, 0xA8, 0x90, 0x68, 0x00, 0x00 }, // Q
+        { 0xF0, 0x88, 0x88, 0xF0, 0xA0, 0x90, 0x88, 0x00, 0x00 }, // R
+        { 0x78, 0x80, 0x80, 0x70, 0x08, 0x08, 0xF0, 0x00, 0x00 }, // S
+        { 0xF8, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x00 }, // T
+        { 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, 0x00, 0x00 }, // U
+        { 0x88, 0x88, 0x88, 0x88, 0x88, 0x50, 0x20, 0x00, 0x00 }, // V
+        { 0x88, 0x88, 0x88, 0xA8, 0xA8, 0xA8, 0x50, 0x00, 0x00 }, // W
+        { 0x88, 0x88, 0x50, 0x20, 0x50, 0x88, 0x88, 0x00, 0x00 }, // X
+        { 0x88, 0x88, 0x88, 0x50, 0x20, 0x20, 0x20, 0x00, 0x00 }, // Y
+        { 0xF8, 0x08, 0x10, 0x20, 0x40, 0x80, 0xF8, 0x00, 0x00 }, // Z
+        { 0x70, 0x40, 0x40, 0x40, 0x40, 0x40, 0x70, 0x00, 0x00 }, // [
+        { 0x00, 0x80, 0x40, 0x20, 0x10, 0x08, 0x00, 0x00, 0x00 }, // backslash
+        { 0x70, 0x10, 0x10, 0x10, 0x10, 0x10, 0x70, 0x00, 0x00 }, // ]
+        { 0x20, 0x50, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ^
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00 }, // _
+        { 0x40, 0x20, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // `
+        { 0x00, 0x00, 0x70, 0x08, 0x78, 0x88, 0x78, 0x00, 0x00 }, // a
+        { 0x80, 0x80, 0xB0, 0xC8, 0x88, 0x88, 0xF0, 0x00, 0x00 }, // b
+        { 0x00, 0x00, 0x70, 0x80, 0x80, 0x88, 0x70, 0x00, 0x00 }, // c
+        { 0x08, 0x08, 0x68, 0x98, 0x88, 0x88, 0x78, 0x00, 0x00 }, // d
+        { 0x00, 0x00, 0x70, 0x88, 0xF8, 0x80, 0x70, 0x00, 0x00 }, // e
+        { 0x30, 0x48, 0x40, 0xE0, 0x40, 0x40, 0x40, 0x00, 0x00 }, // f
+        { 0x00, 0x00, 0x78, 0x88, 0x88, 0x78, 0x08, 0x08, 0x70 }, // g
+        { 0x80, 0x80, 0xB0, 0xC8, 0x88, 0x88, 0x88, 0x00, 0x00 }, // h
+        { 0x20, 0x00, 0x60, 0x20, 0x20, 0x20, 0x70, 0x00, 0x00 }, // i
+        { 0x10, 0x00, 0x30, 0x10, 0x10, 0x10, 0x10, 0x90, 0x60 }, // j
+        { 0x80, 0x80, 0x90, 0xA0, 0xC0, 0xA0, 0x90, 0x00, 0x00 }, // k
+        { 0x60, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, 0x00, 0x00 }, // l
+        { 0x00, 0x00, 0xD0, 0xA8, 0xA8, 0x88, 0x88, 0x00, 0x00 }, // m
+        { 0x00, 0x00, 0xB0, 0xC8, 0x88, 0x88, 0x88, 0x00, 0x00 }, // n
+        { 0x00, 0x00, 0x70, 0x88, 0x88, 0x88, 0x70, 0x00, 0x00 }, // o
+        { 0x00, 0x00, 0xF0, 0x88, 0x88, 0xF0, 0x80, 0x80, 0x80 }, // p
+        { 0x00, 0x00, 0x78, 0x88, 0x88, 0x78, 0x08, 0x08, 0x08 }, // q
+        { 0x00, 0x00, 0xB0, 0xC8, 0x80, 0x80, 0x80, 0x00, 0x00 }, // r
+        { 0x00, 0x00, 0x70, 0x80, 0x70, 0x08, 0xF0, 0x00, 0x00 }, // s
+        { 0x40, 0x40, 0xE0, 0x40, 0x40, 0x48, 0x30, 0x00, 0x00 }, // t
+        { 0x00, 0x00, 0x88, 0x88, 0x88, 0x98, 0x68, 0x00, 0x00 }, // u
+        { 0x00, 0x00, 0x88, 0x88, 0x88, 0x50, 0x20, 0x00, 0x00 }, // v
+        { 0x00, 0x00, 0x88, 0x88, 0xA8, 0xA8, 0x50, 0x00, 0x00 }, // w
+        { 0x00, 0x00, 0x88, 0x50, 0x20, 0x50, 0x88, 0x00, 0x00 }, // x
+        { 0x00, 0x00, 0x88, 0x88, 0x88, 0x78, 0x08, 0x08, 0x70 }, // y
+        { 0x00, 0x00, 0xF8, 0x10, 0x20, 0x40, 0xF8, 0x00, 0x00 }, // z
+        { 0x18, 0x20, 0x20, 0x40, 0x20, 0x20, 0x18, 0x00, 0x00 }, // {
+        { 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00 }, // |
+        { 0xC0, 0x20, 0x20, 0x10, 0x20, 0x20, 0xC0, 0x00, 0x00 }, // }
+        { 0x00, 0x00, 0x40, 0xA8, 0x10, 0x00, 0x00, 0x00, 0x00 }, // ~
+    };
 
-        // --- Get actual client area size ---
-        RECT clientRect;
-        GetClientRect(hwnd, &clientRect);
-        _cgame_screen.width  = clientRect.right - clientRect.left;
-        _cgame_screen.height = clientRect.bottom - clientRect.top;
+    static void _cgame_fast_glyph(const unsigned char* rows, int x, int y, int scale, unsigned int color) {
+        int w = CGAME_FAST_CELL_W * scale;
+        int h = CGAME_FAST_ROWS * scale;
+        if (x >= _cgame_rt->memw || y >= _cgame_rt->memh || x + w <= 0 || y + h <= 0) return;
+
+    #ifdef CGAME_FAST_SSE2
+        // Unclipped 1x glyph: 8 pixels per row selected by the row bits, two 4-pixel masks
+        if (scale == 1 && x >= 0 && y >= 0 && x + 8 <= _cgame_rt->memw && y + h <= _cgame_rt->memh) {
+            const __m128i bits_lo = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
+            const __m128i bits_hi = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
+            const __m128i col = _mm_set1_epi32((int)color);
+            unsigned char* dst = _cgame_rt->membits + ((size_t)y * _cgame_rt->memw + x) * 4;
+            for (int row = 0; row < CGAME_FAST_ROWS; ++row, dst += (size_t)_cgame_rt->memw * 4) {
+                if (!rows[row]) continue;
+                __m128i b  = _mm_set1_epi32(rows[row]);
+                __m128i m0 = _mm_cmpeq_epi32(_mm_and_si128(b, bits_lo), bits_lo);
+                __m128i m1 = _mm_cmpeq_epi32(_mm_and_si128(b, bits_hi), bits_hi);
+                __m128i d0 = _mm_loadu_si128((const __m128i*)dst);
+                __m128i d1 = _mm_loadu_si128((const __m128i*)(dst + 16));
+                _mm_storeu_si128((__m128i*)dst,        _mm_or_si128(_mm_andnot_si128(m0, d0), _mm_and_si128(m0, col)));
+                _mm_storeu_si128((__m128i*)(dst + 16), _mm_or_si128(_mm_andnot_si128(m1, d1), _mm_and_si128(m1, col)));
+            }
+            return;
+        }
+    #endif
 
-        // --- Choose API ---
-        if (_cgame_screen.use_opengl) {
-            if (!_cgame_init_opengl(hwnd, &_cgame_screen.hdc, &_cgame_screen.hglrc)) {
-                DestroyWindow(hwnd);
-                _cgame_screen.hwnd = NULL;
+        // Scaled or clipped: each set bit fills a scale x scale block
+        for (int row = 0; row < CGAME_FAST_ROWS; ++row) {
+            unsigned int bits = rows[row];
+            if (!bits) continue;
+            for (int sy = 0; sy < scale; ++sy) {
+                int py = y + row * scale + sy;
+                if (py < 0 || py >= _cgame_rt->memh) continue;
+                unsigned int* line = (unsigned int*)(_cgame_rt->membits + (size_t)py * _cgame_rt->memw * 4);
+                for (int col = 0; col < 8; ++col) {
+                    if (!(bits & (0x80u >> col))) continue;
+                    int px0 = x + col * scale, px1 = px0 + scale;
+                    if (px0 < 0) px0 = 0;
+                    if (px1 > _cgame_rt->memw) px1 = _cgame_rt->memw;
+                    for (int px = px0; px < px1; ++px) line[px] = color;
+                }
             }
-        } else if (_cgame_screen.use_vulkan) {
-            if (!_cgame_init_vulkan(hwnd, &_cgame_screen.vk_lib)) {
-                DestroyWindow(hwnd);
-                _cgame_screen.hwnd = NULL;
-            } else {
-                _cgame_screen.hdc = NULL; // Vulkan doesn’t use GDI
+        }
+    }
+
+    // Draw UTF-8 text (non-ASCII shows as '?'); returns the pen x after the last glyph
+    static int _cgame_text_draw_fast_impl(const char* text, int x, int y, int scale, int r, int g, int b) {
+        CGAME_ZONE("text.draw_fast");
+        if (!text) return x;
+        if (scale < 1) scale = 1;
+        if (!_cgame_rt->membits) return x + (int)strlen(text) * CGAME_FAST_CELL_W * scale;
+
+        unsigned int color = ((unsigned int)(r & 0xFF) << 16) | ((unsigned int)(g & 0xFF) << 8) | (unsigned int)(b & 0xFF);
+        const char* start = text;
+        int pen_x = x, top = y, right = x, glyphs = 0;
+        GdiFlush();
+        while (*text) {
+            unsigned int cp = _cgame_utf8_next(&text);
+            if (cp == '\n') {
+                pen_x = x;
+                y += CGAME_FAST_CELL_H * scale;
+                continue;
             }
-        } else if (_cgame_screen.use_d3d12) {
-            if (!_cgame_init_d3d12(hwnd, &_cgame_screen.d3d12_lib)) {
-                DestroyWindow(hwnd);
-                _cgame_screen.hwnd = NULL;
-            } else {
-                _cgame_screen.hdc = NULL; // D3D12 doesn’t use GDI
+            if (cp == '\r') continue;
+            if (cp < 32 || cp > 126) cp = '?';
+            if (cp != ' ') {
+                _cgame_fast_glyph(_cgame_fast_font[cp - 32], pen_x, y, scale, color);
+                glyphs++;
             }
-        } else {
-            // CPU/GDI backbuffer
-            _cgame_screen.hdc = GetDC(hwnd);
-            _cgame_make_backbuffer(_cgame_screen.width, _cgame_screen.height);
+            pen_x += CGAME_FAST_CELL_W * scale;
+            if (pen_x > right) right = pen_x;
+        }
+        _cgame_stat_prim(CGAME_PRIM_TEXT, x, top, right - x, y - top + CGAME_FAST_CELL_H * scale,
+                         (double)glyphs * CGAME_FAST_CELL_W * CGAME_FAST_CELL_H * scale * scale);
+        if (_cgame_overdraw_begin()) {
+            _cgame_text_draw_fast_impl(start, x, top, scale, 255, 255, 255);
+            _cgame_overdraw_end(CGAME_PRIM_TEXT, x, top, right - x, y - top + CGAME_FAST_CELL_H * scale);
         }
+        return pen_x;
+    }
 
-        return _cgame_screen;
+    // Decimal digits of v into buf (>= 21 bytes), NUL-terminated; returns the length
+    static int _cgame_format_int(char* buf, long long v) {
+        char tmp[20];
+        int n = 0, len = 0;
+        unsigned long long u = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+        do { tmp[n++] = (char)('0' + u % 10); u /= 10; } while (u);
+        if (v < 0) buf[len++] = '-';
+        while (n) buf[len++] = tmp[--n];
+        buf[len] = '\0';
+        return len;
     }
 
+    // Fixed-point v with 0..9 decimals, rounded half away from zero (buf >= 32 bytes).
+    // Magnitudes too large for 64-bit fixed point print as "inf".
+    static int _cgame_format_float(char* buf, double v, int decimals) {
+        static const double pow10[10] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+        if (decimals < 0) decimals = 0;
+        if (decimals > 9) decimals = 9;
+
+        int len = 0;
+        if (v != v) { memcpy(buf, "nan", 4); return 3; }
+        bool neg = v < 0;
+        double scaled = (neg ? -v : v) * pow10[decimals] + 0.5;
+        if (scaled >= 1.8e19) { memcpy(buf, neg ? "-inf" : "inf", neg ? 5 : 4); return neg ? 4 : 3; }
+
+        unsigned long long fixed = (unsigned long long)scaled;
+        unsigned long long unit  = (unsigned long long)pow10[decimals];
+        if (neg && fixed) buf[len++] = '-'; // no "-0.00"
+        unsigned long long whole = fixed / unit;
+        char tmp[20];
+        int n = 0;
+        do { tmp[n++] = (char)('0' + whole % 10); whole /= 10; } while (whole);
+        while (n) buf[len++] = tmp[--n];
+        if (decimals) {
+            unsigned long long frac = fixed % unit;
+            buf[len++] = '.';
+            for (int i = decimals - 1; i >= 0; --i) {
+                buf[len + i] = (char)('0' + frac % 10);
+                frac /= 10;
+            }
+            len += decimals;
+        }
+        buf[len] = '\0';
+        return len;
+    }
 
+    static int _cgame_text_draw_fast_int_impl(long long value, int x, int y, int scale, int r, int g, int b) {
+        CGAME_ZONE("text.draw_fast_int");
+        char buf[24];
+        _cgame_format_int(buf, value);
+        return _cgame_text_draw_fast_impl(buf, x, y, scale, r, g, b);
+    }
 
-    static void _cgame_display_set_bgcolor(int r, int g, int b) {
-        _cgame_bgcolor = RGB(r,g,b);
-        if (!_cgame_screen.use_opengl && !_cgame_screen.use_vulkan && _cgame_memdc) {
-            _cgame_fill_dc(_cgame_memdc, _cgame_screen.width, _cgame_screen.height, _cgame_bgcolor);
-        }
-        /* For OpenGL/Vulkan the bg color is stored in _cgame_bgcolor,
-           but clearing should be done by the user's rendering code (glClear / vkCmdClearAttachments). */
+    static int _cgame_text_draw_fast_float_impl(double value, int decimals, int x, int y, int scale, int r, int g, int b) {
+        CGAME_ZONE("text.draw_fast_float");
+        char buf[32];
+        _cgame_format_float(buf, value, decimals);
+        return _cgame_text_draw_fast_impl(buf, x, y, scale, r, g, b);
     }
 
-    static void _cgame_display_clear_impl(void) {
-        if (!_cgame_screen.use_opengl && !_cgame_screen.use_vulkan && _cgame_memdc) {
-            _cgame_fill_dc(_cgame_memdc, _cgame_screen.width, _cgame_screen.height, _cgame_bgcolor);
+    // =========================
+    // Debug HUD (cgame.debug.hud)
+    //  - display.flip draws it over the finished frame, before presenting,
+    //    from the counters that frame produced; its own drawing is not
+    //    counted.
+    //  - Fast bitmap font and direct pixel writes only: a panel of about
+    //    35k pixels and ~40 short strings, a few tens of microseconds.
+    // =========================
+    #define CGAME_HUD_X        6
+    #define CGAME_HUD_Y        6
+    #define CGAME_HUD_SAMPLES  300   // frame-time graph, one column per frame
+    #define CGAME_HUD_GRAPH_H  40
+    #define CGAME_HUD_W        (CGAME_HUD_SAMPLES + 12)
+    #define CGAME_HUD_H        (CGAME_HUD_GRAPH_H + 76)
+
+    static long long    _cgame_hud_times[CGAME_HUD_SAMPLES];  // ns, ring
+    static unsigned int _cgame_hud_count = 0;
+    static bool         _cgame_stats_track = false;           // debug.track
+
+    // Halve the brightness of a clipped rect (panel background)
+    static void _cgame_hud_dim(int x, int y, int w, int h) {
+        int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+        int x1 = x + w > _cgame_rt->memw ? _cgame_rt->memw : x + w;
+        int y1 = y + h > _cgame_rt->memh ? _cgame_rt->memh : y + h;
+        for (int py = y0; py < y1; ++py) {
+            unsigned int* line = (unsigned int*)(_cgame_rt->membits + (size_t)py * _cgame_rt->memw * 4);
+            for (int px = x0; px < x1; ++px) line[px] = (line[px] >> 1) & 0x7F7F7Fu;
         }
-        /* For OpenGL/Vulkan the user should call their own clear/present */
     }
 
-    static void _cgame_display_flip_impl(void) {
-        if (!_cgame_screen.hwnd) return;
+    static void _cgame_hud_pixel(int x, int y, unsigned int color) {
+        if ((unsigned)x < (unsigned)_cgame_rt->memw && (unsigned)y < (unsigned)_cgame_rt->memh)
+            ((unsigned int*)_cgame_rt->membits)[(size_t)y * _cgame_rt->memw + x] = color;
+    }
 
-        if (_cgame_screen.use_opengl) {
-            SwapBuffers(_cgame_screen.hdc);
-        } else if (_cgame_screen.use_vulkan) {
-            /* For Vulkan mode, the user must call vkQueuePresentKHR / present their swapchain.
-               This library only performs runtime detection and provides placeholders. */
-        } else {
-            HDC wnddc = GetDC(_cgame_screen.hwnd);
-            if (wnddc && _cgame_memdc) {
-                BitBlt(wnddc, 0, 0, _cgame_screen.width, _cgame_screen.height, _cgame_memdc, 0, 0, SRCCOPY);
-            }
-            if (wnddc) ReleaseDC(_cgame_screen.hwnd, wnddc);
+    // "label value", returns the pen x
+    static int _cgame_hud_pair(int x, int y, const char* label, long long value) {
+        x = _cgame_text_draw_fast_impl(label, x, y, 1, 150, 150, 160);
+        return _cgame_text_draw_fast_int_impl(value, x, y, 1, 255, 255, 255);
+    }
+
+    static void _cgame_hud_draw(void) {
+        CGAME_ZONE("debug.hud");
+        const CGameFrameStats* s = &_cgame_stats_last;
+        if (s->frame_ns > 0) _cgame_hud_times[_cgame_hud_count++ % CGAME_HUD_SAMPLES] = s->frame_ns;
+        if (!_cgame_rt->membits) return;
+
+        bool counting = _cgame_stats_on, overdraw = _cgame_overdraw_on;
+        _cgame_stats_on = _cgame_overdraw_on = false;
+
+        // FPS over the last (up to) 60 frames, worst frame over the whole graph
+        int n = _cgame_hud_count < CGAME_HUD_SAMPLES ? (int)_cgame_hud_count : CGAME_HUD_SAMPLES;
+        long long recent = 0, worst = 0;
+        int recent_n = n < 60 ? n : 60;
+        for (int i = 0; i < n; ++i) {
+            long long t = _cgame_hud_times[(_cgame_hud_count - 1 - i) % CGAME_HUD_SAMPLES];
+            if (i < recent_n) recent += t;
+            if (t > worst) worst = t;
+        }
+        double avg_ms = recent_n ? recent / 1e6 / recent_n : 0.0;
+
+        GdiFlush();
+        _cgame_hud_dim(CGAME_HUD_X, CGAME_HUD_Y, CGAME_HUD_W, CGAME_HUD_H);
+        int x = CGAME_HUD_X + 6, y = CGAME_HUD_Y + 5;
+
+        int px = _cgame_text_draw_fast_impl("FPS ", x, y, 1, 150, 150, 160);
+        px = _cgame_text_draw_fast_float_impl(avg_ms > 0 ? 1000.0 / avg_ms : 0.0, 1, px, y, 1, 255, 255, 255);
+        px = _cgame_text_draw_fast_float_impl(avg_ms, 2, px + 12, y, 1, 255, 255, 255);
+        px = _cgame_text_draw_fast_impl(" ms  max ", px, y, 1, 150, 150, 160);
+        px = _cgame_text_draw_fast_float_impl(worst / 1e6, 2, px, y, 1, 255, 255, 255);
+        _cgame_text_draw_fast_impl(" ms", px, y, 1, 150, 150, 160);
+
+        // Frame-time graph, newest on the right; full height is twice the target frame time
+        y += 14;
+        long long target = _cgame_frame_period_ns > 0 ? _cgame_frame_period_ns : 16666667LL;
+        for (int gx = 0; gx < CGAME_HUD_SAMPLES; gx += 2)
+            _cgame_hud_pixel(x + gx, y + CGAME_HUD_GRAPH_H / 2, 0x606060u); // target line
+        for (int i = 0; i < n; ++i) {
+            long long t = _cgame_hud_times[(_cgame_hud_count - n + i) % CGAME_HUD_SAMPLES];
+            long long bar = t * (CGAME_HUD_GRAPH_H / 2) / target;
+            if (bar > CGAME_HUD_GRAPH_H) bar = CGAME_HUD_GRAPH_H;
+            if (bar < 1) bar = 1;
+            unsigned int color = t <= target + target / 10 ? 0x40D040u : t <= target * 2 ? 0xE0C030u : 0xE04040u;
+            int gx = x + CGAME_HUD_SAMPLES - n + i;
+            for (int k = 0; k < bar; ++k) _cgame_hud_pixel(gx, y + CGAME_HUD_GRAPH_H - 1 - k, color);
         }
+
+        // Counters
+        y += CGAME_HUD_GRAPH_H + 5;
+        px = _cgame_hud_pair(x, y, "fill  rect ", s->calls[CGAME_PRIM_FILL_RECT]);
+        px = _cgame_hud_pair(px, y, "  rrect ", s->calls[CGAME_PRIM_ROUNDED_FILL_RECT]);
+        px = _cgame_hud_pair(px, y, "  circle ", s->calls[CGAME_PRIM_FILL_CIRCLE]);
+        _cgame_hud_pair(px, y, "  poly ", s->calls[CGAME_PRIM_FILL_POLYGON]);
+        y += 11;
+        px = _cgame_hud_pair(x, y, "line  rect ", s->calls[CGAME_PRIM_RECT]);
+        px = _cgame_hud_pair(px, y, "  rrect ", s->calls[CGAME_PRIM_ROUNDED_RECT]);
+        px = _cgame_hud_pair(px, y, "  circle ", s->calls[CGAME_PRIM_CIRCLE]);
+        _cgame_hud_pair(px, y, "  poly ", s->calls[CGAME_PRIM_POLYGON]);
+        y += 11;
+        px = _cgame_hud_pair(x, y, "draws ", s->draw_calls);
+        px = _cgame_hud_pair(px, y, "  blits ", s->blits);
+        px = _cgame_hud_pair(px, y, "  text ", s->text_calls);
+        _cgame_hud_pair(px, y, "  clears ", s->calls[CGAME_PRIM_CLEAR]);
+        y += 11;
+        px = _cgame_text_draw_fast_impl("pixels ", x, y, 1, 150, 150, 160);
+        px = _cgame_text_draw_fast_float_impl(s->pixels_filled / 1e6, 2, px, y, 1, 255, 255, 255);
+        px = _cgame_text_draw_fast_impl("M  alloc ", px, y, 1, 150, 150, 160);
+        px = _cgame_text_draw_fast_float_impl(s->bytes_allocated / 1024.0, 1, px, y, 1, 255, 255, 255);
+        _cgame_text_draw_fast_impl(" KB", px, y, 1, 150, 150, 160);
+
+        _cgame_stats_on = counting;
+        _cgame_overdraw_on = overdraw;
     }
 
-    static int _cgame_display_get_width(void) { return _cgame_screen.width; }
-    static int _cgame_display_get_height(void) { return _cgame_screen.height; }
+    static void _cgame_debug_apply(void) {
+        bool on = _cgame_hud_on || _cgame_stats_track;
+        if (on && !_cgame_stats_on) {
+            memset(&_cgame_stats_live, 0, sizeof(_cgame_stats_live));
+            InterlockedExchange64(&_cgame_stats_bytes, 0);
+        }
+        _cgame_stats_on = on;
+    }
 
-    // =========================
-    // Drawing
-    // =========================
-    static void _cgame_draw_fillrect_impl(int x, int y, int w, int h, int r, int g, int b) {
-        if (!_cgame_memdc || _cgame_screen.use_opengl || _cgame_screen.use_vulkan) return;
-        HBRUSH brush = CreateSolidBrush(RGB(r,g,b));
-        RECT rc = { x, y, x + w, y + h };
-        FillRect(_cgame_memdc, &rc, brush);
-        DeleteObject(brush);
+    // Overlay with FPS, frame-time graph and this frame's counters
+    static void _cgame_debug_hud_impl(bool enabled) {
+        if (enabled && !_cgame_hud_on) _cgame_hud_count = 0;
+        _cgame_hud_on = enabled;
+        _cgame_debug_apply();
     }
-    static void _cgame_draw_rect_impl(int x, int y, int w, int h, int border_width, int r, int g, int b) {
-        if (!_cgame_memdc || _cgame_screen.use_opengl || _cgame_screen.use_vulkan) return;
 
-        // Create a pen with custom thickness
-        HPEN pen = CreatePen(PS_SOLID, border_width, RGB(r, g, b));
-        HGDIOBJ oldPen = SelectObject(_cgame_memdc, pen);
-        HGDIOBJ oldBrush = SelectObject(_cgame_memdc, GetStockObject(NULL_BRUSH));
+    // Counters without the overlay (read with debug.get_stats)
+    static void _cgame_debug_track_impl(bool enabled) {
+        _cgame_stats_track = enabled;
+        _cgame_debug_apply();
+    }
 
-        // Draw rectangle
-        Rectangle(_cgame_memdc, x, y, x + w, y + h);
+    // Counters of the last completed frame; false while counting is off
+    static bool _cgame_debug_get_stats_impl(CGameFrameStats* out) {
+        if (!out) return false;
+        *out = _cgame_stats_last;
+        return _cgame_stats_on;
+    }
 
-        // Restore old objects
-        SelectObject(_cgame_memdc, oldPen);
-        SelectObject(_cgame_memdc, oldBrush);
-        DeleteObject(pen);
+    // Heatmap in place of the frame (software backbuffer only); off frees the mask
+    static void _cgame_debug_overdraw_impl(bool enabled) {
+        if (enabled && !_cgame_overdraw_on) memset(&_cgame_overdraw_live, 0, sizeof(_cgame_overdraw_live));
+        _cgame_overdraw_on = enabled;
+        if (!enabled) _cgame_overdraw_free();
     }
 
+    // Pixels written per primitive type in the last completed frame; false while the heatmap is off
+    static bool _cgame_debug_get_overdraw_impl(CGameOverdrawStats* out) {
+        if (!out) return false;
+        *out = _cgame_overdraw_last;
+        return _cgame_overdraw_on;
+    }
 
-    // =========================
-    // Polygon drawing
-    // =========================
-    static void _cgame_draw_polygon_impl(const int* xs, const int* ys, int count,
-                                        int border_width, int r, int g, int b) {
-        if (!_cgame_memdc || !xs || !ys || count < 2) return;
 
-        Gdiplus::Graphics gdi(_cgame_memdc);
-        gdi.SetSmoothingMode(Gdiplus::SmoothingModeHighQuality); // optional, for smooth edges
 
-        Pen pen(Gdiplus::Color(255, r, g, b), (REAL)border_width);
 
-        Point* pts = (Point*)malloc(sizeof(Point) * count);
-        for (int i = 0; i < count; i++) {
-            pts[i] = Point(xs[i], ys[i]);
+    // =========================
+    // Built-in TrueType fonts (Win32 side)
+    //  - The parser, rasterizer and glyph caches live in the core above;
+    //    this is the file reader and the draw into the current target.
+    // =========================
+    static CGameTTF* _cgame_ttf_load_impl(const char* path) {
+        wchar_t* wpath = _cgame_utf8_to_wide_alloc(path);
+        if (!wpath) return NULL;
+        HANDLE file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, NULL);
+        free(wpath);
+        if (file == INVALID_HANDLE_VALUE) return NULL;
+
+        LARGE_INTEGER sz;
+        CGameTTF* font = NULL;
+        if (GetFileSizeEx(file, &sz) && sz.QuadPart > 0 && sz.QuadPart < 0x40000000) {
+            unsigned char* buf = (unsigned char*)_cgame_malloc((size_t)sz.QuadPart);
+            DWORD got = 0;
+            if (buf && ReadFile(file, buf, (DWORD)sz.QuadPart, &got, NULL) && got == (DWORD)sz.QuadPart)
+                font = _cgame_ttf_load_memory_impl(buf, (size_t)got);
+            free(buf);
         }
+        CloseHandle(file);
+        return font;
+    }
 
-        gdi.DrawPolygon(&pen, pts, count);
-        free(pts);
+    // (x, y) is the top of the first line; px is the em size in pixels
+    static void _cgame_ttf_draw_impl(CGameTTF* f, const char* text, int x, int y, float px, int r, int g, int b) {
+        CGAME_ZONE("ttf.draw");
+        if (!f || !text || !_cgame_rt->membits || px <= 0) return;
+        GdiFlush();
+
+        CGameSurface sf = _cgame_rt_surface();
+        float right = (float)x, bottom = (float)y;
+        double area = _cgame_ttf_draw_surface(&sf, f, text, x, y, px, r, g, b, &right, &bottom);
+        _cgame_stat_prim(CGAME_PRIM_TEXT, 0, 0, 0, 0, area);
+        if (_cgame_overdraw_begin()) {
+            int m = (int)px; // bearings and overhang stay within an em
+            _cgame_ttf_draw_impl(f, text, x, y, px, 255, 255, 255);
+            _cgame_overdraw_end(CGAME_PRIM_TEXT, x - m, y - m, (int)(right - x) + 2 * m, (int)(bottom - y) + 2 * m);
+        }
     }
 
-    static void _cgame_draw_fill_polygon_impl(const int* xs, const int* ys, int count,
-                                              int r, int g, int b) {
-        if (!_cgame_memdc || !xs || !ys || count < 3) return;
-        Gdiplus::Graphics gdi(_cgame_memdc);
-        Gdiplus::SolidBrush brush(Gdiplus::Color(255, r, g, b));
 
-        Point* pts = (Point*)malloc(sizeof(Point) * count);
-        for (int i = 0; i < count; i++) pts[i] = Point(xs[i], ys[i]);
 
-        gdi.FillPolygon(&brush, pts, count);
-        free(pts);
+    // =========================
+    // Keyboard helpers
+    // =========================
+    // All three read the frame snapshot: no syscalls, and repeated queries agree within a frame
+    static inline bool _cgame_key_bit(const unsigned long long* set, int key) {
+        return (set[(key & 0xFF) >> 6] >> (key & 63)) & 1;
     }
 
+    static bool _cgame_key_pressed_impl(int key)       { return _cgame_key_bit(_cgame_key_now, key); }
+    static bool _cgame_key_just_pressed_impl(int key)  { return _cgame_key_bit(_cgame_key_pressed, key); }
+    static bool _cgame_key_just_released_impl(int key) { return _cgame_key_bit(_cgame_key_released, key); }
+
+    static WPARAM _cgame_key_last_impl(void) { return _cgame_last_key; }
+
     // =========================
-    // Rounded rectangle drawing
+    // Timing helpers
+    //  - Ticks come from QueryPerformanceCounter in nanoseconds.
+    //  - The frame pacer keeps an absolute deadline advanced by an exact
+    //    nanosecond period, so the average rate is the requested one
+    //    (144 fps is 6944444 ns, not 6 ms). It sleeps on a waitable timer
+    //    (high resolution where available) until a slack margin before
+    //    the deadline, then spins. The slack adapts to how late the
+    //    sleeps actually wake.
     // =========================
-    static GraphicsPath* _cgame_create_rounded_rect_path(int x, int y, int w, int h, int radius) {
-        GraphicsPath* path = new GraphicsPath();
-        int diameter = radius * 2;
-        if (diameter > w) diameter = w;
-        if (diameter > h) diameter = h;
+    #define CGAME_PACE_SLACK_MIN_NS   500000LL    // 0.5 ms
+    #define CGAME_PACE_SLACK_MAX_NS   20000000LL  // 20 ms (no high-resolution timer, 15.6 ms ticks)
 
-        path->AddArc(x, y, diameter, diameter, 180, 90);
-        path->AddArc(x + w - diameter, y, diameter, diameter, 270, 90);
-        path->AddArc(x + w - diameter, y + h - diameter, diameter, diameter, 0, 90);
-        path->AddArc(x, y + h - diameter, diameter, diameter, 90, 90);
-        path->CloseFigure();
-        return path;
+    static long long _cgame_pace_deadline = 0;
+    static long long _cgame_pace_slack = 2000000LL;
+    static int       _cgame_pace_missed = 0;
+
+    static CGameTicks _cgame_time_get_ticks_impl(void) {
+        CGameTicks t;
+        t.ns = _cgame_now_ns();
+        t.ms = (unsigned long)(t.ns / 1000000);
+        return t;
     }
 
-    static void _cgame_draw_rounded_rect_impl(int x, int y, int w, int h, int radius,
-                                              int border_width, int r, int g, int b) {
-        if (!_cgame_memdc) return;
-        Gdiplus::Graphics gdi(_cgame_memdc);
-        Pen pen(Gdiplus::Color(255, r, g, b), (REAL)border_width);
-        GraphicsPath* path = _cgame_create_rounded_rect_path(x, y, w, h, radius);
-        gdi.DrawPath(&pen, path);
-        delete path;
+    static long long _cgame_time_now_ns_impl(void) { return _cgame_now_ns(); }
+
+    static void _cgame_time_set_fps_impl(int fps) {
+        _cgame_frame_period_ns = fps > 0 ? 1000000000LL / fps : 0;
+        _cgame_pace_deadline = 0;
+        _cgame_pace_missed = 0;
     }
 
-    static void _cgame_draw_rounded_fill_rect_impl(int x, int y, int w, int h, int radius,
-                                                   int r, int g, int b) {
-        if (!_cgame_memdc) return;
-        Gdiplus::Graphics gdi(_cgame_memdc);
-        Gdiplus::SolidBrush brush(Gdiplus::Color(255, r, g, b));
-        GraphicsPath* path = _cgame_create_rounded_rect_path(x, y, w, h, radius);
-        gdi.FillPath(&brush, path);
-        delete path;
+    #ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+    #define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002  // Windows 10 1803; older SDKs lack it
+    #endif
+
+    // Block for about ns nanoseconds without spinning
+    static void _cgame_pace_sleep(long long ns) {
+        if (!_cgame_pace_timer_tried) {
+            _cgame_pace_timer_tried = true;
+            _cgame_pace_timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+            if (_cgame_pace_timer) _cgame_pace_slack = CGAME_PACE_SLACK_MIN_NS * 2;
+            else _cgame_pace_timer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS); // pre-1803 Windows
+        }
+        if (_cgame_pace_timer) {
+            LARGE_INTEGER due;
+            due.QuadPart = -(ns / 100); // relative, 100 ns units
+            if (SetWaitableTimer(_cgame_pace_timer, &due, 0, NULL, NULL, FALSE)) {
+                WaitForSingleObject(_cgame_pace_timer, INFINITE);
+                return;
+            }
+        }
+        Sleep((DWORD)(ns / 1000000));
+    }
+
+    // Wait for the next frame deadline; frame_start seeds the first one
+    static void _cgame_time_delay_if_needed_impl(CGameTicks frame_start) {
+        if (_cgame_frame_period_ns <= 0) return;
+        CGAME_ZONE("time.delay_if_needed");
+        if (!_cgame_pace_deadline) _cgame_pace_deadline = frame_start.ns + _cgame_frame_period_ns;
+
+        long long now = _cgame_now_ns();
+        if (now > _cgame_pace_deadline) {
+            // Missed: a small overrun keeps the schedule, a whole frame late restarts it from now
+            _cgame_pace_missed++;
+            if (now - _cgame_pace_deadline >= _cgame_frame_period_ns) _cgame_pace_deadline = now;
+            _cgame_pace_deadline += _cgame_frame_period_ns;
+            return;
+        }
+
+        // Coarse sleep, then learn how late it woke
+        long long remaining = _cgame_pace_deadline - now;
+        if (remaining > _cgame_pace_slack) {
+            long long want = remaining - _cgame_pace_slack;
+            _cgame_pace_sleep(want);
+            long long woke = _cgame_now_ns();
+            long long over = (woke - now) - want;
+            long long slack = _cgame_pace_slack - _cgame_pace_slack / 16;  // decay towards the floor
+            if (over + CGAME_PACE_SLACK_MIN_NS > slack) slack = over + CGAME_PACE_SLACK_MIN_NS;
+            if (slack < CGAME_PACE_SLACK_MIN_NS) slack = CGAME_PACE_SLACK_MIN_NS;
+            if (slack > CGAME_PACE_SLACK_MAX_NS) slack = CGAME_PACE_SLACK_MAX_NS;
+            _cgame_pace_slack = slack;
+        }
+
+        // Spin out the remainder
+        while (_cgame_now_ns() < _cgame_pace_deadline) YieldProcessor();
+        _cgame_pace_deadline += _cgame_frame_period_ns;
     }
 
+    // Deadlines missed since the last set_fps
+    static int _cgame_time_get_missed_impl(void) { return _cgame_pace_missed; }
+
     // =========================
-    // Circle drawing (outline)
+    // Fixed-timestep loop driver
+    //  - Simulation runs in fixed ticks of 1/sim_hz from an integer
+    //    nanosecond accumulator; rendering happens once per frame with
+    //    alpha = leftover / tick for interpolating between states.
+    //  - At most max_catchup ticks run per frame; time beyond that is
+    //    dropped (and reported) instead of spiralling.
+    //  - render_fps > 0 paces frames with the timer above, 0 renders
+    //    uncapped (benchmarks). The time.set_fps pacing in force before
+    //    run is back once it returns.
     // =========================
-    static void _cgame_draw_circle_impl(int x, int y, int radius, int border_width, int r, int g, int b) {
-        if (!_cgame_memdc) return;
 
-        Gdiplus::Graphics gdi(_cgame_memdc);
-        Pen pen(Gdiplus::Color(255, r, g, b), (REAL)border_width);
+    static bool _cgame_loop_stop_flag = false;
+
+    static void _cgame_loop_stop_impl(void) { _cgame_loop_stop_flag = true; }
+
+    // Runs until cgame.loop.stop() or a quit event; events are pumped every frame
+    // (read them with event.poll / key.* / mouse.* from update)
+    static void _cgame_loop_run_impl(const CGameLoop* loop) {
+        if (!loop || !loop->update) return;
+        int       hz      = loop->sim_hz > 0 ? loop->sim_hz : 60;
+        int       catchup = loop->max_catchup > 0 ? loop->max_catchup : 8;
+        long long tick_ns = 1000000000LL / hz;
+
+        CGameLoopState st;
+        memset(&st, 0, sizeof(st));
+        st.dt = (double)tick_ns / 1e9;
+
+        long long user_period = _cgame_frame_period_ns;   // whatever time.set_fps chose, back on exit
+        _cgame_time_set_fps_impl(loop->render_fps);
+        _cgame_loop_stop_flag = false;
+        long long acc  = 0;
+        long long prev = _cgame_now_ns();
+
+        while (!_cgame_loop_stop_flag && _cgame_running) {
+            CGameTicks start = _cgame_time_get_ticks_impl();
+            acc += start.ns - prev;
+            prev = start.ns;
+
+            _cgame_event_update();
+            if (!_cgame_running) break;
+
+            st.steps = 0;
+            while (acc >= tick_ns && st.steps < catchup && !_cgame_loop_stop_flag) {
+                {
+                    CGAME_ZONE("loop.update");
+                    loop->update(&st, loop->user);
+                }
+                acc -= tick_ns;
+                st.tick++;
+                st.steps++;
+                st.time = (double)st.tick * st.dt;
+            }
+            if (acc >= tick_ns) {
+                long long drop = acc - acc % tick_ns; // keep the fraction, lose whole ticks
+                st.dropped_ns += drop;
+                acc -= drop;
+            }
 
-        // GDI+ draws ellipse from bounding box
-        int diameter = radius * 2;
-        gdi.DrawEllipse(&pen, x - radius, y - radius, diameter, diameter);
+            st.alpha = (double)acc / (double)tick_ns;
+            if (loop->render) {
+                CGAME_ZONE("loop.render");
+                loop->render(&st, loop->user);
+            }
+            _cgame_display_flip_impl();
+            st.frame++;
+            _cgame_time_delay_if_needed_impl(start);
+        }
+        _cgame_frame_period_ns = user_period;
+        _cgame_pace_deadline = 0;
     }
 
     // =========================
-    // Filled circle drawing
+    // Profiler export and summary
+    //  - Other threads may keep recording during an export; a zone
+    //    overwritten mid-read can come out torn, so export between
+    //    frames or after the workers are idle.
+    //  - Chrome trace: complete ("X") events in microseconds, one tid per
+    //    thread; open with chrome://tracing or ui.perfetto.dev.
+    //  - Binary: header, name table (u16 length + bytes each), the zones
+    //    as CGameProfileRecord[], then the frame times as int64 ns.
     // =========================
-    static void _cgame_draw_fill_circle_impl(int x, int y, int radius, int r, int g, int b) {
-        if (!_cgame_memdc) return;
+    #define CGAME_PROFILE_MAGIC   0x46504743u // "CGPF"
+    #define CGAME_PROFILE_VERSION 1
 
-        Gdiplus::Graphics gdi(_cgame_memdc);
-        Gdiplus::SolidBrush brush(Gdiplus::Color(255, r, g, b));
+    typedef struct {
+        unsigned int magic;
+        unsigned int version;
+        unsigned int name_count;
+        unsigned int zone_count;
+        unsigned int frame_count;
+        unsigned int record_size;
+    } CGameProfileFileHeader;
 
-        int diameter = radius * 2;
-        gdi.FillEllipse(&brush, x - radius, y - radius, diameter, diameter);
+    typedef struct {
+        long long    start_ns;
+        long long    dur_ns;
+        unsigned int name;       // index into the name table
+        unsigned int tid;
+        unsigned int depth;
+        unsigned int reserved;
+    } CGameProfileRecord;        // 32 bytes on disk, little-endian
+
+
+    typedef struct {
+        HANDLE       file;
+        bool         ok;
+        unsigned int len;
+        char         buf[65536];
+    } CGameProfileWriter;
+
+    // Distinct zone names; every pointer seen maps to a slot, equal strings share one
+    typedef struct {
+        const char** ptrs;
+        int*         slot;
+        int          ptr_count, cap;
+        const char** names;
+        int          name_count;
+    } CGameProfileNames;
+
+    static int _cgame_prof_name_slot(CGameProfileNames* n, const char* name) {
+        for (int i = 0; i < n->ptr_count; ++i)
+            if (n->ptrs[i] == name) return n->slot[i];
+        if (n->ptr_count == n->cap) {
+            int cap = n->cap ? n->cap * 2 : 64;
+            const char** ptrs  = (const char**)_cgame_realloc(n->ptrs,  sizeof(const char*) * cap);
+            if (ptrs) n->ptrs = ptrs;
+            int*         slot  = (int*)_cgame_realloc(n->slot, sizeof(int) * cap);
+            if (slot) n->slot = slot;
+            const char** names = (const char**)_cgame_realloc(n->names, sizeof(const char*) * cap);
+            if (names) n->names = names;
+            if (!ptrs || !slot || !names) return -1;
+            n->cap = cap;
+        }
+        int s = 0;
+        while (s < n->name_count && strcmp(n->names[s], name) != 0) s++;
+        if (s == n->name_count) n->names[n->name_count++] = name;
+        n->ptrs[n->ptr_count] = name;
+        n->slot[n->ptr_count++] = s;
+        return s;
     }
 
+    static void _cgame_prof_names_free(CGameProfileNames* n) {
+        free(n->ptrs);
+        free(n->slot);
+        free(n->names);
+        memset(n, 0, sizeof(*n));
+    }
 
+    // Oldest recorded zone of t and how many there are
+    static unsigned int _cgame_prof_span(const CGameProfileThread* t, unsigned int* first) {
+        unsigned int head = t->head;
+        MemoryBarrier();
+        bool full = t->full;
+        *first = full ? head : 0;
+        return full ? CGAME_PROFILE_RING : head;
+    }
 
-    // =========================
-    // Events
-    // =========================
-    static int _cgame_event_get(void) {
-        MSG msg;
-        // Keep checking until we find an event we care about
-        while (PeekMessageW(&msg, NULL, 0, 0, PM_REMOVE)) {
-            if (msg.message == WM_QUIT) {
-                _cgame_running = false;
-                return CGAME_QUIT;
-            }
-            TranslateMessage(&msg);
-            DispatchMessageW(&msg);
+    static unsigned int _cgame_prof_thread_total(void) {
+        LONG n = _cgame_prof_thread_count;
+        return n > CGAME_PROFILE_THREADS ? CGAME_PROFILE_THREADS : (unsigned int)n;
+    }
 
-            if (_cgame_event != 0) {
-                int ev = _cgame_event;
-                _cgame_event = 0; // clear AFTER we grab it
-                return ev;
-            }
+    static bool _cgame_prof_open(CGameProfileWriter* w, const char* path) {
+        wchar_t* wpath = path ? _cgame_utf8_to_wide_alloc(path) : NULL;
+        if (!wpath) return false;
+        w->file = CreateFileW(wpath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        free(wpath);
+        w->ok  = w->file != INVALID_HANDLE_VALUE;
+        w->len = 0;
+        return w->ok;
+    }
+
+    static void _cgame_prof_flush(CGameProfileWriter* w) {
+        DWORD written = 0;
+        if (w->ok && w->len) w->ok = WriteFile(w->file, w->buf, w->len, &written, NULL) && written == w->len;
+        w->len = 0;
+    }
+
+    static void _cgame_prof_write(CGameProfileWriter* w, const void* data, unsigned int size) {
+        const char* p = (const char*)data;
+        while (size) {
+            if (w->len == sizeof(w->buf)) _cgame_prof_flush(w);
+            unsigned int n = (unsigned int)sizeof(w->buf) - w->len;
+            if (n > size) n = size;
+            memcpy(w->buf + w->len, p, n);
+            w->len += n;
+            p      += n;
+            size   -= n;
         }
-        return 0; // no event
     }
 
-    // =========================
-    // Text rendering
-    // =========================
-    static void _cgame_text_draw_impl(const char* text, int x, int y, int r, int g, int b) {
-        if (!_cgame_memdc || !text) return;
+    static void _cgame_prof_puts(CGameProfileWriter* w, const char* s) {
+        _cgame_prof_write(w, s, (unsigned int)strlen(s));
+    }
 
-        Gdiplus::Graphics gdi(_cgame_memdc);
-        Gdiplus::SolidBrush brush(Gdiplus::Color(255, r, g, b));
-        Font font(L"Arial", 16); // default font, size 16
-        WCHAR wtext[512];
-        MultiByteToWideChar(CP_UTF8, 0, text, -1, wtext, 512);
-        gdi.DrawString(wtext, -1, &font, PointF((REAL)x, (REAL)y), &brush);
+    static bool _cgame_prof_close(CGameProfileWriter* w) {
+        _cgame_prof_flush(w);
+        CloseHandle(w->file);
+        return w->ok;
     }
 
-    // Load custom font (TTF file)
-    static bool _cgame_text_load_font_impl(const char* path) {
-        if (!path) return false;
-        int wlen = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
-        WCHAR* wpath = (WCHAR*)malloc(wlen * sizeof(WCHAR));
-        MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, wlen);
+    // JSON string body: quotes, backslashes and control characters escaped
+    static void _cgame_prof_json_string(CGameProfileWriter* w, const char* s) {
+        for (; *s; ++s) {
+            unsigned char c = (unsigned char)*s;
+            char esc[8];
+            if (c == '"' || c == '\\') {
+                esc[0] = '\\'; esc[1] = (char)c;
+                _cgame_prof_write(w, esc, 2);
+            } else if (c < 0x20) {
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                _cgame_prof_write(w, esc, 6);
+            } else {
+                _cgame_prof_write(w, &c, 1);
+            }
+        }
+    }
 
-        if (_cgame_font_collection.AddFontFile(wpath) != Gdiplus::Ok) {
-            free(wpath);
+    static bool _cgame_profile_export_chrome_impl(const char* path) {
+        CGameProfileWriter* w = (CGameProfileWriter*)_cgame_malloc(sizeof(CGameProfileWriter));
+        if (!w) return false;
+        if (!_cgame_prof_open(w, path)) {
+            free(w);
             return false;
         }
-        free(wpath);
-        return true;
+
+        _cgame_prof_puts(w, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first_event = true;
+        char line[160];
+        unsigned int threads = _cgame_prof_thread_total();
+        for (unsigned int ti = 0; ti < threads; ++ti) {
+            const CGameProfileThread* t = _cgame_prof_threads[ti];
+            if (!t) continue;
+            unsigned int first, n = _cgame_prof_span(t, &first);
+            for (unsigned int i = 0; i < n; ++i) {
+                const CGameProfileZone* z = &t->ring[(first + i) & (CGAME_PROFILE_RING - 1)];
+                _cgame_prof_puts(w, first_event ? "{\"name\":\"" : ",\n{\"name\":\"");
+                first_event = false;
+                _cgame_prof_json_string(w, z->name);
+                // ns → µs with three decimals, kept integral to avoid float rounding
+                snprintf(line, sizeof(line),
+                         "\",\"cat\":\"cgame\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%lld.%03lld,\"dur\":%lld.%03lld}",
+                         (unsigned long)t->tid, z->start_ns / 1000, z->start_ns % 1000,
+                         z->dur_ns / 1000, z->dur_ns % 1000);
+                _cgame_prof_puts(w, line);
+            }
+        }
+        _cgame_prof_puts(w, "\n]}\n");
+
+        bool ok = _cgame_prof_close(w);
+        free(w);
+        return ok;
     }
 
-    // Draw text with loaded TTF font
-    static void _cgame_text_draw_complex_impl(const char* text, int x, int y,
-                                              const wchar_t* fontName, float size,
-                                              int r, int g, int b) {
-        if (!_cgame_memdc || !text || !fontName) return;
+    static bool _cgame_profile_export_binary_impl(const char* path) {
+        CGameProfileWriter* w = (CGameProfileWriter*)_cgame_malloc(sizeof(CGameProfileWriter));
+        if (!w) return false;
+
+        // Snapshot the rings first so the header counts match what follows
+        unsigned int threads = _cgame_prof_thread_total();
+        size_t total = 0;
+        for (unsigned int ti = 0; ti < threads; ++ti) total += _cgame_prof_threads[ti] ? CGAME_PROFILE_RING : 0;
+        CGameProfileRecord* recs = (CGameProfileRecord*)_cgame_malloc(sizeof(CGameProfileRecord) * (total ? total : 1));
+        CGameProfileNames names;
+        memset(&names, 0, sizeof(names));
+        bool ok = recs != NULL;
+
+        unsigned int count = 0;
+        for (unsigned int ti = 0; ok && ti < threads; ++ti) {
+            const CGameProfileThread* t = _cgame_prof_threads[ti];
+            if (!t) continue;
+            unsigned int first, n = _cgame_prof_span(t, &first);
+            for (unsigned int i = 0; ok && i < n; ++i) {
+                const CGameProfileZone* z = &t->ring[(first + i) & (CGAME_PROFILE_RING - 1)];
+                int slot = _cgame_prof_name_slot(&names, z->name);
+                ok = slot >= 0;
+                CGameProfileRecord* r = &recs[count++];
+                r->start_ns = z->start_ns;
+                r->dur_ns   = z->dur_ns;
+                r->name     = (unsigned int)slot;
+                r->tid      = (unsigned int)t->tid;
+                r->depth    = (unsigned int)z->depth;
+                r->reserved = 0;
+            }
+        }
+
+        if (ok && _cgame_prof_open(w, path)) {
+            unsigned int frames = _cgame_prof_frame_count < CGAME_PROFILE_FRAMES ? _cgame_prof_frame_count : CGAME_PROFILE_FRAMES;
+            CGameProfileFileHeader hdr = { CGAME_PROFILE_MAGIC, CGAME_PROFILE_VERSION, (unsigned int)names.name_count,
+                                           count, frames, (unsigned int)sizeof(CGameProfileRecord) };
+            _cgame_prof_write(w, &hdr, sizeof(hdr));
+            for (int i = 0; i < names.name_count; ++i) {
+                size_t len = strlen(names.names[i]);
+                unsigned short len16 = (unsigned short)(len > 0xFFFF ? 0xFFFF : len);
+                _cgame_prof_write(w, &len16, sizeof(len16));
+                _cgame_prof_write(w, names.names[i], len16);
+            }
+            _cgame_prof_write(w, recs, (unsigned int)(sizeof(CGameProfileRecord) * count));
+            for (unsigned int i = 0; i < frames; ++i) {
+                unsigned int at = (_cgame_prof_frame_count - frames + i) % CGAME_PROFILE_FRAMES; // oldest first
+                _cgame_prof_write(w, &_cgame_prof_frames[at], sizeof(long long));
+            }
+            ok = _cgame_prof_close(w);
+        } else {
+            ok = false;
+        }
 
-        Gdiplus::Graphics gdi(_cgame_memdc);
-        Gdiplus::SolidBrush brush(Gdiplus::Color(255, r, g, b));
-        FontFamily family(fontName, &_cgame_font_collection);
-        Font font(&family, size, Gdiplus::FontStyleRegular, UnitPixel);
+        _cgame_prof_names_free(&names);
+        free(recs);
+        free(w);
+        return ok;
+    }
 
-        WCHAR wtext[512];
-        MultiByteToWideChar(CP_UTF8, 0, text, -1, wtext, 512);
-        gdi.DrawString(wtext, -1, &font, PointF((REAL)x, (REAL)y), &brush);
+    static int _cgame_prof_cmp_ll(const void* a, const void* b) {
+        long long x = *(const long long*)a, y = *(const long long*)b;
+        return x < y ? -1 : x > y;
     }
 
+    // Frame-time percentiles (nearest rank) over the kept frames; false before two flips
+    static bool _cgame_profile_summary_impl(CGameProfileSummary* out) {
+        if (!out) return false;
+        memset(out, 0, sizeof(*out));
+        unsigned int n = _cgame_prof_frame_count < CGAME_PROFILE_FRAMES ? _cgame_prof_frame_count : CGAME_PROFILE_FRAMES;
+        if (!n) return false;
+
+        long long* sorted = (long long*)_cgame_malloc(sizeof(long long) * n);
+        if (!sorted) return false;
+        memcpy(sorted, _cgame_prof_frames, sizeof(long long) * n); // slots 0..n-1 are exactly the kept frames
+        qsort(sorted, n, sizeof(long long), _cgame_prof_cmp_ll);
+
+        long long sum = 0;
+        for (unsigned int i = 0; i < n; ++i) sum += sorted[i];
+        out->frames = (int)n;
+        out->avg_ms = (double)sum / n / 1e6;
+        out->p50_ms = sorted[(n * 50 + 99) / 100 - 1] / 1e6;
+        out->p95_ms = sorted[(n * 95 + 99) / 100 - 1] / 1e6;
+        out->p99_ms = sorted[(n * 99 + 99) / 100 - 1] / 1e6;
+        out->max_ms = sorted[n - 1] / 1e6;
+        free(sorted);
+        return true;
+    }
 
+    typedef struct {
+        int       name;
+        int       count;
+        long long total_ns;
+        long long max_ns;
+    } CGameProfileTotal;
+
+    static int _cgame_prof_cmp_total(const void* a, const void* b) {
+        long long x = ((const CGameProfileTotal*)a)->total_ns, y = ((const CGameProfileTotal*)b)->total_ns;
+        return x > y ? -1 : x < y; // largest first
+    }
 
+    // Frame percentiles, then every zone name by total time, to stdout
+    static void _cgame_profile_print_summary_impl(void) {
+        CGameProfileSummary s;
+        if (_cgame_profile_summary_impl(&s)) {
+            printf("cgame profile: %d frames  avg %.3f ms  p50 %.3f  p95 %.3f  p99 %.3f  max %.3f ms\n",
+                   s.frames, s.avg_ms, s.p50_ms, s.p95_ms, s.p99_ms, s.max_ms);
+        } else {
+            printf("cgame profile: no frames recorded\n");
+        }
 
-    // =========================
-    // Keyboard helpers
-    // =========================
-    static bool _cgame_key_pressed_impl(int key) {
-        if ((key & 0xFF) >= 512) return false;
-        return _cgame_key_state[key & 0xFF];
-    }
+        CGameProfileNames names;
+        memset(&names, 0, sizeof(names));
+        CGameProfileTotal* totals = NULL;
+        int cap = 0;
+        unsigned int threads = _cgame_prof_thread_total();
+        for (unsigned int ti = 0; ti < threads; ++ti) {
+            const CGameProfileThread* t = _cgame_prof_threads[ti];
+            if (!t) continue;
+            unsigned int first, n = _cgame_prof_span(t, &first);
+            for (unsigned int i = 0; i < n; ++i) {
+                const CGameProfileZone* z = &t->ring[(first + i) & (CGAME_PROFILE_RING - 1)];
+                int slot = _cgame_prof_name_slot(&names, z->name);
+                if (slot < 0) continue;
+                if (slot >= cap) {
+                    int ncap = names.cap;
+                    CGameProfileTotal* grown = (CGameProfileTotal*)_cgame_realloc(totals, sizeof(CGameProfileTotal) * ncap);
+                    if (!grown) continue;
+                    memset(grown + cap, 0, sizeof(CGameProfileTotal) * (ncap - cap));
+                    totals = grown;
+                    cap = ncap;
+                }
+                CGameProfileTotal* tot = &totals[slot];
+                tot->name = slot;
+                tot->count++;
+                tot->total_ns += z->dur_ns;
+                if (z->dur_ns > tot->max_ns) tot->max_ns = z->dur_ns;
+            }
+        }
 
-    static bool _cgame_key_just_pressed_impl(int key) {
-        if ((key & 0xFF) >= 512) return false;
-        SHORT result = GetAsyncKeyState(key);
-        bool now = (result & 0x8000) != 0;
-        bool was = _cgame_key_prev_async[key & 0xFF];
-        _cgame_key_prev_async[key & 0xFF] = now;
-        return now && !was;
+        if (totals) {
+            qsort(totals, names.name_count, sizeof(CGameProfileTotal), _cgame_prof_cmp_total);
+            printf("  %-28s %10s %12s %10s %10s\n", "zone", "count", "total ms", "avg us", "max us");
+            for (int i = 0; i < names.name_count; ++i) {
+                const CGameProfileTotal* tot = &totals[i];
+                if (!tot->count) continue;
+                printf("  %-28s %10d %12.3f %10.2f %10.2f\n", names.names[tot->name], tot->count,
+                       tot->total_ns / 1e6, tot->total_ns / 1e3 / tot->count, tot->max_ns / 1e3);
+            }
+        }
+        fflush(stdout);
+        free(totals);
+        _cgame_prof_names_free(&names);
     }
 
-    static bool _cgame_key_just_released_impl(int key) {
-        if ((key & 0xFF) >= 512) return false;
-        SHORT result = GetAsyncKeyState(key);
-        bool now = (result & 0x8000) != 0;
-        bool was = _cgame_key_prev_async[key & 0xFF];
-        _cgame_key_prev_async[key & 0xFF] = now;
-        return !now && was;
+    static void _cgame_profile_enable_impl(bool enabled) {
+        if (enabled && !_cgame_prof_enabled) _cgame_prof_last_flip = 0; // don't count the gap as a frame
+        _cgame_prof_enabled = enabled;
     }
 
-    static WPARAM _cgame_key_last_impl(void) { return _cgame_last_key; }
+    static bool _cgame_profile_enabled_impl(void) { return _cgame_prof_enabled; }
 
-    // =========================
-    // Timing helpers
-    // =========================
-    static unsigned long _cgame_start_ticks = 0;
-    static unsigned long _cgame_frame_delay = 0;
+    // profile.begin/end pairs: one bit per open begin, set when it opened a zone, so end
+    // closes only what its begin opened even if profiling was toggled in between
+    static thread_local unsigned long long _cgame_prof_manual_open = 0;
+    static thread_local int                _cgame_prof_manual_depth = 0;
 
-    static CGameTicks _cgame_time_get_ticks_impl(void) {
-        CGameTicks t;
-        t.ms = GetTickCount() - _cgame_start_ticks;
-        return t;
+    static void _cgame_profile_begin_impl(const char* name) {
+        int d = _cgame_prof_manual_depth++;
+        if (d >= 64) return; // too deep to track: not recorded
+        bool opened = _cgame_prof_enabled && name && _cgame_prof_thread();
+        if (opened) _cgame_prof_begin(name);
+        if (opened) _cgame_prof_manual_open |= 1ull << d;
+        else        _cgame_prof_manual_open &= ~(1ull << d);
     }
 
-    static void _cgame_time_set_fps_impl(int fps) {
-        if (fps > 0) {
-            _cgame_frame_delay = 1000 / fps;
-        } else {
-            _cgame_frame_delay = 0;
-        }
+    static void _cgame_profile_end_impl(void) {
+        if (_cgame_prof_manual_depth <= 0) return;
+        int d = --_cgame_prof_manual_depth;
+        if (d < 64 && ((_cgame_prof_manual_open >> d) & 1)) _cgame_prof_end();
     }
 
-    static void _cgame_time_delay_if_needed_impl(CGameTicks frame_start) {
-        if (_cgame_frame_delay > 0) {
-            unsigned long elapsed = (GetTickCount() - _cgame_start_ticks) - frame_start.ms;
-            if (elapsed < _cgame_frame_delay) {
-                Sleep(_cgame_frame_delay - elapsed);
-            }
+    // Forget recorded zones and frame times (buffers are kept)
+    static void _cgame_profile_reset_impl(void) {
+        unsigned int threads = _cgame_prof_thread_total();
+        for (unsigned int ti = 0; ti < threads; ++ti) {
+            CGameProfileThread* t = _cgame_prof_threads[ti];
+            if (!t) continue;
+            t->full = false;
+            t->head = 0;
         }
+        _cgame_prof_frame_count = 0;
+        _cgame_prof_last_flip = 0;
     }
 
 
@@ -1389,23 +7112,17 @@
     // =========================
     static bool _cgame_mouse_pressed_impl(int button) {
         if (button < 1 || button > 5) return false;
-        return _cgame_mouse_state[button];
+        return (_cgame_mouse_now >> button) & 1;
     }
 
     static bool _cgame_mouse_just_pressed_impl(int button) {
         if (button < 1 || button > 5) return false;
-        bool now = _cgame_mouse_state[button];
-        bool was = _cgame_mouse_prev[button];
-        _cgame_mouse_prev[button] = now;
-        return now && !was;
+        return (_cgame_mouse_pressed >> button) & 1;
     }
 
     static bool _cgame_mouse_just_released_impl(int button) {
         if (button < 1 || button > 5) return false;
-        bool now = _cgame_mouse_state[button];
-        bool was = _cgame_mouse_prev[button];
-        _cgame_mouse_prev[button] = now;
-        return !now && was;
+        return (_cgame_mouse_released >> button) & 1;
     }
 
     static void _cgame_mouse_get_pos_impl(int* x, int* y) {
@@ -1424,11 +7141,50 @@
     }
 
     static int _cgame_mouse_get_wheel_impl(void) {
-        int delta = _cgame_mouse_wheel;
-        _cgame_mouse_wheel = 0; // reset after read
+        int delta = _cgame_mouse_wheel / WHEEL_DELTA;
+        _cgame_mouse_wheel -= delta * WHEEL_DELTA; // whole notches since the last read, fractions carry over
         return delta;
     }
 
+    // Every cursor position seen this frame, oldest first; returns the number copied (out == NULL: available)
+    static int _cgame_mouse_get_motion_impl(CGameMotionSample* out, int max) {
+        if (!out) return _cgame_motion_frame_count;
+        int n = _cgame_motion_frame_count < max ? _cgame_motion_frame_count : max;
+        if (n > 0) memcpy(out, _cgame_motion_frame, sizeof(CGameMotionSample) * n);
+        return n < 0 ? 0 : n;
+    }
+
+    // Wheel movement this frame in notches, fractional for high-resolution wheels
+    static void _cgame_mouse_get_wheel_delta_impl(float* dx, float* dy) {
+        if (dx) *dx = (float)_cgame_wheel_frame_x / WHEEL_DELTA;
+        if (dy) *dy = (float)_cgame_wheel_frame_y / WHEEL_DELTA;
+    }
+
+    // Recover the intermediate points Windows coalesces between WM_MOUSEMOVE messages
+    static void _cgame_mouse_set_full_rate_impl(bool enabled) {
+        _cgame_mouse_full_rate = enabled;
+        _cgame_mmp_valid = false;
+    }
+
+    // Unaccelerated device counts via raw input (CGAME_MOUSERAW events + mouse.get_raw_delta)
+    static bool _cgame_mouse_set_raw_impl(bool enabled) {
+        if (enabled == _cgame_mouse_raw) return true;
+        if (!_cgame_screen.hwnd) {
+            _cgame_mouse_raw = enabled; // headless: only injected / replayed raw motion
+            return true;
+        }
+        // registered by the window's own thread (the pump thread under CGAME_THREADED_EVENTS)
+        if (!SendMessageW(_cgame_screen.hwnd, CGAME_WM_SET_RAW, enabled, 0)) return false;
+        _cgame_mouse_raw = enabled;
+        return true;
+    }
+
+    // Raw motion summed over this frame
+    static void _cgame_mouse_get_raw_delta_impl(int* dx, int* dy) {
+        if (dx) *dx = _cgame_raw_frame_dx;
+        if (dy) *dy = _cgame_raw_frame_dy;
+    }
+
     // =========================
     // Customization helpers
     // =========================
@@ -1465,7 +7221,7 @@
 
         // Load .ico from file
         int wlen = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
-        WCHAR* wpath = (WCHAR*)malloc(wlen * sizeof(WCHAR));
+        WCHAR* wpath = (WCHAR*)_cgame_malloc(wlen * sizeof(WCHAR));
         MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, wlen);
 
         HICON hIcon = (HICON)LoadImageW(NULL, wpath, IMAGE_ICON, 0, 0,
@@ -1507,132 +7263,12 @@
 #error "cgame.h only supports Windows"
 #endif
 
-// |---------------------------------------------------------------------------|
-//     []   [][][] []  [] [][]   []     [][][]  [][]       []   [][][] [][][]
-//      []  []  [] []  [] []  [] []       []   []        []  [] []  []   []
-// [][][][] [][][] []  [] [][]   []       []   []        [][][] [][][]   []
-//      []  []     []  [] []  [] []       []   []        []  [] []       []
-//     []   []      [][]  [][]   [][][] [][][]  [][]     []  [] []     [][][]
-// |---------------------------------------------------------------------------|
-
-    static struct {
-        void (*init)(void);
-        void (*quit)(void);
-
-        struct {
-            CGameScreen (*set_mode)(int w, int h, int flags);
-            void (*set_bgcolor)(int r, int g, int b);
-            void (*clear)(void);
-            void (*flip)(void);
-            int  (*get_width)(void);
-            int  (*get_height)(void);
-            void (*set_title)(const char* title);
-            bool (*set_icon)(const char* path);
-            bool (*set_icon_from_image)(const CGameImage* img);
-        } display;
-
-        // console reset and set color
-        struct {
-            void (*set_color)(int fg, int bg);
-            void (*reset_color)(void);
-        } console;
-
-        // msg box show 
-        struct {
-            int (*show)(const wchar_t* title, const wchar_t* text, unsigned int type);
-        } messagebox;
-
-
-        struct {
-            int (*get)(void);
-        } event;
-
-        // keyboard api
-        struct {
-            bool (*pressed)(int key);
-            bool (*just_pressed)(int key);
-            bool (*just_released)(int key);
-            WPARAM (*get_last)(void);
-        } key;
-
-        // mouse api
-        struct {
-            bool (*pressed)(int button);
-            bool (*just_pressed)(int button);
-            bool (*just_released)(int button);
-            void (*get_pos)(int* x, int* y);
-            void (*set_pos)(int x, int y);
-            int  (*get_wheel)(void);
-        } mouse;
-
-        // polygon draw api
-        struct {
-            void (*rect)(int x, int y, int w, int h, int border_width, int r, int g, int b);
-            void (*fill_rect)(int x, int y, int w, int h, int r, int g, int b);
-            void (*polygon)(const int* xs, const int* ys, int count, int border_width, int r, int g, int b);
-            void (*fill_polygon)(const int* xs, const int* ys, int count, int r, int g, int b);
-            void (*rounded_rect)(int x, int y, int w, int h, int radius, int border_width,
-                                 int r, int g, int b);
-            void (*rounded_fill_rect)(int x, int y, int w, int h, int radius,
-                                      int r, int g, int b);
-            void (*circle)(int x, int y, int radius, int border_width, int r, int g, int b);
-            void (*fill_circle)(int x, int y, int radius, int r, int g, int b);
-
-        } draw;
-
-
-        // image api
-        struct {
-            CGameImage (*load)(const char* path);
-            void (*unload)(CGameImage* img);
-            void (*draw)(const CGameImage* img, int x, int y);
-            void (*draw_scaled)(const CGameImage* img, int x, int y, int w, int h);
-            CGameImage (*resize)(const CGameImage* src, int w, int h);
-            CGameImage (*flip_horizontal)(const CGameImage* img);
-            CGameImage (*flip_vertical)(const CGameImage* img);
-            int (*get_width)(const CGameImage* img);
-            int (*get_height)(const CGameImage* img);
-            int (*get_channels)(const CGameImage* img);
-            void (*draw_rotated)(const CGameImage* img, int x, int y, float angle_deg);
-            CGameImage (*rotate)(const CGameImage *src, float angle_deg);
-
-        } image;
-
-        // timing
-        struct {
-            CGameTicks (*get_ticks)(void);
-            void  (*set_fps)(int fps);
-            void  (*delay_if_needed)(CGameTicks frame_start);
-        } time;
-
-
-        // text rendering
-        struct {
-            void (*draw)(const char* text, int x, int y, int r, int g, int b);
-            void (*draw_complex)(const char* text, int x, int y,
-                                 const wchar_t* fontName, float size,
-                                 int r, int g, int b);
-            bool (*load_font)(const char* path);
-        } text;
-
-
-
-
-        struct {
-            int (*get)(void);
-        } event2;
-
-        int QUIT;
-        int VIDEORESIZE;
-        int KEYDOWN;
-        int KEYUP;
+// The API table and its bindings exist only where a platform block implements them
+#if defined(_WIN32) || defined(_WIN64)
 
-        int K_a, K_b, K_c, K_d, K_e, K_f, K_g, K_h, K_i, K_j, K_k, 
-        K_l, K_m, K_n, K_o, K_p, K_q, K_r, K_s, K_t, K_u, K_v, 
-        K_w, K_x, K_y, K_z,
-        K_0, K_1, K_2, K_3, K_4, K_5, K_6, K_7, K_8, K_9,
-        K_SPACE, K_RETURN, K_ESCAPE, K_LEFT, K_RIGHT, K_UP, K_DOWN;
-    } cgame;
+    #if defined(CGAME_SHARED)
+    CGameAPI cgame;
+    #endif
 
     // =========================
     // Initialize function table
@@ -1651,7 +7287,34 @@
         cgame.display.flip                = _cgame_display_flip_impl;
         cgame.display.get_width           = _cgame_display_get_width;
         cgame.display.get_height          = _cgame_display_get_height;
+        cgame.display.get_pixels          = _cgame_display_get_pixels;
+
+        cgame.context.create              = _cgame_context_create_impl;
+        cgame.context.destroy             = _cgame_context_destroy_impl;
+        cgame.context.make_current        = _cgame_context_make_current_impl;
+        cgame.context.current             = _cgame_context_current_impl;
+
+        cgame.jobs.run                    = _cgame_jobs_run_impl;
+        cgame.jobs.wait                   = _cgame_jobs_wait_impl;
+        cgame.jobs.parallel_for           = _cgame_parallel_for;
+        cgame.jobs.worker_count           = _cgame_jobs_worker_count_impl;
+        cgame.jobs.set_worker_count       = _cgame_jobs_set_worker_count_impl;
+        cgame.jobs.thread_index           = _cgame_jobs_thread_index_impl;
+
+        cgame.arena.alloc                 = _cgame_arena_alloc;
+        cgame.arena.used                  = _cgame_arena_used_impl;
+        cgame.arena.reset                 = _cgame_arena_reset_impl;
+
         cgame.event.get                   = _cgame_event_get;
+        cgame.event.poll                  = _cgame_event_poll;
+        cgame.event.drain                 = _cgame_event_drain;
+        cgame.event.dropped               = _cgame_event_dropped_impl;
+        cgame.event.inject                = _cgame_event_inject_impl;
+        cgame.record.start                = _cgame_record_start_impl;
+        cgame.record.stop                 = _cgame_record_stop_impl;
+        cgame.replay.start                = _cgame_replay_start_impl;
+        cgame.replay.stop                 = _cgame_replay_stop_impl;
+        cgame.replay.active               = _cgame_replay_active_impl;
 
         //  console 
         cgame.console.set_color           = _cgame_console_set_color;
@@ -1673,6 +7336,11 @@
         cgame.mouse.get_pos               = _cgame_mouse_get_pos_impl;
         cgame.mouse.set_pos               = _cgame_mouse_set_pos_impl;
         cgame.mouse.get_wheel             = _cgame_mouse_get_wheel_impl;
+        cgame.mouse.get_motion            = _cgame_mouse_get_motion_impl;
+        cgame.mouse.get_wheel_delta       = _cgame_mouse_get_wheel_delta_impl;
+        cgame.mouse.set_full_rate         = _cgame_mouse_set_full_rate_impl;
+        cgame.mouse.set_raw               = _cgame_mouse_set_raw_impl;
+        cgame.mouse.get_raw_delta         = _cgame_mouse_get_raw_delta_impl;
 
         // polygon drawing API bindings
         cgame.draw.fill_rect              = _cgame_draw_fillrect_impl;
@@ -1694,20 +7362,72 @@
         cgame.image.rotate                = _cgame_image_rotate_impl;
         cgame.image.flip_horizontal       = _cgame_image_flip_horizontal_impl;
         cgame.image.flip_vertical         = _cgame_image_flip_vertical_impl;
+        cgame.image.blur_box              = _cgame_image_blur_box_impl;
+        cgame.image.blur_gaussian         = _cgame_image_blur_gaussian_impl;
+        cgame.image.color_matrix          = _cgame_image_color_matrix_impl;
         cgame.image.get_width             = _cgame_image_get_width_impl;
         cgame.image.get_height            = _cgame_image_get_height_impl;
         cgame.image.get_channels          = _cgame_image_get_channels_impl;
 
+        // asset pack API bindings
+        cgame.pack.build                  = _cgame_pack_build_impl;
+        cgame.pack.open                   = _cgame_pack_open_impl;
+        cgame.pack.close                  = _cgame_pack_close_impl;
+        cgame.pack.count                  = _cgame_pack_count_impl;
+        cgame.pack.name                   = _cgame_pack_name_impl;
+        cgame.pack.find                   = _cgame_pack_find_impl;
+        cgame.pack.get                    = _cgame_pack_get_impl;
+        cgame.pack.get_index              = _cgame_pack_get_index_impl;
+
+        // image cache API bindings
+        cgame.cache.acquire               = _cgame_cache_acquire_impl;
+        cgame.cache.release               = _cgame_cache_release_impl;
+        cgame.cache.set_budget            = _cgame_cache_set_budget_impl;
+        cgame.cache.get_usage             = _cgame_cache_get_usage_impl;
+        cgame.cache.get_count             = _cgame_cache_get_count_impl;
+        cgame.cache.purge                 = _cgame_cache_purge_impl;
+
         // timing API bidings
-        _cgame_start_ticks                = GetTickCount();
         cgame.time.get_ticks              = _cgame_time_get_ticks_impl;
         cgame.time.set_fps                = _cgame_time_set_fps_impl;
         cgame.time.delay_if_needed        = _cgame_time_delay_if_needed_impl;
+        cgame.time.now_ns                 = _cgame_time_now_ns_impl;
+        cgame.time.get_missed             = _cgame_time_get_missed_impl;
+        cgame.loop.run                    = _cgame_loop_run_impl;
+        cgame.loop.stop                   = _cgame_loop_stop_impl;
+
+        // profiler API bindings
+        cgame.profile.enable              = _cgame_profile_enable_impl;
+        cgame.profile.enabled             = _cgame_profile_enabled_impl;
+        cgame.profile.begin               = _cgame_profile_begin_impl;
+        cgame.profile.end                 = _cgame_profile_end_impl;
+        cgame.profile.reset               = _cgame_profile_reset_impl;
+        cgame.profile.export_chrome       = _cgame_profile_export_chrome_impl;
+        cgame.profile.export_binary       = _cgame_profile_export_binary_impl;
+        cgame.profile.summary             = _cgame_profile_summary_impl;
+        cgame.profile.print_summary       = _cgame_profile_print_summary_impl;
+        cgame.debug.hud                   = _cgame_debug_hud_impl;
+        cgame.debug.track                 = _cgame_debug_track_impl;
+        cgame.debug.get_stats             = _cgame_debug_get_stats_impl;
+        cgame.debug.overdraw              = _cgame_debug_overdraw_impl;
+        cgame.debug.get_overdraw          = _cgame_debug_get_overdraw_impl;
 
         // text API bindings
         cgame.text.draw         = _cgame_text_draw_impl;
         cgame.text.draw_complex = _cgame_text_draw_complex_impl;
         cgame.text.load_font    = _cgame_text_load_font_impl;
+        cgame.text.measure      = _cgame_text_measure_impl;
+        cgame.text.draw_wrapped = _cgame_text_draw_wrapped_impl;
+        cgame.text.draw_fast       = _cgame_text_draw_fast_impl;
+        cgame.text.draw_fast_int   = _cgame_text_draw_fast_int_impl;
+        cgame.text.draw_fast_float = _cgame_text_draw_fast_float_impl;
+
+        // TrueType API bindings
+        cgame.ttf.load          = _cgame_ttf_load_impl;
+        cgame.ttf.load_memory   = _cgame_ttf_load_memory_impl;
+        cgame.ttf.unload        = _cgame_ttf_free_impl;
+        cgame.ttf.set_sdf       = _cgame_ttf_set_sdf_impl;
+        cgame.ttf.draw          = _cgame_ttf_draw_impl;
 
 
         // MAJOR EVENTSSSSSSSSSSS....
@@ -1764,6 +7484,280 @@
     }
 
     static int _cgame_dummy_init = (_cgame_init_struct(), 0);
+
+    // =========================
+    // Direct C++ API
+    //  - CGame::<group>::<name> mirrors cgame.<group>.<name> but calls the
+    //    implementation directly, so calls can be inlined and folded into
+    //    the caller instead of going through a function pointer.
+    //  - Only where the implementation is compiled: header-only mode or
+    //    the CGAME_IMPLEMENTATION unit. Shared units use the cgame table.
+    //  - static, like the implementation they call: in header-only mode
+    //    every translation unit gets its own copy, so nothing here may
+    //    have external linkage.
+    // =========================
+    namespace CGame {
+        static inline void init(void) { _cgame_init(); }
+
+        static inline void quit(void) { _cgame_quit(); }
+
+        namespace display {
+            static inline CGameScreen set_mode(int w, int h, int flags) { return _cgame_set_mode_impl(w, h, flags); }
+            static inline void set_bgcolor(int r, int g, int b) { _cgame_display_set_bgcolor(r, g, b); }
+            static inline void clear(void) { _cgame_display_clear_impl(); }
+            static inline void flip(void) { _cgame_display_flip_impl(); }
+            static inline int get_width(void) { return _cgame_display_get_width(); }
+            static inline int get_height(void) { return _cgame_display_get_height(); }
+            static inline void set_title(const char* title) { _cgame_display_set_title(title); }
+            static inline bool set_icon(const char* path) { return _cgame_display_set_icon(path); }
+            static inline bool set_icon_from_image(const CGameImage* img) {
+                return _cgame_display_set_icon_from_image(img);
+            }
+            static inline const unsigned char* get_pixels(int* w, int* h) { return _cgame_display_get_pixels(w, h); }
+        }
+
+        namespace context {
+            static inline CGameContext* create(int w, int h) { return _cgame_context_create_impl(w, h); }
+            static inline void destroy(CGameContext* ctx) { _cgame_context_destroy_impl(ctx); }
+            static inline bool make_current(CGameContext* ctx) { return _cgame_context_make_current_impl(ctx); }
+            static inline CGameContext* current(void) { return _cgame_context_current_impl(); }
+        }
+
+        namespace jobs {
+            static inline void run(CGameJobFn fn, void* user, CGameWaitGroup* wg) { _cgame_jobs_run_impl(fn, user, wg); }
+            static inline void wait(CGameWaitGroup* wg) { _cgame_jobs_wait_impl(wg); }
+            static inline void parallel_for(int count, int grain, CGameRangeFn fn, void* user) {
+                _cgame_parallel_for(count, grain, fn, user);
+            }
+            static inline int worker_count(void) { return _cgame_jobs_worker_count_impl(); }
+            static inline bool set_worker_count(int count) { return _cgame_jobs_set_worker_count_impl(count); }
+            static inline int thread_index(void) { return _cgame_jobs_thread_index_impl(); }
+        }
+
+        namespace arena {
+            static inline void* alloc(size_t size) { return _cgame_arena_alloc(size); }
+            static inline size_t used(void) { return _cgame_arena_used_impl(); }
+            static inline void reset(void) { _cgame_arena_reset_impl(); }
+        }
+
+        namespace console {
+            static inline void set_color(int fg, int bg) { _cgame_console_set_color(fg, bg); }
+            static inline void reset_color(void) { _cgame_console_reset_color(); }
+        }
+
+        namespace messagebox {
+            static inline int show(const wchar_t* title, const wchar_t* text, unsigned int type) {
+                return _cgame_message_box(title, text, type);
+            }
+        }
+
+        namespace event {
+            static inline int get(void) { return _cgame_event_get(); }
+            static inline bool poll(CGameEvent* ev) { return _cgame_event_poll(ev); }
+            static inline int drain(CGameEvent* out, int max) { return _cgame_event_drain(out, max); }
+            static inline int dropped(void) { return _cgame_event_dropped_impl(); }
+            static inline void inject(const CGameEvent* ev) { _cgame_event_inject_impl(ev); }
+        }
+
+        namespace record {
+            static inline bool start(const char* path) { return _cgame_record_start_impl(path); }
+            static inline bool stop(void) { return _cgame_record_stop_impl(); }
+        }
+
+        namespace replay {
+            static inline bool start(const char* path) { return _cgame_replay_start_impl(path); }
+            static inline void stop(void) { _cgame_replay_stop_impl(); }
+            static inline bool active(void) { return _cgame_replay_active_impl(); }
+        }
+
+        namespace key {
+            static inline bool pressed(int key) { return _cgame_key_pressed_impl(key); }
+            static inline bool just_pressed(int key) { return _cgame_key_just_pressed_impl(key); }
+            static inline bool just_released(int key) { return _cgame_key_just_released_impl(key); }
+            static inline uintptr_t get_last(void) { return _cgame_key_last_impl(); }
+        }
+
+        namespace mouse {
+            static inline bool pressed(int button) { return _cgame_mouse_pressed_impl(button); }
+            static inline bool just_pressed(int button) { return _cgame_mouse_just_pressed_impl(button); }
+            static inline bool just_released(int button) { return _cgame_mouse_just_released_impl(button); }
+            static inline void get_pos(int* x, int* y) { _cgame_mouse_get_pos_impl(x, y); }
+            static inline void set_pos(int x, int y) { _cgame_mouse_set_pos_impl(x, y); }
+            static inline int get_wheel(void) { return _cgame_mouse_get_wheel_impl(); }
+            static inline int get_motion(CGameMotionSample* out, int max) {
+                return _cgame_mouse_get_motion_impl(out, max);
+            }
+            static inline void get_wheel_delta(float* dx, float* dy) { _cgame_mouse_get_wheel_delta_impl(dx, dy); }
+            static inline void set_full_rate(bool enabled) { _cgame_mouse_set_full_rate_impl(enabled); }
+            static inline bool set_raw(bool enabled) { return _cgame_mouse_set_raw_impl(enabled); }
+            static inline void get_raw_delta(int* dx, int* dy) { _cgame_mouse_get_raw_delta_impl(dx, dy); }
+        }
+
+        namespace draw {
+            static inline void rect(int x, int y, int w, int h, int border_width, int r, int g, int b) {
+                _cgame_draw_rect_impl(x, y, w, h, border_width, r, g, b);
+            }
+            static inline void fill_rect(int x, int y, int w, int h, int r, int g, int b) {
+                _cgame_draw_fillrect_impl(x, y, w, h, r, g, b);
+            }
+            static inline void polygon(const int* xs, const int* ys, int count, int border_width, int r, int g, int b) {
+                _cgame_draw_polygon_impl(xs, ys, count, border_width, r, g, b);
+            }
+            static inline void fill_polygon(const int* xs, const int* ys, int count, int r, int g, int b) {
+                _cgame_draw_fill_polygon_impl(xs, ys, count, r, g, b);
+            }
+            static inline void rounded_rect(int x, int y, int w, int h, int radius, int border_width, int r, int g, int b) {
+                _cgame_draw_rounded_rect_impl(x, y, w, h, radius, border_width, r, g, b);
+            }
+            static inline void rounded_fill_rect(int x, int y, int w, int h, int radius, int r, int g, int b) {
+                _cgame_draw_rounded_fill_rect_impl(x, y, w, h, radius, r, g, b);
+            }
+            static inline void circle(int x, int y, int radius, int border_width, int r, int g, int b) {
+                _cgame_draw_circle_impl(x, y, radius, border_width, r, g, b);
+            }
+            static inline void fill_circle(int x, int y, int radius, int r, int g, int b) {
+                _cgame_draw_fill_circle_impl(x, y, radius, r, g, b);
+            }
+        }
+
+        namespace image {
+            static inline CGameImage load(const char* path) { return _cgame_image_load_impl(path); }
+            static inline void unload(CGameImage* img) { _cgame_image_unload_impl(img); }
+            static inline void draw(const CGameImage* img, int x, int y) { _cgame_image_draw_impl(img, x, y); }
+            static inline void draw_scaled(const CGameImage* img, int x, int y, int w, int h) {
+                _cgame_image_draw_scaled_impl(img, x, y, w, h);
+            }
+            static inline CGameImage resize(const CGameImage* src, int w, int h) {
+                return _cgame_image_resize_nearest(src, w, h);
+            }
+            static inline CGameImage flip_horizontal(const CGameImage* img) {
+                return _cgame_image_flip_horizontal_impl(img);
+            }
+            static inline CGameImage flip_vertical(const CGameImage* img) {
+                return _cgame_image_flip_vertical_impl(img);
+            }
+            static inline int get_width(const CGameImage* img) { return _cgame_image_get_width_impl(img); }
+            static inline int get_height(const CGameImage* img) { return _cgame_image_get_height_impl(img); }
+            static inline int get_channels(const CGameImage* img) { return _cgame_image_get_channels_impl(img); }
+            static inline void draw_rotated(const CGameImage* img, int x, int y, float angle_deg) {
+                _cgame_image_draw_rotated_impl(img, x, y, angle_deg);
+            }
+            static inline CGameImage rotate(const CGameImage *src, float angle_deg) {
+                return _cgame_image_rotate_impl(src, angle_deg);
+            }
+            static inline CGameImage blur_box(const CGameImage* src, int radius) {
+                return _cgame_image_blur_box_impl(src, radius);
+            }
+            static inline CGameImage blur_gaussian(const CGameImage* src, float sigma) {
+                return _cgame_image_blur_gaussian_impl(src, sigma);
+            }
+            static inline CGameImage color_matrix(const CGameImage* src, const float* m) {
+                return _cgame_image_color_matrix_impl(src, m);
+            }
+        }
+
+        namespace pack {
+            static inline bool build(const char* out_path, const char** paths, int count, int flags) {
+                return _cgame_pack_build_impl(out_path, paths, count, flags);
+            }
+            static inline CGamePack* open(const char* path) { return _cgame_pack_open_impl(path); }
+            static inline void close(CGamePack* pack) { _cgame_pack_close_impl(pack); }
+            static inline int count(const CGamePack* pack) { return _cgame_pack_count_impl(pack); }
+            static inline const char* name(const CGamePack* pack, int index) {
+                return _cgame_pack_name_impl(pack, index);
+            }
+            static inline int find(const CGamePack* pack, const char* name) {
+                return _cgame_pack_find_impl(pack, name);
+            }
+            static inline CGameImage get(const CGamePack* pack, const char* name) {
+                return _cgame_pack_get_impl(pack, name);
+            }
+            static inline CGameImage get_index(const CGamePack* pack, int index) {
+                return _cgame_pack_get_index_impl(pack, index);
+            }
+        }
+
+        namespace cache {
+            static inline const CGameImage* acquire(const char* path) { return _cgame_cache_acquire_impl(path); }
+            static inline void release(const CGameImage* img) { _cgame_cache_release_impl(img); }
+            static inline void set_budget(size_t bytes) { _cgame_cache_set_budget_impl(bytes); }
+            static inline size_t get_usage(void) { return _cgame_cache_get_usage_impl(); }
+            static inline int get_count(void) { return _cgame_cache_get_count_impl(); }
+            static inline void purge(void) { _cgame_cache_purge_impl(); }
+        }
+
+        namespace time {
+            static inline CGameTicks get_ticks(void) { return _cgame_time_get_ticks_impl(); }
+            static inline void set_fps(int fps) { _cgame_time_set_fps_impl(fps); }
+            static inline void delay_if_needed(CGameTicks frame_start) {
+                _cgame_time_delay_if_needed_impl(frame_start);
+            }
+            static inline long long now_ns(void) { return _cgame_time_now_ns_impl(); }
+            static inline int get_missed(void) { return _cgame_time_get_missed_impl(); }
+        }
+
+        namespace loop {
+            static inline void run(const CGameLoop* loop) { _cgame_loop_run_impl(loop); }
+            static inline void stop(void) { _cgame_loop_stop_impl(); }
+        }
+
+        namespace profile {
+            static inline void enable(bool enabled) { _cgame_profile_enable_impl(enabled); }
+            static inline bool enabled(void) { return _cgame_profile_enabled_impl(); }
+            static inline void begin(const char* name) { _cgame_profile_begin_impl(name); }
+            static inline void end(void) { _cgame_profile_end_impl(); }
+            static inline void reset(void) { _cgame_profile_reset_impl(); }
+            static inline bool export_chrome(const char* path) { return _cgame_profile_export_chrome_impl(path); }
+            static inline bool export_binary(const char* path) { return _cgame_profile_export_binary_impl(path); }
+            static inline bool summary(CGameProfileSummary* out) { return _cgame_profile_summary_impl(out); }
+            static inline void print_summary(void) { _cgame_profile_print_summary_impl(); }
+        }
+
+        namespace debug {
+            static inline void hud(bool enabled) { _cgame_debug_hud_impl(enabled); }
+            static inline void track(bool enabled) { _cgame_debug_track_impl(enabled); }
+            static inline bool get_stats(CGameFrameStats* out) { return _cgame_debug_get_stats_impl(out); }
+            static inline void overdraw(bool enabled) { _cgame_debug_overdraw_impl(enabled); }
+            static inline bool get_overdraw(CGameOverdrawStats* out) { return _cgame_debug_get_overdraw_impl(out); }
+        }
+
+        namespace text {
+            static inline void draw(const char* text, int x, int y, int r, int g, int b) {
+                _cgame_text_draw_impl(text, x, y, r, g, b);
+            }
+            static inline void draw_complex(const char* text, int x, int y, const wchar_t* fontName, float size, int r, int g, int b) {
+                _cgame_text_draw_complex_impl(text, x, y, fontName, size, r, g, b);
+            }
+            static inline bool load_font(const char* path) { return _cgame_text_load_font_impl(path); }
+            static inline void measure(const char* text, const wchar_t* fontName, float size, int wrap_width, int* w, int* h) {
+                _cgame_text_measure_impl(text, fontName, size, wrap_width, w, h);
+            }
+            static inline void draw_wrapped(const char* text, int x, int y, int wrap_width, const wchar_t* fontName, float size, int r, int g, int b) {
+                _cgame_text_draw_wrapped_impl(text, x, y, wrap_width, fontName, size, r, g, b);
+            }
+            static inline int draw_fast(const char* text, int x, int y, int scale, int r, int g, int b) {
+                return _cgame_text_draw_fast_impl(text, x, y, scale, r, g, b);
+            }
+            static inline int draw_fast_int(long long value, int x, int y, int scale, int r, int g, int b) {
+                return _cgame_text_draw_fast_int_impl(value, x, y, scale, r, g, b);
+            }
+            static inline int draw_fast_float(double value, int decimals, int x, int y, int scale, int r, int g, int b) {
+                return _cgame_text_draw_fast_float_impl(value, decimals, x, y, scale, r, g, b);
+            }
+        }
+
+        namespace ttf {
+            static inline CGameTTF* load(const char* path) { return _cgame_ttf_load_impl(path); }
+            static inline CGameTTF* load_memory(const void* data, size_t size) {
+                return _cgame_ttf_load_memory_impl(data, size);
+            }
+            static inline void unload(CGameTTF* font) { _cgame_ttf_free_impl(font); }
+            static inline void set_sdf(CGameTTF* font, bool enabled) { _cgame_ttf_set_sdf_impl(font, enabled); }
+            static inline void draw(CGameTTF* font, const char* text, int x, int y, float px, int r, int g, int b) {
+                _cgame_ttf_draw_impl(font, text, x, y, px, r, g, b);
+            }
+        }
+    }
 // -----------------------------------------------------------
 // Entry point shim for MinGW when using -municode
 // -----------------------------------------------------------
@@ -1778,5 +7772,8 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
 }
 #endif
 
+#endif // _WIN32 || _WIN64
+
+#endif // !CGAME_SHARED || CGAME_IMPLEMENTATION
 
 #endif // CGAME_H
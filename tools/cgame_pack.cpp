@@ -0,0 +1,43 @@
+// cgame_pack — bakes images into a pre-decoded cgame asset pack.
+//
+// Usage:
+//   cgame_pack [-lz4] <out.cgp> <image> [image ...]
+//
+// Entries are named by the path given on the command line; load them at
+// runtime with cgame.pack.open / cgame.pack.get using the same string.
+//
+// Build (MinGW):
+//   g++ -I. tools/cgame_pack.cpp -o cgame_pack.exe -lgdi32 -lgdiplus
+
+#define CGAME_NO_WINMAIN_SHIM
+#include <cgame/cgame.h>
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+    int flags = 0;
+    int first = 1;
+    if (argc > 1 && strcmp(argv[1], "-lz4") == 0) {
+        flags |= CGAME_PACK_LZ4;
+        first = 2;
+    }
+    if (argc - first < 2) {
+        fprintf(stderr, "usage: %s [-lz4] <out.cgp> <image> [image ...]\n", argv[0]);
+        return 1;
+    }
+
+    const char*  out   = argv[first];
+    const char** paths = (const char**)(argv + first + 1);
+    int          count = argc - first - 1;
+
+    cgame.init();
+    bool ok = cgame.pack.build(out, paths, count, flags);
+    if (!ok) {
+        fprintf(stderr, "cgame_pack: failed to write %s\n", out);
+    } else {
+        CGamePack* pack = cgame.pack.open(out);
+        printf("%s: %d images\n", out, cgame.pack.count(pack));
+        cgame.pack.close(pack);
+    }
+    cgame.quit();
+    return ok ? 0 : 1;
+}